@@ -0,0 +1,188 @@
+#pragma once
+
+#include <relay/socket.hpp>
+#include <turner/port_pool>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <string>
+#include <thread>
+
+
+class config
+{
+public:
+
+	// relay
+	turner::endpoint listen{pal::net::ip::address_v4{}, 3478};
+	std::optional<pal::net::ip::address> relay_address{};
+	uint16_t first_port = turner::port_pool::default_first;
+	uint16_t last_port = turner::port_pool::default_last;
+	std::string realm = "turner";
+	std::map<std::string, std::string, std::less<>> users{};
+	size_t capacity = 4096;
+
+	// workers
+	size_t workers = (std::max)(std::thread::hardware_concurrency(), 1u);
+	size_t batch_size = 64;
+	bool cpu_steering = false;
+	std::chrono::seconds stats_interval{10};
+
+	// load test
+	std::optional<turner::endpoint> load_test{};
+	size_t clients = 64;
+	size_t payload_size_bytes = 200;
+	std::chrono::seconds duration{10};
+
+	config (int argc, const char *argv[])
+	{
+		parse_command_line(argc, argv, [this, argv](const std::string &option, const std::string &argument)
+		{
+			if (option == "listen")
+			{
+				listen = parse_endpoint(option, argument);
+			}
+			else if (option == "relay-address")
+			{
+				relay_address = parse_address(option, argument);
+			}
+			else if (option == "ports")
+			{
+				auto dash = argument.find('-');
+				if (dash == argument.npos)
+				{
+					throw std::runtime_error(option + ": expected first-last '" + argument + "'");
+				}
+				first_port = parse<uint16_t>(option, argument.substr(0, dash));
+				last_port = parse<uint16_t>(option, argument.substr(dash + 1));
+			}
+			else if (option == "realm")
+			{
+				realm = argument;
+			}
+			else if (option == "user")
+			{
+				auto colon = argument.find(':');
+				if (colon == argument.npos)
+				{
+					throw std::runtime_error(option + ": expected name:password '" + argument + "'");
+				}
+				users.insert_or_assign(argument.substr(0, colon), argument.substr(colon + 1));
+			}
+			else if (option == "capacity")
+			{
+				capacity = parse<size_t>(option, argument);
+			}
+			else if (option == "workers")
+			{
+				workers = (std::max)(parse<size_t>(option, argument), size_t{1});
+			}
+			else if (option == "batch")
+			{
+				batch_size = (std::max)(parse<size_t>(option, argument), size_t{1});
+			}
+			else if (option == "--cpu-steering")
+			{
+				cpu_steering = true;
+			}
+			else if (option == "stats")
+			{
+				stats_interval = std::chrono::seconds{parse<int>(option, argument)};
+			}
+			else if (option == "load-test")
+			{
+				load_test = parse_endpoint(option, argument);
+			}
+			else if (option == "clients")
+			{
+				clients = (std::max)(parse<size_t>(option, argument), size_t{1});
+			}
+			else if (option == "payload")
+			{
+				payload_size_bytes = parse<size_t>(option, argument);
+			}
+			else if (option == "duration")
+			{
+				duration = std::chrono::seconds{parse<int>(option, argument)};
+			}
+			else if (option == "--help" || option == "-h")
+			{
+				help(argv[0]);
+			}
+			else
+			{
+				throw std::runtime_error("invalid option '" + option + "'");
+			}
+		});
+
+		if (users.empty())
+		{
+			users.emplace("turner", "turner");
+		}
+
+		if (!load_test && !relay_address)
+		{
+			if (listen.address == pal::net::ip::address{pal::net::ip::address_v4{}})
+			{
+				throw std::runtime_error("--relay-address required when listening on any address");
+			}
+			relay_address = listen.address;
+		}
+
+		if (relay_address && relay_address->is_v4() != listen.address.is_v4())
+		{
+			throw std::runtime_error("--relay-address and --listen address family mismatch");
+		}
+	}
+
+	static void help (const char *argv0)
+	{
+		std::cout
+			<< "usage: " << argv0 << " [options]\n"
+			<< "\nrelay:\n"
+			<< "  --listen=address:port    listening address (0.0.0.0:3478)\n"
+			<< "  --relay-address=address  relayed address (listening address)\n"
+			<< "  --ports=first-last       relay port range (49152-65535)\n"
+			<< "  --realm=realm            long-term credentials realm (turner)\n"
+			<< "  --user=name:password     user credentials (turner:turner)\n"
+			<< "  --capacity=N             maximum allocations per worker (4096)\n"
+			<< "\nworkers:\n"
+			<< "  --workers=N              number of workers (CPU count)\n"
+			<< "  --batch=N                recvmmsg/sendmmsg batch size (64)\n"
+			<< "  --cpu-steering           pin each worker to own CPU, steer datagrams to worker on receiving CPU\n"
+			<< "  --stats=seconds          statistics interval, 0 to disable (10)\n"
+			<< "\nload test (run against relay at address:port):\n"
+			<< "  --load-test=address:port relay to test\n"
+			<< "  --clients=N              number of allocations per worker (64)\n"
+			<< "  --payload=N              ChannelData payload size (200)\n"
+			<< "  --duration=seconds       test duration (10)\n"
+		;
+		std::exit(EXIT_SUCCESS);
+	}
+
+	void print () const
+	{
+		if (load_test)
+		{
+			std::cout
+				<< "load test: " << to_string(*load_test)
+				<< ", workers: " << workers
+				<< ", clients: " << clients
+				<< ", payload: " << payload_size_bytes
+				<< ", duration: " << duration.count() << "s\n"
+			;
+			return;
+		}
+
+		std::cout
+			<< "listen: " << to_string(listen)
+			<< ", relay: " << to_string({*relay_address, first_port}) << '-' << last_port
+			<< ", realm: " << realm
+			<< ", workers: " << workers
+			<< ", batch: " << batch_size
+			<< (cpu_steering ? ", cpu steering" : "")
+			<< '\n'
+		;
+	}
+};
@@ -0,0 +1,25 @@
+find_package(Threads REQUIRED)
+
+cxx_executable(turner_relay
+	SOURCES
+		samples/command_line.hpp
+		relay/config.hpp
+		relay/load_test.hpp
+		relay/load_test.cpp
+		relay/main.cpp
+		relay/socket.hpp
+		relay/worker.hpp
+		relay/worker.cpp
+	LIBRARIES turner::protocol Threads::Threads
+)
+
+if(turner_test)
+	cxx_test(turner_relay_test
+		SOURCES
+			relay/splice.hpp
+			relay/splice.test.cpp
+			turner/test
+			turner/test.cpp
+		LIBRARIES turner::protocol
+	)
+endif()
@@ -0,0 +1,385 @@
+#include <relay/load_test.hpp>
+#include <relay/socket.hpp>
+#include <turner/credential_cache>
+#include <turner/turn>
+#include <poll.h>
+#include <atomic>
+#include <iomanip>
+#include <random>
+#include <thread>
+#include <vector>
+
+
+namespace {
+
+using namespace std::chrono_literals;
+using turner::turn;
+
+constexpr uint16_t channel = 0x4000;
+
+// ChannelData datagrams sent per client per round
+constexpr size_t burst_size = 8;
+
+struct direction_statistics
+{
+	std::atomic<uint64_t> sent{0}, received{0};
+};
+
+struct load_statistics
+{
+	direction_statistics to_peer{}, to_client{};
+	std::atomic<size_t> clients{0};
+};
+
+
+// Client side of single allocation: synchronous request/response with
+// retransmissions, enough to set up allocation before test traffic
+class client
+{
+public:
+
+	client (const turner::endpoint &relay, std::string_view username, std::string_view password)
+		: socket_{relay.address.is_v4() ? AF_INET : AF_INET6}
+		, username_{username}
+		, password_{password}
+	{
+		if (!socket_.connect(relay))
+		{
+			throw system_error("connect " + to_string(relay));
+		}
+		std::random_device device;
+		for (auto &b: transaction_id_)
+		{
+			b = static_cast<uint8_t>(device());
+		}
+	}
+
+	const udp_socket &socket () const noexcept
+	{
+		return socket_;
+	}
+
+	// valid after successful allocate()
+	const turner::endpoint &relayed () const noexcept
+	{
+		return relayed_;
+	}
+
+	bool allocate ()
+	{
+		// 1st request for REALM and NONCE
+		auto response = request(turn::allocate, [](auto &writer)
+		{
+			writer.write(turn::requested_transport, turner::transport_protocol::udp);
+		});
+		if (!response || !response->expect(turn::allocate.error))
+		{
+			return false;
+		}
+		auto [realm, nonce] = response->read(turner::attributes<turn::realm, turn::nonce>);
+		if (!realm || !nonce)
+		{
+			return false;
+		}
+		realm_ = *realm;
+		nonce_ = *nonce;
+		key_ = turner::long_term_key::make(turner::password_algorithm::md5, username_, realm_, password_);
+
+		response = request(turn::allocate, [this](auto &writer)
+		{
+			writer.write(turn::requested_transport, turner::transport_protocol::udp);
+			sign(writer);
+		});
+		if (!response || !response->expect(turn::allocate.success))
+		{
+			return false;
+		}
+		auto relayed = response->read(turn::xor_relayed_address);
+		if (!relayed)
+		{
+			return false;
+		}
+		relayed_ = {relayed->address, relayed->port};
+		return true;
+	}
+
+	bool channel_bind (const turner::endpoint &peer)
+	{
+		auto response = request(turn::channel_bind, [&](auto &writer)
+		{
+			writer
+				.write(turn::channel_number, channel)
+				.write(turn::xor_peer_address, {peer.address, peer.port})
+			;
+			sign(writer);
+		});
+		return response && response->expect(turn::channel_bind.success);
+	}
+
+	void release ()
+	{
+		turn::message_writer writer{buffer_, turn::refresh, next_transaction_id()};
+		writer.write(turn::lifetime, std::chrono::seconds::zero());
+		sign(writer);
+		if (auto message = writer.finish())
+		{
+			(void)::send(socket_.native_handle(), message->data(), message->size(), MSG_DONTWAIT);
+		}
+	}
+
+private:
+
+	udp_socket socket_;
+	std::string username_, password_, realm_{}, nonce_{};
+	turner::endpoint relayed_{};
+	turner::long_term_key key_{};
+	turn::transaction_id_type transaction_id_{};
+	std::array<std::byte, 1024> buffer_{}, response_{};
+
+	const turn::transaction_id_type &next_transaction_id () noexcept
+	{
+		for (auto &b: transaction_id_)
+		{
+			if (++b != 0)
+			{
+				break;
+			}
+		}
+		return transaction_id_;
+	}
+
+	void sign (turn::message_writer &writer)
+	{
+		writer
+			.write(turn::username, username_)
+			.write(turn::realm, realm_)
+			.write(turn::nonce, nonce_)
+			.add_integrity(turn::message_integrity, key_.sha1)
+		;
+	}
+
+	template <typename Message, typename Write>
+	std::optional<turn::message_reader> request (Message message, Write write)
+	{
+		turn::message_writer writer{buffer_, message, next_transaction_id()};
+		write(writer);
+		auto request = writer.finish();
+		if (!request)
+		{
+			return std::nullopt;
+		}
+
+		for (auto timeout = 250;  timeout <= 2000;  timeout *= 2)
+		{
+			(void)::send(socket_.native_handle(), request->data(), request->size(), 0);
+
+			pollfd fd{socket_.native_handle(), POLLIN, 0};
+			while (::poll(&fd, 1, timeout) == 1)
+			{
+				auto size = ::recv(socket_.native_handle(), response_.data(), response_.size(), MSG_DONTWAIT);
+				if (size <= 0)
+				{
+					break;
+				}
+				auto reader = turn::read_message(std::span{response_}.first(size));
+				if (reader && reader->transaction_id() == transaction_id_)
+				{
+					return *reader;
+				}
+			}
+		}
+		return std::nullopt;
+	}
+};
+
+
+void load (const config &config, load_statistics &stats, std::stop_token stop)
+{
+	const auto &[username, password] = *config.users.begin();
+
+	std::vector<client> clients;
+	clients.reserve(config.clients);
+	for (auto i = 0u;  i < config.clients && !stop.stop_requested();  ++i)
+	{
+		clients.emplace_back(*config.load_test, username, password);
+	}
+
+	// peer is bound on same local address as clients use towards relay
+	auto local = clients.front().socket().local_endpoint();
+	auto peer = udp_socket::open({local.address, 0});
+	auto peer_endpoint = peer.local_endpoint();
+
+	for (auto &c: clients)
+	{
+		if (!c.allocate() || !c.channel_bind(peer_endpoint))
+		{
+			std::cerr << "load test: failed to set up allocation\n";
+			return;
+		}
+		stats.clients++;
+	}
+
+	// every client sends same ChannelData
+	std::vector<std::byte> message(4 + config.payload_size_bytes + 3);
+	auto channel_data = turn::wrap_channel_data(message, 4, config.payload_size_bytes, channel).value();
+
+	std::vector<mmsghdr> headers(burst_size);
+	std::vector<iovec> iov(burst_size, {const_cast<std::byte *>(channel_data.data()), channel_data.size()});
+	for (auto i = 0u;  i < burst_size;  ++i)
+	{
+		headers[i].msg_hdr.msg_iov = &iov[i];
+		headers[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	// peer sends same raw payload to relayed address of every client,
+	// relay forwards it to client as ChannelData
+	std::vector<std::byte> payload(config.payload_size_bytes);
+	mmsg_batch to_clients{clients.size() * burst_size};
+	for (auto i = 0u;  i < to_clients.size();  ++i)
+	{
+		to_clients.set(i, payload, clients[i / burst_size].relayed());
+	}
+
+	// received datagrams are only counted
+	constexpr size_t receive_batch_size = 64;
+	std::vector<std::array<std::byte, 2048>> rx(receive_batch_size);
+	std::vector<mmsghdr> rx_headers(receive_batch_size);
+	std::vector<iovec> rx_iov(receive_batch_size);
+	for (auto i = 0u;  i < receive_batch_size;  ++i)
+	{
+		rx_iov[i] = {rx[i].data(), rx[i].size()};
+		rx_headers[i].msg_hdr.msg_iov = &rx_iov[i];
+		rx_headers[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	auto drain = [&](const udp_socket &socket, direction_statistics &direction)
+	{
+		for (;;)
+		{
+			auto count = ::recvmmsg(socket.native_handle(), rx_headers.data(), rx_headers.size(), MSG_DONTWAIT, nullptr);
+			if (count <= 0)
+			{
+				break;
+			}
+			direction.received.fetch_add(count, std::memory_order_relaxed);
+		}
+	};
+
+	auto drain_all = [&]
+	{
+		drain(peer, stats.to_peer);
+		for (auto &c: clients)
+		{
+			drain(c.socket(), stats.to_client);
+		}
+	};
+
+	while (!stop.stop_requested())
+	{
+		for (auto &c: clients)
+		{
+			auto sent = ::sendmmsg(c.socket().native_handle(), headers.data(), headers.size(), MSG_DONTWAIT);
+			if (sent > 0)
+			{
+				stats.to_peer.sent.fetch_add(sent, std::memory_order_relaxed);
+			}
+		}
+		stats.to_client.sent.fetch_add(to_clients.send(peer, 0, to_clients.size()), std::memory_order_relaxed);
+		drain_all();
+	}
+
+	// in-flight datagrams
+	std::this_thread::sleep_for(100ms);
+	drain_all();
+
+	for (auto &c: clients)
+	{
+		c.release();
+	}
+}
+
+
+// statistics summed over workers
+struct load_totals
+{
+	uint64_t to_peer_sent = 0, to_peer_received = 0;
+	uint64_t to_client_sent = 0, to_client_received = 0;
+	size_t clients = 0;
+
+	static load_totals sum (const std::vector<load_statistics> &stats) noexcept
+	{
+		load_totals result;
+		for (auto &s: stats)
+		{
+			result.to_peer_sent += s.to_peer.sent.load(std::memory_order_relaxed);
+			result.to_peer_received += s.to_peer.received.load(std::memory_order_relaxed);
+			result.to_client_sent += s.to_client.sent.load(std::memory_order_relaxed);
+			result.to_client_received += s.to_client.received.load(std::memory_order_relaxed);
+			result.clients += s.clients.load(std::memory_order_relaxed);
+		}
+		return result;
+	}
+};
+
+} // namespace
+
+
+int run_load_test (const config &config)
+{
+	std::vector<load_statistics> stats(config.workers);
+	{
+		std::vector<std::jthread> threads;
+		for (auto i = 0u;  i < config.workers;  ++i)
+		{
+			threads.emplace_back([&config, &s = stats[i]](std::stop_token stop)
+			{
+				try
+				{
+					load(config, s, stop);
+				}
+				catch (const std::exception &e)
+				{
+					std::cerr << "load test: " << e.what() << '\n';
+				}
+			});
+		}
+
+		load_totals last{};
+		for (auto second = 0;  second < config.duration.count();  ++second)
+		{
+			std::this_thread::sleep_for(1s);
+
+			auto now = load_totals::sum(stats);
+			auto print = [&](const char *name, uint64_t sent, uint64_t received, uint64_t last_sent, uint64_t last_received)
+			{
+				std::cout
+					<< ", " << name << ": tx " << (sent - last_sent) << " pps"
+					<< ", rx " << (received - last_received) << " pps"
+					<< " (" << std::fixed << std::setprecision(2)
+					<< double((received - last_received) * config.payload_size_bytes) * 8 / 1e9 << " Gbps payload)"
+				;
+			};
+			std::cout << "clients: " << now.clients;
+			print("to peer", now.to_peer_sent, now.to_peer_received, last.to_peer_sent, last.to_peer_received);
+			print("to client", now.to_client_sent, now.to_client_received, last.to_client_sent, last.to_client_received);
+			std::cout << '\n';
+			last = now;
+		}
+	}
+
+	auto total = load_totals::sum(stats);
+	auto loss = [](uint64_t sent, uint64_t received)
+	{
+		return sent ? 100.0 * double(sent - (std::min)(sent, received)) / double(sent) : 0.0;
+	};
+	std::cout
+		<< std::fixed << std::setprecision(2)
+		<< "to peer: tx " << total.to_peer_sent
+		<< ", rx " << total.to_peer_received
+		<< ", loss " << loss(total.to_peer_sent, total.to_peer_received) << '%'
+		<< "; to client: tx " << total.to_client_sent
+		<< ", rx " << total.to_client_received
+		<< ", loss " << loss(total.to_client_sent, total.to_client_received) << "%\n"
+	;
+	return total.to_peer_received && total.to_client_received ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+// Load test: each worker creates config.clients allocations on relay at
+// config.load_test and binds channel from each allocation to worker's own
+// peer socket. Clients send ChannelData bursts and peer sends raw datagrams
+// to every relayed address as fast as possible, each side counting
+// datagrams relayed from the other one.
+
+#include <relay/config.hpp>
+
+
+int run_load_test (const config &config);
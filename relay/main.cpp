@@ -0,0 +1,215 @@
+// turner_relay: Linux UDP TURN relay
+//
+// One worker thread per CPU, each with its own SO_REUSEPORT listening socket
+// and turner::server (allocation shard), doing batched recvmmsg/sendmmsg.
+// With --cpu-steering workers are pinned to distinct CPUs and classic BPF
+// program attached to reuseport group selects socket of worker pinned to CPU
+// that received datagram (RSS/RPS already spread flows by 5-tuple hash), keeping each
+// flow on single CPU from NIC queue to sendmmsg().
+//
+// With --load-test=address:port, runs as load generator against relay
+// instead.
+
+#include <relay/config.hpp>
+#include <relay/load_test.hpp>
+#include <relay/worker.hpp>
+#include <linux/filter.h>
+#include <pthread.h>
+#include <signal.h>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+
+// CPUs calling thread is allowed to run on
+std::vector<unsigned> allowed_cpus ()
+{
+	cpu_set_t allowed;
+	if (::pthread_getaffinity_np(::pthread_self(), sizeof(allowed), &allowed) != 0)
+	{
+		throw system_error("pthread_getaffinity_np");
+	}
+
+	std::vector<unsigned> cpus;
+	for (auto cpu = 0u;  cpu < CPU_SETSIZE;  ++cpu)
+	{
+		if (CPU_ISSET(cpu, &allowed))
+		{
+			cpus.push_back(cpu);
+		}
+	}
+	return cpus;
+}
+
+
+void attach_cpu_steering (const udp_socket &socket, const std::vector<unsigned> &worker_cpus)
+{
+	// A = index of worker pinned to receiving CPU (index of its socket in
+	// reuseport group). CPUs without worker (excluded from affinity mask)
+	// fall back to A = cpu % workers.
+	std::vector<sock_filter> code;
+	code.push_back({ BPF_LD | BPF_W | BPF_ABS, 0, 0, static_cast<uint32_t>(SKF_AD_OFF + SKF_AD_CPU) });
+	for (auto i = 0u;  i < worker_cpus.size();  ++i)
+	{
+		code.push_back({ BPF_JMP | BPF_JEQ | BPF_K, 0, 1, worker_cpus[i] });
+		code.push_back({ BPF_RET | BPF_K, 0, 0, i });
+	}
+	code.push_back({ BPF_ALU | BPF_MOD | BPF_K, 0, 0, static_cast<uint32_t>(worker_cpus.size()) });
+	code.push_back({ BPF_RET | BPF_A, 0, 0, 0 });
+
+	if (code.size() > BPF_MAXINSNS)
+	{
+		throw std::runtime_error("--cpu-steering: too many workers");
+	}
+	sock_fprog program{static_cast<unsigned short>(code.size()), code.data()};
+	if (!const_cast<udp_socket &>(socket).set_option(SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, program))
+	{
+		throw system_error("SO_ATTACH_REUSEPORT_CBPF");
+	}
+}
+
+
+// pin calling thread to \a cpu
+void pin_to_cpu (size_t index, unsigned cpu)
+{
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	if (::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set) != 0)
+	{
+		// not fatal: kernel still steers by CPU, worker just may run elsewhere
+		std::cerr << "worker " << index << ": failed to pin to CPU " << cpu << '\n';
+	}
+}
+
+
+void print_stats (const std::vector<std::unique_ptr<worker>> &workers)
+{
+	uint64_t received = 0, sent = 0, to_peer = 0, to_client = 0, dropped = 0;
+	size_t allocations = 0;
+	for (auto &w: workers)
+	{
+		auto &stats = w->stats();
+		received += stats.received.load(std::memory_order_relaxed);
+		sent += stats.sent.load(std::memory_order_relaxed);
+		to_peer += stats.to_peer.load(std::memory_order_relaxed);
+		to_client += stats.to_client.load(std::memory_order_relaxed);
+		dropped += stats.dropped.load(std::memory_order_relaxed);
+		allocations += stats.allocations.load(std::memory_order_relaxed);
+	}
+	std::cout
+		<< "allocations: " << allocations
+		<< ", received: " << received
+		<< ", sent: " << sent
+		<< ", to peer: " << to_peer
+		<< ", to client: " << to_client
+		<< ", dropped: " << dropped
+		<< '\n'
+	;
+}
+
+
+int run_relay (const config &config)
+{
+	// SIGINT/SIGTERM are handled by main thread, workers inherit mask
+	sigset_t signals;
+	sigemptyset(&signals);
+	sigaddset(&signals, SIGINT);
+	sigaddset(&signals, SIGTERM);
+	::pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+	// shared between workers
+	turner::port_pool ports{config.first_port, config.last_port};
+	turner::credential_cache credentials{config.users.size() + 16};
+	std::array<std::byte, 32> nonce_secret;
+	std::random_device device;
+	for (auto &b: nonce_secret)
+	{
+		b = static_cast<std::byte>(device());
+	}
+
+	// worker i is pinned to i'th allowed CPU: steering needs one worker per
+	// CPU, otherwise datagrams of CPUs sharing worker would be split
+	std::vector<unsigned> worker_cpus;
+	if (config.cpu_steering)
+	{
+		worker_cpus = allowed_cpus();
+		if (config.workers > worker_cpus.size())
+		{
+			throw std::runtime_error("--cpu-steering: more workers than allowed CPUs");
+		}
+		worker_cpus.resize(config.workers);
+	}
+
+	// listening sockets are created in worker order: socket index in
+	// reuseport group equals worker index (used by CPU steering)
+	std::vector<std::unique_ptr<worker>> workers;
+	for (auto i = 0u;  i < config.workers;  ++i)
+	{
+		workers.emplace_back(std::make_unique<worker>(config, i, ports, credentials, nonce_secret));
+	}
+	if (config.cpu_steering)
+	{
+		attach_cpu_steering(workers.front()->listen_socket(), worker_cpus);
+	}
+
+	std::vector<std::jthread> threads;
+	for (auto i = 0u;  i < workers.size();  ++i)
+	{
+		threads.emplace_back([&worker_cpus, i, &w = *workers[i]](std::stop_token stop)
+		{
+			if (i < worker_cpus.size())
+			{
+				pin_to_cpu(i, worker_cpus[i]);
+			}
+			w.run(stop);
+		});
+	}
+
+	timespec timeout{config.stats_interval.count() ? config.stats_interval.count() : 3600, 0};
+	for (;;)
+	{
+		if (auto signal = ::sigtimedwait(&signals, nullptr, &timeout);  signal != -1)
+		{
+			break;
+		}
+		if (config.stats_interval.count())
+		{
+			print_stats(workers);
+		}
+	}
+
+	for (auto &thread: threads)
+	{
+		thread.request_stop();
+	}
+	threads.clear();
+	print_stats(workers);
+	return EXIT_SUCCESS;
+}
+
+
+int run (const config &config)
+{
+	config.print();
+	if (config.load_test)
+	{
+		return run_load_test(config);
+	}
+	return run_relay(config);
+}
+
+
+int main (int argc, const char *argv[])
+{
+	try
+	{
+		return run(config{argc, argv});
+	}
+	catch (const std::exception &e)
+	{
+		std::cerr << argv[0] << ": " << e.what() << '\n';
+		return EXIT_FAILURE;
+	}
+}
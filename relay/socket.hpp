@@ -0,0 +1,312 @@
+#pragma once
+
+// Linux UDP socket helpers: endpoint <-> sockaddr conversion, RAII socket
+// and recvmmsg()/sendmmsg() batches
+
+#include <samples/command_line.hpp>
+#include <turner/server>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+
+inline std::system_error system_error (const std::string &what)
+{
+	return {errno, std::generic_category(), what};
+}
+
+
+inline socklen_t to_sockaddr (const turner::endpoint &endpoint, sockaddr_storage &result) noexcept
+{
+	std::memset(&result, 0, sizeof(result));
+	if (endpoint.address.is_v4())
+	{
+		auto &a = reinterpret_cast<sockaddr_in &>(result);
+		a.sin_family = AF_INET;
+		a.sin_port = htons(endpoint.port);
+		std::memcpy(&a.sin_addr, endpoint.address.v4().to_bytes().data(), 4);
+		return sizeof(a);
+	}
+	auto &a = reinterpret_cast<sockaddr_in6 &>(result);
+	a.sin6_family = AF_INET6;
+	a.sin6_port = htons(endpoint.port);
+	std::memcpy(&a.sin6_addr, endpoint.address.v6().to_bytes().data(), 16);
+	return sizeof(a);
+}
+
+
+inline turner::endpoint to_endpoint (const sockaddr_storage &address) noexcept
+{
+	if (address.ss_family == AF_INET)
+	{
+		auto &a = reinterpret_cast<const sockaddr_in &>(address);
+		pal::net::ip::address_v4::bytes_type bytes;
+		std::memcpy(bytes.data(), &a.sin_addr, 4);
+		return {pal::net::ip::address_v4{bytes}, ntohs(a.sin_port)};
+	}
+	auto &a = reinterpret_cast<const sockaddr_in6 &>(address);
+	pal::net::ip::address_v6::bytes_type bytes;
+	std::memcpy(bytes.data(), &a.sin6_addr, 16);
+	return {pal::net::ip::address_v6{bytes}, ntohs(a.sin6_port)};
+}
+
+
+inline pal::net::ip::address parse_address (const std::string &option, const std::string &argument)
+{
+	pal::net::ip::address_v4::bytes_type v4;
+	if (inet_pton(AF_INET, argument.c_str(), v4.data()) == 1)
+	{
+		return pal::net::ip::address_v4{v4};
+	}
+
+	pal::net::ip::address_v6::bytes_type v6;
+	if (inet_pton(AF_INET6, argument.c_str(), v6.data()) == 1)
+	{
+		return pal::net::ip::address_v6{v6};
+	}
+
+	throw std::runtime_error(option + ": not valid address '" + argument + "'");
+}
+
+
+// a.b.c.d:port or [v6]:port
+inline turner::endpoint parse_endpoint (const std::string &option, const std::string &argument)
+{
+	auto colon = argument.rfind(':');
+	if (colon == argument.npos)
+	{
+		throw std::runtime_error(option + ": missing port '" + argument + "'");
+	}
+
+	auto host = argument.substr(0, colon);
+	if (host.size() > 1 && host.front() == '[' && host.back() == ']')
+	{
+		host = host.substr(1, host.size() - 2);
+	}
+	return {parse_address(option, host), parse<uint16_t>(option, argument.substr(colon + 1))};
+}
+
+
+inline std::string to_string (const turner::endpoint &endpoint)
+{
+	char buf[INET6_ADDRSTRLEN] = "";
+	if (endpoint.address.is_v4())
+	{
+		inet_ntop(AF_INET, endpoint.address.v4().to_bytes().data(), buf, sizeof(buf));
+		return std::string{buf} + ':' + std::to_string(endpoint.port);
+	}
+	inet_ntop(AF_INET6, endpoint.address.v6().to_bytes().data(), buf, sizeof(buf));
+	return '[' + std::string{buf} + "]:" + std::to_string(endpoint.port);
+}
+
+
+class udp_socket
+{
+public:
+
+	udp_socket () = default;
+
+	explicit udp_socket (int family)
+		: fd_{::socket(family, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0)}
+	{
+		if (fd_ == -1)
+		{
+			throw system_error("socket");
+		}
+	}
+
+	udp_socket (udp_socket &&that) noexcept
+		: fd_{that.fd_}
+	{
+		that.fd_ = -1;
+	}
+
+	udp_socket &operator= (udp_socket &&that) noexcept
+	{
+		close();
+		fd_ = that.fd_;
+		that.fd_ = -1;
+		return *this;
+	}
+
+	~udp_socket () noexcept
+	{
+		close();
+	}
+
+	int native_handle () const noexcept
+	{
+		return fd_;
+	}
+
+	explicit operator bool () const noexcept
+	{
+		return fd_ != -1;
+	}
+
+	void close () noexcept
+	{
+		if (fd_ != -1)
+		{
+			::close(fd_);
+			fd_ = -1;
+		}
+	}
+
+	template <typename T>
+	bool set_option (int level, int name, const T &value) noexcept
+	{
+		return ::setsockopt(fd_, level, name, &value, sizeof(value)) == 0;
+	}
+
+	bool bind (const turner::endpoint &endpoint) noexcept
+	{
+		sockaddr_storage address;
+		auto size = to_sockaddr(endpoint, address);
+		return ::bind(fd_, reinterpret_cast<const sockaddr *>(&address), size) == 0;
+	}
+
+	bool connect (const turner::endpoint &endpoint) noexcept
+	{
+		sockaddr_storage address;
+		auto size = to_sockaddr(endpoint, address);
+		return ::connect(fd_, reinterpret_cast<const sockaddr *>(&address), size) == 0;
+	}
+
+	turner::endpoint local_endpoint () const
+	{
+		sockaddr_storage address;
+		socklen_t size = sizeof(address);
+		if (::getsockname(fd_, reinterpret_cast<sockaddr *>(&address), &size) == -1)
+		{
+			throw system_error("getsockname");
+		}
+		return to_endpoint(address);
+	}
+
+	static udp_socket open (const turner::endpoint &endpoint, bool reuse_port = false)
+	{
+		udp_socket socket{endpoint.address.is_v4() ? AF_INET : AF_INET6};
+		if (reuse_port && !socket.set_option(SOL_SOCKET, SO_REUSEPORT, 1))
+		{
+			throw system_error("SO_REUSEPORT");
+		}
+		if (!socket.bind(endpoint))
+		{
+			throw system_error("bind " + to_string(endpoint));
+		}
+
+		// best effort: bursts are received/sent in batches
+		socket.set_option(SOL_SOCKET, SO_RCVBUF, 4 << 20);
+		socket.set_option(SOL_SOCKET, SO_SNDBUF, 4 << 20);
+		return socket;
+	}
+
+private:
+
+	int fd_ = -1;
+};
+
+
+// Preallocated recvmmsg()/sendmmsg() headers for batch of datagrams.
+// Buffers are owned by caller: received datagrams are stored directly into
+// turner::inbound_datagram buffers and outbound datagrams are sent from
+// wherever server composed them (response buffer or in place in receive
+// buffer).
+class mmsg_batch
+{
+public:
+
+	mmsg_batch (size_t batch_size)
+		: headers_(batch_size)
+		, iov_(batch_size)
+		, addresses_(batch_size)
+	{
+		for (auto i = 0u;  i < batch_size;  ++i)
+		{
+			headers_[i].msg_hdr.msg_iov = &iov_[i];
+			headers_[i].msg_hdr.msg_iovlen = 1;
+			headers_[i].msg_hdr.msg_name = &addresses_[i];
+		}
+	}
+
+	size_t size () const noexcept
+	{
+		return headers_.size();
+	}
+
+	// receive into \a in buffers at their offset, leaving \a tailroom bytes
+	// after data. Sets size_bytes and remote endpoint of received
+	// datagrams, returns number of received datagrams (0 if none pending)
+	size_t receive (const udp_socket &socket, const std::span<turner::inbound_datagram> &in, size_t tailroom) noexcept
+	{
+		auto count = (std::min)(in.size(), headers_.size());
+		for (auto i = 0u;  i < count;  ++i)
+		{
+			auto buffer = in[i].buffer.subspan(in[i].offset);
+			iov_[i] = {buffer.data(), buffer.size() - tailroom};
+			headers_[i].msg_hdr.msg_namelen = sizeof(addresses_[i]);
+		}
+
+		auto result = ::recvmmsg(socket.native_handle(), headers_.data(), count, MSG_DONTWAIT, nullptr);
+		if (result <= 0)
+		{
+			return 0;
+		}
+
+		for (auto i = 0;  i < result;  ++i)
+		{
+			in[i].size_bytes = headers_[i].msg_len;
+			in[i].tuple.client = to_endpoint(addresses_[i]);
+		}
+		return static_cast<size_t>(result);
+	}
+
+	// set \a index datagram to send \a data to \a destination
+	void set (size_t index, const std::span<const std::byte> &data, const turner::endpoint &destination) noexcept
+	{
+		iov_[index] = {const_cast<std::byte *>(data.data()), data.size_bytes()};
+		headers_[index].msg_hdr.msg_namelen = to_sockaddr(destination, addresses_[index]);
+	}
+
+	// send \a count datagrams starting at \a first. Returns number of
+	// datagrams sent. Datagram failing with error other than EAGAIN (e.g.
+	// ICMP unreachable from previous send) is dropped.
+	size_t send (const udp_socket &socket, size_t first, size_t count) noexcept
+	{
+		size_t sent = 0;
+		for (auto end = first + count;  first < end;  /**/)
+		{
+			auto result = ::sendmmsg(socket.native_handle(), headers_.data() + first, end - first, MSG_DONTWAIT);
+			if (result > 0)
+			{
+				sent += result;
+				first += result;
+			}
+			else if (errno == EAGAIN || errno == EWOULDBLOCK)
+			{
+				break;
+			}
+			else
+			{
+				first++;
+			}
+		}
+		return sent;
+	}
+
+private:
+
+	std::vector<mmsghdr> headers_;
+	std::vector<iovec> iov_;
+	std::vector<sockaddr_storage> addresses_;
+};
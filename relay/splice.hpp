@@ -0,0 +1,128 @@
+#pragma once
+
+// Zero-copy forwarding between bound RFC 6062 data and peer connections:
+// bytes are moved socket -> pipe -> socket with splice(2) without copying
+// them into user space
+//
+// Not part of turner_relay yet: relay serves UDP allocations only. Helper
+// is for TCP host that pairs connections with turner::connection_table.
+
+#include <relay/socket.hpp>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstddef>
+
+
+// One direction of spliced connection pair. Pipe holds bytes received from
+// source but not yet accepted by destination (destination socket buffer
+// full): pump() first drains pipe, then moves new data.
+class splice_pipe
+{
+public:
+
+	enum class status
+	{
+		// both sockets would block: wait for readable source or writable
+		// destination (if pending() != 0)
+		would_block,
+
+		// source closed and everything forwarded: shutdown destination
+		// write side
+		eof,
+
+		// socket error (errno is set): close both connections
+		error,
+	};
+
+	// pipe capacity: bytes buffered in kernel per direction
+	static constexpr size_t capacity = 256 * 1024;
+
+	splice_pipe ()
+	{
+		if (::pipe2(fd_, O_NONBLOCK | O_CLOEXEC) == -1)
+		{
+			throw system_error("pipe2");
+		}
+
+		// best effort: default is 16 pages
+		::fcntl(fd_[1], F_SETPIPE_SZ, static_cast<int>(capacity));
+	}
+
+	splice_pipe (const splice_pipe &) = delete;
+	splice_pipe &operator= (const splice_pipe &) = delete;
+
+	~splice_pipe () noexcept
+	{
+		::close(fd_[0]);
+		::close(fd_[1]);
+	}
+
+	// number of bytes received but not sent yet
+	size_t pending () const noexcept
+	{
+		return pending_;
+	}
+
+	// total number of forwarded bytes
+	size_t forwarded () const noexcept
+	{
+		return forwarded_;
+	}
+
+	// forward from socket \a from to socket \a to until either would block
+	status pump (int from, int to) noexcept
+	{
+		constexpr auto flags = SPLICE_F_MOVE | SPLICE_F_NONBLOCK;
+		while (true)
+		{
+			while (pending_)
+			{
+				auto result = ::splice(fd_[0], nullptr, to, nullptr, pending_, flags);
+				if (result > 0)
+				{
+					pending_ -= result;
+					forwarded_ += result;
+				}
+				else if (result == 0)
+				{
+					// pipe is empty although pending_ says otherwise (we
+					// hold write end, it can't be EOF): no errno is set
+					errno = EIO;
+					return status::error;
+				}
+				else if (errno == EAGAIN)
+				{
+					return status::would_block;
+				}
+				else
+				{
+					return status::error;
+				}
+			}
+
+			auto result = ::splice(from, nullptr, fd_[1], nullptr, capacity, flags);
+			if (result > 0)
+			{
+				pending_ = result;
+			}
+			else if (result == 0)
+			{
+				return status::eof;
+			}
+			else if (errno == EAGAIN)
+			{
+				return status::would_block;
+			}
+			else
+			{
+				return status::error;
+			}
+		}
+	}
+
+private:
+
+	int fd_[2];
+	size_t pending_ = 0, forwarded_ = 0;
+};
@@ -0,0 +1,110 @@
+#include <relay/splice.hpp>
+#include <turner/test>
+#include <sys/socket.h>
+#include <array>
+#include <vector>
+
+namespace {
+
+// connected non-blocking stream socket pair, closed on destruction
+struct socket_pair
+{
+	int fd[2];
+
+	socket_pair ()
+	{
+		REQUIRE(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0, fd) == 0);
+	}
+
+	~socket_pair () noexcept
+	{
+		::close(fd[0]);
+		::close(fd[1]);
+	}
+};
+
+// read everything available from \a fd
+std::vector<char> drain (int fd)
+{
+	std::vector<char> data;
+	std::array<char, 4096> buffer;
+	ssize_t size;
+	while ((size = ::read(fd, buffer.data(), buffer.size())) > 0)
+	{
+		data.insert(data.end(), buffer.data(), buffer.data() + size);
+	}
+	return data;
+}
+
+TEST_CASE("splice_pipe")
+{
+	// client -> [source] pipe [destination] -> peer
+	socket_pair source, destination;
+	auto client = source.fd[0], from = source.fd[1];
+	auto to = destination.fd[0], peer = destination.fd[1];
+
+	splice_pipe pipe;
+	CHECK(pipe.pending() == 0);
+	CHECK(pipe.forwarded() == 0);
+
+	SECTION("would_block: source") //{{{1
+	{
+		CHECK(pipe.pump(from, to) == splice_pipe::status::would_block);
+		CHECK(pipe.forwarded() == 0);
+
+		REQUIRE(::write(client, "hello", 5) == 5);
+		CHECK(pipe.pump(from, to) == splice_pipe::status::would_block);
+		CHECK(pipe.pending() == 0);
+		CHECK(pipe.forwarded() == 5);
+		CHECK(drain(peer) == std::vector<char>{'h', 'e', 'l', 'l', 'o'});
+	}
+
+	SECTION("would_block: destination") //{{{1
+	{
+		int size = 4096;
+		REQUIRE(::setsockopt(to, SOL_SOCKET, SO_SNDBUF, &size, sizeof(size)) == 0);
+
+		// write until destination is full and data is left in pipe
+		std::vector<char> chunk(64 * 1024, 'x');
+		size_t sent = 0;
+		while (pipe.pending() == 0)
+		{
+			auto result = ::write(client, chunk.data(), chunk.size());
+			REQUIRE(result > 0);
+			sent += result;
+			REQUIRE(pipe.pump(from, to) == splice_pipe::status::would_block);
+		}
+		CHECK(pipe.forwarded() < sent);
+
+		// peer reads: pending data is flushed first, then rest of source
+		size_t received = 0;
+		while (received < sent)
+		{
+			received += drain(peer).size();
+			REQUIRE(pipe.pump(from, to) == splice_pipe::status::would_block);
+		}
+		CHECK(received == sent);
+		CHECK(pipe.pending() == 0);
+		CHECK(pipe.forwarded() == sent);
+	}
+
+	SECTION("eof") //{{{1
+	{
+		REQUIRE(::write(client, "hello", 5) == 5);
+		REQUIRE(::shutdown(client, SHUT_WR) == 0);
+		CHECK(pipe.pump(from, to) == splice_pipe::status::eof);
+		CHECK(pipe.pending() == 0);
+		CHECK(pipe.forwarded() == 5);
+		CHECK(drain(peer).size() == 5);
+	}
+
+	SECTION("error") //{{{1
+	{
+		CHECK(pipe.pump(-1, to) == splice_pipe::status::error);
+		CHECK(errno == EBADF);
+	}
+
+	//}}}1
+}
+
+} // namespace
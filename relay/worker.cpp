@@ -0,0 +1,273 @@
+#include <relay/worker.hpp>
+#include <sys/epoll.h>
+
+
+namespace {
+
+using namespace std::chrono_literals;
+
+turner::server::options server_options (const config &config, std::span<const std::byte> nonce_secret)
+{
+	turner::server::options options;
+	options.realm = config.realm;
+	options.nonce_secret = nonce_secret;
+	if (config.relay_address->is_v4())
+	{
+		options.relay_address_v4 = config.relay_address;
+	}
+	else
+	{
+		options.relay_address_v6 = config.relay_address;
+	}
+	options.first_port = config.first_port;
+	options.last_port = config.last_port;
+	options.capacity = config.capacity;
+	options.response_cache_capacity = config.capacity;
+	return options;
+}
+
+// Reserved port pair is held for this long waiting for RESERVATION-TOKEN
+constexpr auto reservation_lifetime = 30s;
+
+// Datagrams received per socket per readiness event before serving others
+constexpr size_t max_batches_per_event = 4;
+
+} // namespace
+
+
+worker::worker (const config &config,
+	size_t index,
+	turner::port_pool &ports,
+	turner::credential_cache &credentials,
+	std::span<const std::byte> nonce_secret)
+	: config_{config}
+	, index_{index}
+	, ports_{ports}
+	, port_cache_{ports}
+	, epoll_{::epoll_create1(EPOLL_CLOEXEC)}
+	, listen_{udp_socket::open(config.listen, true)}
+	, relay_(size_t{config.last_port} - config.first_port + 1)
+	, rx_(config.batch_size)
+	, tx_(config.batch_size)
+	, in_(config.batch_size)
+	, out_(config.batch_size)
+	, receive_batch_{config.batch_size}
+	, send_batch_{config.batch_size}
+	, server_{server_options(config, nonce_secret), *this, credentials}
+{
+	if (epoll_ == -1)
+	{
+		throw system_error("epoll_create1");
+	}
+
+	epoll_event event{};
+	event.events = EPOLLIN;
+	event.data.u32 = 0;
+	if (::epoll_ctl(epoll_, EPOLL_CTL_ADD, listen_.native_handle(), &event) == -1)
+	{
+		throw system_error("epoll_ctl");
+	}
+
+	// datagrams are received with room for ChannelData/Data indication
+	// framing in front and padding after
+	for (auto i = 0u;  i < in_.size();  ++i)
+	{
+		in_[i].buffer = rx_[i];
+		in_[i].offset = turner::turn::data_indication_headroom_bytes;
+	}
+}
+
+
+worker::~worker () noexcept
+{
+	if (epoll_ != -1)
+	{
+		::close(epoll_);
+	}
+}
+
+
+void worker::run (std::stop_token stop)
+{
+	std::vector<epoll_event> events(64);
+	auto next_tick = now();
+	while (!stop.stop_requested())
+	{
+		auto count = ::epoll_wait(epoll_, events.data(), static_cast<int>(events.size()), 100);
+		for (auto i = 0;  i < count;  ++i)
+		{
+			serve(events[i].data.u32);
+		}
+
+		// process() expires allocations when busy, cover idle periods
+		if (auto time = now();  time >= next_tick)
+		{
+			server_.expire(time);
+			if (index_ == 0)
+			{
+				ports_.expire(time);
+			}
+			publish_stats();
+			next_tick = time + 1s;
+		}
+	}
+	publish_stats();
+}
+
+
+void worker::serve (uint32_t socket_index)
+{
+	const udp_socket *socket = &listen_;
+	turner::endpoint local = config_.listen;
+	if (socket_index > 0)
+	{
+		socket = &relay_[socket_index - 1];
+		local = {*config_.relay_address, static_cast<uint16_t>(config_.first_port + socket_index - 1)};
+	}
+
+	for (auto round = 0u;  round < max_batches_per_event;  ++round)
+	{
+		auto count = receive_batch_.receive(*socket, in_, turner::turn::relay_tailroom_bytes);
+		if (count == 0)
+		{
+			break;
+		}
+		stats_.received.fetch_add(count, std::memory_order_relaxed);
+
+		for (auto i = 0u;  i < count;  ++i)
+		{
+			in_[i].tuple.server = local;
+			out_[i].buffer = tx_[i];
+		}
+		send(server_.process(std::span{in_}.first(count), out_));
+
+		if (count < in_.size())
+		{
+			// drained
+			break;
+		}
+	}
+}
+
+
+void worker::send (size_t count)
+{
+	// group consecutive datagrams sent from same socket into single sendmmsg()
+	for (size_t first = 0, last = 0;  first < count;  first = last)
+	{
+		auto socket = socket_for(out_[first].tuple.server);
+		for (last = first;  last < count && socket_for(out_[last].tuple.server) == socket;  ++last)
+		{
+			send_batch_.set(last, out_[last].data, out_[last].tuple.client);
+		}
+		if (socket)
+		{
+			stats_.sent.fetch_add(send_batch_.send(*socket, first, last - first), std::memory_order_relaxed);
+		}
+	}
+}
+
+
+const udp_socket *worker::socket_for (const turner::endpoint &local) const noexcept
+{
+	if (local == config_.listen)
+	{
+		return &listen_;
+	}
+	else if (local.port >= config_.first_port && local.port <= config_.last_port)
+	{
+		if (auto &socket = relay_[local.port - config_.first_port])
+		{
+			return &socket;
+		}
+	}
+	return nullptr;
+}
+
+
+void worker::publish_stats () noexcept
+{
+	auto &stats = server_.stats();
+	stats_.to_peer.store(stats.to_peer, std::memory_order_relaxed);
+	stats_.to_client.store(stats.to_client, std::memory_order_relaxed);
+	stats_.dropped.store(stats.dropped, std::memory_order_relaxed);
+	stats_.allocations.store(server_.allocation_count(), std::memory_order_relaxed);
+}
+
+
+std::optional<std::string_view> worker::get_password (std::string_view username, std::string_view realm)
+{
+	if (realm == config_.realm)
+	{
+		if (auto it = config_.users.find(username);  it != config_.users.end())
+		{
+			return it->second;
+		}
+	}
+	return std::nullopt;
+}
+
+
+std::optional<worker::relay_port> worker::allocate_port (const port_request &request)
+{
+	relay_port result{};
+	std::optional<uint16_t> port;
+	if (request.reservation_token)
+	{
+		port = ports_.claim(*request.reservation_token, now());
+	}
+	else if (request.reserve_next)
+	{
+		if (auto pair = ports_.allocate_pair(now() + reservation_lifetime))
+		{
+			port = pair->first;
+			result.reservation_token = pair->second;
+		}
+	}
+	else if (request.even_port)
+	{
+		port = ports_.allocate_even();
+	}
+	else
+	{
+		port = port_cache_.allocate();
+	}
+
+	if (!port)
+	{
+		return std::nullopt;
+	}
+	result.port = *port;
+
+	auto index = *port - config_.first_port;
+	try
+	{
+		relay_[index] = udp_socket::open({*config_.relay_address, *port});
+	}
+	catch (const std::system_error &)
+	{
+		// port used by other application
+		port_cache_.release(*port);
+		return std::nullopt;
+	}
+
+	epoll_event event{};
+	event.events = EPOLLIN;
+	event.data.u32 = static_cast<uint32_t>(index + 1);
+	if (::epoll_ctl(epoll_, EPOLL_CTL_ADD, relay_[index].native_handle(), &event) == -1)
+	{
+		relay_[index].close();
+		port_cache_.release(*port);
+		return std::nullopt;
+	}
+
+	return result;
+}
+
+
+void worker::release_port (const turner::endpoint &relayed) noexcept
+{
+	// closing socket also removes it from epoll set
+	relay_[relayed.port - config_.first_port].close();
+	port_cache_.release(relayed.port);
+}
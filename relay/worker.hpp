@@ -0,0 +1,94 @@
+#pragma once
+
+// Relay worker: single thread owning SO_REUSEPORT listening socket, relay
+// sockets of its allocations and turner::server instance (allocation shard).
+//
+// Kernel picks listening socket (and therefore worker) by hash of datagram
+// source/destination address and port i.e. all datagrams of 5-tuple are
+// served by same worker and allocations need no cross-worker
+// synchronisation. Peer datagrams arrive on relay socket opened by worker
+// that created allocation. Only port_pool and credential_cache are shared.
+
+#include <relay/config.hpp>
+#include <relay/socket.hpp>
+#include <turner/server>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <span>
+#include <stop_token>
+#include <vector>
+
+
+struct worker_statistics
+{
+	std::atomic<uint64_t> received{0}, sent{0};
+	std::atomic<uint64_t> to_peer{0}, to_client{0}, dropped{0};
+	std::atomic<size_t> allocations{0};
+};
+
+
+class worker: public turner::server_hooks
+{
+public:
+
+	worker (const config &config,
+		size_t index,
+		turner::port_pool &ports,
+		turner::credential_cache &credentials,
+		std::span<const std::byte> nonce_secret
+	);
+
+	worker (const worker &) = delete;
+	worker &operator= (const worker &) = delete;
+
+	~worker () noexcept;
+
+	const udp_socket &listen_socket () const noexcept
+	{
+		return listen_;
+	}
+
+	const worker_statistics &stats () const noexcept
+	{
+		return stats_;
+	}
+
+	// serve datagrams until \a stop is requested
+	void run (std::stop_token stop);
+
+	// turner::server_hooks
+	std::optional<std::string_view> get_password (std::string_view username, std::string_view realm) final;
+	std::optional<relay_port> allocate_port (const port_request &request) final;
+	void release_port (const turner::endpoint &relayed) noexcept final;
+
+private:
+
+	const config &config_;
+	const size_t index_;
+	turner::port_pool &ports_;
+	turner::port_pool::local_cache port_cache_;
+	int epoll_ = -1;
+
+	// socket index 0 is listening socket, index 1 + (port - first_port) is
+	// relay socket
+	udp_socket listen_;
+	std::vector<udp_socket> relay_;
+
+	// receive buffers fit jumbo-less MTU with relay framing room
+	std::vector<std::array<std::byte, 2048>> rx_;
+	std::vector<std::array<std::byte, turner::server::max_response_size_bytes>> tx_;
+	std::vector<turner::inbound_datagram> in_;
+	std::vector<turner::outbound_datagram> out_;
+	mmsg_batch receive_batch_, send_batch_;
+
+	worker_statistics stats_{};
+
+	// last member: server destructor releases relay ports (sockets)
+	turner::server server_;
+
+	void serve (uint32_t socket_index);
+	void send (size_t count);
+	const udp_socket *socket_for (const turner::endpoint &local) const noexcept;
+	void publish_stats () noexcept;
+};
@@ -0,0 +1,55 @@
+#include <turner/__crc32>
+#include <turner/bench>
+#include <random>
+#include <vector>
+
+namespace {
+
+namespace crc = turner::__crc32;
+using crc32_fn = uint32_t(const std::span<const std::byte> &) noexcept;
+
+std::span<const std::byte> random_bytes (size_t size)
+{
+	static const auto buffer = []()
+	{
+		std::vector<std::byte> result(64 * 1024);
+		std::mt19937 random{};
+		for (auto &b: result)
+		{
+			b = static_cast<std::byte>(random());
+		}
+		return result;
+	}();
+	return std::span{buffer}.first(size);
+}
+
+void crc32 (benchmark::State &state, crc32_fn *fn)
+{
+	if (fn == crc::clmul && !crc::has_clmul())
+	{
+		state.SkipWithError("no CPU support");
+		return;
+	}
+
+	auto data = random_bytes(state.range(0));
+	turner_bench::run_per_cycle(state, data.size_bytes(), [&]
+	{
+		benchmark::DoNotOptimize(fn(data));
+	});
+}
+
+// from smallest STUN message with FINGERPRINT up to Ethernet MTU
+void message_sizes (benchmark::internal::Benchmark *b)
+{
+	for (auto size: {28, 64, 100, 128, 200, 256, 512, 1024, 1500})
+	{
+		b->Arg(size);
+	}
+}
+
+BENCHMARK_CAPTURE(crc32, slice_by_4, crc::slice_by_4)->Apply(message_sizes);
+BENCHMARK_CAPTURE(crc32, slice_by_16, crc::slice_by_16)->Apply(message_sizes);
+BENCHMARK_CAPTURE(crc32, clmul, crc::clmul)->Apply(message_sizes);
+BENCHMARK_CAPTURE(crc32, dispatch, crc::crc32)->Apply(message_sizes);
+
+} // namespace
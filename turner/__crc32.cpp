@@ -0,0 +1,471 @@
+#include <turner/__crc32>
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+	#define __turner_crc32_clmul 1
+	#if defined(_MSC_VER)
+		#include <intrin.h>
+		#define __turner_crc32_target
+	#else
+		#include <cpuid.h>
+		#define __turner_crc32_target __attribute__((target("pclmul,sse4.1")))
+	#endif
+	#include <immintrin.h>
+#else
+	#define __turner_crc32_clmul 0
+#endif
+
+namespace turner::__crc32 {
+
+namespace {
+
+// See ThirdPartySources.txt for copyright notices
+
+template <uint32_t Polynomial, size_t Slices>
+struct lookup_table
+{
+	uint32_t table[Slices][256];
+
+	constexpr lookup_table () noexcept
+	{
+		for (uint32_t i = 0;  i <= 0xff;  ++i)
+		{
+			uint32_t crc = i;
+			for (int j = 0;  j < 8;  ++j)
+			{
+				crc = (crc >> 1) ^ ((crc & 1) * Polynomial);
+			}
+			table[0][i] = crc;
+		}
+
+		for (uint32_t i = 0;  i <= 0xff;  ++i)
+		{
+			for (size_t s = 1;  s < Slices;  ++s)
+			{
+				table[s][i] = (table[s - 1][i] >> 8) ^ table[0][(uint8_t)table[s - 1][i]];
+			}
+		}
+	}
+};
+
+constexpr lookup_table<0xedb88320, 16> lookup{};
+
+inline uint32_t load (const std::byte *p) noexcept
+{
+	uint32_t v;
+	std::memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+inline uint32_t update_4 (uint32_t crc, const std::byte *p) noexcept
+{
+	crc ^= load(p);
+	return
+		lookup.table[3][(uint8_t)(crc      )] ^
+		lookup.table[2][(uint8_t)(crc >>  8)] ^
+		lookup.table[1][(uint8_t)(crc >> 16)] ^
+		lookup.table[0][(uint8_t)(crc >> 24)]
+	;
+}
+
+inline uint32_t update_16 (uint32_t crc, const std::byte *p) noexcept
+{
+	auto one = load(p) ^ crc, two = load(p + 4), three = load(p + 8), four = load(p + 12);
+	return
+		lookup.table[15][(uint8_t)(one      )] ^
+		lookup.table[14][(uint8_t)(one >>  8)] ^
+		lookup.table[13][(uint8_t)(one >> 16)] ^
+		lookup.table[12][(uint8_t)(one >> 24)] ^
+		lookup.table[11][(uint8_t)(two      )] ^
+		lookup.table[10][(uint8_t)(two >>  8)] ^
+		lookup.table[ 9][(uint8_t)(two >> 16)] ^
+		lookup.table[ 8][(uint8_t)(two >> 24)] ^
+		lookup.table[ 7][(uint8_t)(three      )] ^
+		lookup.table[ 6][(uint8_t)(three >>  8)] ^
+		lookup.table[ 5][(uint8_t)(three >> 16)] ^
+		lookup.table[ 4][(uint8_t)(three >> 24)] ^
+		lookup.table[ 3][(uint8_t)(four      )] ^
+		lookup.table[ 2][(uint8_t)(four >>  8)] ^
+		lookup.table[ 1][(uint8_t)(four >> 16)] ^
+		lookup.table[ 0][(uint8_t)(four >> 24)]
+	;
+}
+
+inline uint32_t update_tail (uint32_t crc, const std::byte *first, const std::byte *last) noexcept
+{
+	// STUN messages are padded to 4B boundary i.e. for FINGERPRINT final
+	// loop is never entered but keep it for generic use
+	for (/**/;  last - first >= 4;  first += 4)
+	{
+		crc = update_4(crc, first);
+	}
+	while (first != last)
+	{
+		crc = (crc >> 8) ^ lookup.table[0][(uint8_t)crc ^ (uint8_t)*first++];
+	}
+	return crc;
+}
+
+#if __turner_crc32_clmul
+
+__turner_crc32_target
+inline __m128i fold (__m128i x, __m128i y, __m128i k) noexcept
+{
+	auto lo = _mm_clmulepi64_si128(x, k, 0x00);
+	auto hi = _mm_clmulepi64_si128(x, k, 0x11);
+	return _mm_xor_si128(_mm_xor_si128(hi, y), lo);
+}
+
+// Carry-less multiplication folding constants for reflected 0xedb88320
+// from "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ
+// Instruction", Intel, 2009.
+alignas(16) constexpr uint64_t k1k2[] = { 0x0154442bd4, 0x01c6e41596 };
+alignas(16) constexpr uint64_t k3k4[] = { 0x01751997d0, 0x00ccaa009e };
+alignas(16) constexpr uint64_t k5k0[] = { 0x0163cd6124, 0x0000000000 };
+alignas(16) constexpr uint64_t poly[] = { 0x01db710641, 0x01f7011641 };
+
+// Reduce 128bit folded value to intermediate (not inverted) CRC value
+__turner_crc32_target
+inline uint32_t reduce (__m128i x1) noexcept
+{
+	auto x0 = _mm_load_si128(reinterpret_cast<const __m128i *>(k3k4));
+
+	// fold 128 -> 64 bits
+	auto x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+	auto x3 = _mm_setr_epi32(~0, 0, ~0, 0);
+	x1 = _mm_srli_si128(x1, 8);
+	x1 = _mm_xor_si128(x1, x2);
+
+	x0 = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(k5k0));
+	x2 = _mm_srli_si128(x1, 4);
+	x1 = _mm_and_si128(x1, x3);
+	x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+	x1 = _mm_xor_si128(x1, x2);
+
+	// Barrett reduction 64 -> 32 bits
+	x0 = _mm_load_si128(reinterpret_cast<const __m128i *>(poly));
+	x2 = _mm_and_si128(x1, x3);
+	x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+	x2 = _mm_and_si128(x2, x3);
+	x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+	x1 = _mm_xor_si128(x1, x2);
+
+	return static_cast<uint32_t>(_mm_extract_epi32(x1, 1));
+}
+
+// Carry-less multiplication folding.
+//
+// Requires size >= 64, processes only whole 16B blocks and returns
+// intermediate (not inverted) CRC value.
+__turner_crc32_target
+uint32_t clmul_fold (uint32_t crc, const std::byte *p, size_t size) noexcept
+{
+	auto x1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 0x00));
+	auto x2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 0x10));
+	auto x3 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 0x20));
+	auto x4 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 0x30));
+	x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(static_cast<int>(crc)));
+	p += 64;
+	size -= 64;
+
+	// parallel fold 4x16B
+	auto x0 = _mm_load_si128(reinterpret_cast<const __m128i *>(k1k2));
+	while (size >= 64)
+	{
+		auto x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+		auto x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+		auto x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+		auto x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+
+		x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+		x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+		x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+		x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+
+		x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 0x00)));
+		x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 0x10)));
+		x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 0x20)));
+		x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 0x30)));
+
+		p += 64;
+		size -= 64;
+	}
+
+	// fold 4x16B into 16B
+	x0 = _mm_load_si128(reinterpret_cast<const __m128i *>(k3k4));
+	x1 = fold(x1, x2, x0);
+	x1 = fold(x1, x3, x0);
+	x1 = fold(x1, x4, x0);
+
+	// fold remaining 16B blocks
+	while (size >= 16)
+	{
+		x1 = fold(x1, _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)), x0);
+		p += 16;
+		size -= 16;
+	}
+
+	return reduce(x1);
+}
+
+__turner_crc32_target
+inline __m128i load_128 (const std::byte *p) noexcept
+{
+	return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+}
+
+// Fold 4 independent inputs \a p of at least 1 block each, processing
+// only whole 16B blocks. Single input fold is dependency chain of PCLMULQDQ
+// (multi-cycle latency), interleaving chains of different inputs keeps
+// multiplier busy. Updates \a crc with intermediate (not inverted) values.
+__turner_crc32_target
+void clmul_fold_x4 (uint32_t *crc, const std::byte *const *p, const size_t *blocks) noexcept
+{
+	auto k = _mm_load_si128(reinterpret_cast<const __m128i *>(k3k4));
+
+	auto x0 = _mm_xor_si128(load_128(p[0]), _mm_cvtsi32_si128(static_cast<int>(crc[0])));
+	auto x1 = _mm_xor_si128(load_128(p[1]), _mm_cvtsi32_si128(static_cast<int>(crc[1])));
+	auto x2 = _mm_xor_si128(load_128(p[2]), _mm_cvtsi32_si128(static_cast<int>(crc[2])));
+	auto x3 = _mm_xor_si128(load_128(p[3]), _mm_cvtsi32_si128(static_cast<int>(crc[3])));
+
+	auto common_blocks = (std::min)({blocks[0], blocks[1], blocks[2], blocks[3]});
+	size_t offset = 16;
+	for (/**/;  offset < common_blocks * 16;  offset += 16)
+	{
+		x0 = fold(x0, load_128(p[0] + offset), k);
+		x1 = fold(x1, load_128(p[1] + offset), k);
+		x2 = fold(x2, load_128(p[2] + offset), k);
+		x3 = fold(x3, load_128(p[3] + offset), k);
+	}
+
+	for (auto o = offset;  o < blocks[0] * 16;  o += 16)
+	{
+		x0 = fold(x0, load_128(p[0] + o), k);
+	}
+	for (auto o = offset;  o < blocks[1] * 16;  o += 16)
+	{
+		x1 = fold(x1, load_128(p[1] + o), k);
+	}
+	for (auto o = offset;  o < blocks[2] * 16;  o += 16)
+	{
+		x2 = fold(x2, load_128(p[2] + o), k);
+	}
+	for (auto o = offset;  o < blocks[3] * 16;  o += 16)
+	{
+		x3 = fold(x3, load_128(p[3] + o), k);
+	}
+
+	crc[0] = reduce(x0);
+	crc[1] = reduce(x1);
+	crc[2] = reduce(x2);
+	crc[3] = reduce(x3);
+}
+
+bool detect_clmul () noexcept
+{
+	#if defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 1);
+		return (info[2] & (1 << 1)) && (info[2] & (1 << 19));
+	#else
+		unsigned eax, ebx, ecx, edx;
+		return __get_cpuid(1, &eax, &ebx, &ecx, &edx)
+			&& (ecx & bit_PCLMUL)
+			&& (ecx & bit_SSE4_1)
+		;
+	#endif
+}
+
+const bool cpu_has_clmul = detect_clmul();
+
+// Below this size folding setup does not pay off
+constexpr size_t clmul_min_size_bytes = 64;
+
+#else
+
+const bool cpu_has_clmul = false;
+
+#endif
+
+} // namespace
+
+uint32_t slice_by_4 (const std::span<const std::byte> &data) noexcept
+{
+	return ~update_tail(~0U, data.data(), data.data() + data.size_bytes());
+}
+
+uint32_t slice_by_16 (const std::span<const std::byte> &data) noexcept
+{
+	auto first = data.data(), last = first + data.size_bytes();
+	uint32_t crc = ~0U;
+	for (/**/;  last - first >= 16;  first += 16)
+	{
+		crc = update_16(crc, first);
+	}
+	return ~update_tail(crc, first, last);
+}
+
+bool has_clmul () noexcept
+{
+	return cpu_has_clmul;
+}
+
+uint32_t clmul (const std::span<const std::byte> &data) noexcept
+{
+	#if __turner_crc32_clmul
+		auto first = data.data(), last = first + data.size_bytes();
+		uint32_t crc = ~0U;
+		if (auto size = data.size_bytes();  size >= clmul_min_size_bytes)
+		{
+			size &= ~size_t{15};
+			crc = clmul_fold(crc, first, size);
+			first += size;
+		}
+		return ~update_tail(crc, first, last);
+	#else
+		return slice_by_16(data);
+	#endif
+}
+
+uint32_t crc32 (const std::span<const std::byte> &data) noexcept
+{
+	#if __turner_crc32_clmul
+		if (cpu_has_clmul && data.size_bytes() >= clmul_min_size_bytes)
+		{
+			return clmul(data);
+		}
+	#endif
+	return slice_by_16(data);
+}
+
+namespace {
+
+constexpr size_t interleave = 4;
+
+void slice_by_16_x4 (const std::span<const std::byte> *data, uint32_t *crc) noexcept
+{
+	auto p0 = data[0].data(), p1 = data[1].data(), p2 = data[2].data(), p3 = data[3].data();
+	uint32_t c0 = ~0U, c1 = ~0U, c2 = ~0U, c3 = ~0U;
+
+	auto common_size = (std::min)({
+		data[0].size_bytes(),
+		data[1].size_bytes(),
+		data[2].size_bytes(),
+		data[3].size_bytes(),
+	});
+
+	for (auto end = p0 + (common_size & ~size_t{15});  p0 != end;  p0 += 16, p1 += 16, p2 += 16, p3 += 16)
+	{
+		c0 = update_16(c0, p0);
+		c1 = update_16(c1, p1);
+		c2 = update_16(c2, p2);
+		c3 = update_16(c3, p3);
+	}
+
+	auto finish = [](uint32_t crc, const std::byte *first, const std::span<const std::byte> &data) noexcept
+	{
+		auto last = data.data() + data.size_bytes();
+		for (/**/;  last - first >= 16;  first += 16)
+		{
+			crc = update_16(crc, first);
+		}
+		return ~update_tail(crc, first, last);
+	};
+
+	crc[0] = finish(c0, p0, data[0]);
+	crc[1] = finish(c1, p1, data[1]);
+	crc[2] = finish(c2, p2, data[2]);
+	crc[3] = finish(c3, p3, data[3]);
+}
+
+#if __turner_crc32_clmul
+
+void clmul_x4 (const std::span<const std::byte> *data, uint32_t *crc) noexcept
+{
+	const std::byte *p[interleave];
+	size_t blocks[interleave];
+	for (auto i = 0u;  i < interleave;  ++i)
+	{
+		p[i] = data[i].data();
+		blocks[i] = data[i].size_bytes() / 16;
+		crc[i] = ~0U;
+	}
+
+	clmul_fold_x4(crc, p, blocks);
+
+	for (auto i = 0u;  i < interleave;  ++i)
+	{
+		auto first = p[i] + blocks[i] * 16, last = p[i] + data[i].size_bytes();
+		crc[i] = ~update_tail(crc[i], first, last);
+	}
+}
+
+#endif
+
+} // namespace
+
+void crc32 (const std::span<const std::byte> *data, uint32_t *crc, size_t count) noexcept
+{
+	auto x4 = slice_by_16_x4;
+	size_t min_size_bytes = 0, max_size_bytes = SIZE_MAX;
+
+	#if __turner_crc32_clmul
+		// longer buffers are folded 4x in parallel by clmul() itself,
+		// shorter ones are interleaved across buffers
+		if (cpu_has_clmul)
+		{
+			x4 = clmul_x4;
+			min_size_bytes = 16;
+			max_size_bytes = clmul_min_size_bytes - 1;
+		}
+	#endif
+
+	std::span<const std::byte> group[interleave];
+	size_t index[interleave];
+	size_t group_size = 0;
+
+	for (auto i = 0u;  i < count;  ++i)
+	{
+		if (data[i].size_bytes() < min_size_bytes || data[i].size_bytes() > max_size_bytes)
+		{
+			crc[i] = crc32(data[i]);
+			continue;
+		}
+
+		group[group_size] = data[i];
+		index[group_size] = i;
+		if (++group_size == interleave)
+		{
+			uint32_t result[interleave];
+			x4(group, result);
+			for (auto j = 0u;  j < interleave;  ++j)
+			{
+				crc[index[j]] = result[j];
+			}
+			group_size = 0;
+		}
+	}
+
+	if (group_size == 1)
+	{
+		crc[index[0]] = crc32(group[0]);
+	}
+	else if (group_size)
+	{
+		// fill incomplete group with duplicates, their results are ignored
+		for (auto j = group_size;  j < interleave;  ++j)
+		{
+			group[j] = group[0];
+		}
+
+		uint32_t result[interleave];
+		x4(group, result);
+		for (auto j = 0u;  j < group_size;  ++j)
+		{
+			crc[index[j]] = result[j];
+		}
+	}
+}
+
+} // namespace turner::__crc32
@@ -0,0 +1,85 @@
+#include <turner/__crc32>
+#include <turner/test>
+#include <array>
+#include <random>
+#include <vector>
+
+namespace {
+
+using namespace turner_test;
+namespace crc = turner::__crc32;
+
+TEST_CASE("__crc32")
+{
+	SECTION("check value")
+	{
+		auto data = "123456789"_b;
+		CHECK(crc::slice_by_4(data) == 0xcbf43926);
+		CHECK(crc::slice_by_16(data) == 0xcbf43926);
+		CHECK(crc::clmul(data) == 0xcbf43926);
+		CHECK(crc::crc32(data) == 0xcbf43926);
+	}
+
+	SECTION("empty")
+	{
+		std::span<const std::byte> data{};
+		CHECK(crc::slice_by_4(data) == 0);
+		CHECK(crc::slice_by_16(data) == 0);
+		CHECK(crc::clmul(data) == 0);
+		CHECK(crc::crc32(data) == 0);
+	}
+
+	SECTION("implementations match")
+	{
+		// cover all tail/fold combinations up to max UDP payload over Ethernet
+		std::vector<std::byte> buffer(1500 + 64);
+		std::mt19937 random{};
+		for (auto &b: buffer)
+		{
+			b = static_cast<std::byte>(random());
+		}
+
+		for (auto offset: {0, 1, 3})
+		{
+			for (auto size = 0u;  size <= 1500;  ++size)
+			{
+				auto data = std::span{buffer}.subspan(offset, size);
+				auto expected = crc::slice_by_4(data);
+				CAPTURE(offset, size);
+				if (crc::slice_by_16(data) != expected
+					|| crc::clmul(data) != expected
+					|| crc::crc32(data) != expected)
+				{
+					FAIL_CHECK("mismatch");
+				}
+			}
+		}
+	}
+
+	SECTION("batch")
+	{
+		std::vector<std::byte> buffer(1500 + 16);
+		std::mt19937 random{};
+		for (auto &b: buffer)
+		{
+			b = static_cast<std::byte>(random());
+		}
+
+		// mix of short (interleaved) and long buffers, incomplete last group
+		std::vector<std::span<const std::byte>> data;
+		for (auto size: {28, 0, 44, 9, 100, 60, 1500, 32, 20, 63, 64, 17, 1, 48})
+		{
+			data.push_back(std::span{buffer}.subspan(data.size(), size));
+		}
+
+		std::vector<uint32_t> crc(data.size());
+		crc::crc32(data.data(), crc.data(), data.size());
+		for (auto i = 0u;  i < data.size();  ++i)
+		{
+			CAPTURE(i);
+			CHECK(crc[i] == crc::slice_by_4(data[i]));
+		}
+	}
+}
+
+} // namespace
@@ -0,0 +1,457 @@
+#include <turner/__hash>
+#include <bit>
+#include <random>
+#include <utility>
+
+#if defined(__x86_64__) || defined(_M_X64)
+	#define __turner_hash_sha_ni 1
+	#if defined(_MSC_VER)
+		#include <intrin.h>
+		#define __turner_hash_target
+	#else
+		#include <cpuid.h>
+		#define __turner_hash_target __attribute__((target("sha,ssse3,sse4.1")))
+	#endif
+	#include <immintrin.h>
+#else
+	#define __turner_hash_sha_ni 0
+#endif
+
+namespace turner::__hash {
+
+namespace {
+
+inline uint32_t load_be (const std::byte *p) noexcept
+{
+	uint32_t v;
+	std::memcpy(&v, p, sizeof(v));
+	return pal::ntoh(v);
+}
+
+inline uint32_t load_le (const std::byte *p) noexcept
+{
+	return uint32_t(p[0]) | uint32_t(p[1]) << 8 | uint32_t(p[2]) << 16 | uint32_t(p[3]) << 24;
+}
+
+constexpr uint32_t sha256_k[] =
+{
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+	0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+#if __turner_hash_sha_ni
+
+// SHA-NI round groups follow "Intel SHA Extensions", Intel, 2013. Each
+// group processes 4 rounds, message schedule registers rotate over 4 slots.
+// Groups are expanded at compile time to keep schedule in registers.
+
+__turner_hash_target
+inline void sha1_group (std::integral_constant<size_t, 0>, __m128i (&)[4], __m128i &, __m128i &, __m128i &) noexcept
+{ }
+
+template <size_t G>
+__turner_hash_target
+inline void sha1_group (std::integral_constant<size_t, G>, __m128i (&msg)[4], __m128i &abcd, __m128i &e0, __m128i &e1) noexcept
+{
+	sha1_group(std::integral_constant<size_t, G - 1>{}, msg, abcd, e0, e1);
+
+	constexpr size_t g = G - 1;
+	auto &m = msg[g % 4];
+	auto &e_in = g % 2 ? e1 : e0;
+	auto &e_out = g % 2 ? e0 : e1;
+
+	if constexpr (g == 0)
+	{
+		e_in = _mm_add_epi32(e_in, m);
+	}
+	else
+	{
+		e_in = _mm_sha1nexte_epu32(e_in, m);
+	}
+	e_out = abcd;
+	if constexpr (g >= 3 && g <= 18)
+	{
+		msg[(g + 1) % 4] = _mm_sha1msg2_epu32(msg[(g + 1) % 4], m);
+	}
+	abcd = _mm_sha1rnds4_epu32(abcd, e_in, g / 5);
+	if constexpr (g >= 1 && g <= 16)
+	{
+		msg[(g + 3) % 4] = _mm_sha1msg1_epu32(msg[(g + 3) % 4], m);
+	}
+	if constexpr (g >= 2 && g <= 17)
+	{
+		msg[(g + 2) % 4] = _mm_xor_si128(msg[(g + 2) % 4], m);
+	}
+}
+
+__turner_hash_target
+void sha1_ni (sha1::state_type &state, const std::byte *blocks, size_t count) noexcept
+{
+	const auto mask = _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+
+	auto abcd = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(state.data())), 0x1b);
+	auto e0 = _mm_set_epi32(static_cast<int>(state[4]), 0, 0, 0);
+
+	for (/**/;  count;  --count, blocks += sha1::block_size_bytes)
+	{
+		auto abcd_save = abcd, e0_save = e0, e1 = e0;
+
+		__m128i msg[4];
+		for (auto i = 0u;  i < 4;  ++i)
+		{
+			msg[i] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(blocks + 16 * i)), mask);
+		}
+
+		sha1_group(std::integral_constant<size_t, 20>{}, msg, abcd, e0, e1);
+
+		e0 = _mm_sha1nexte_epu32(e0, e0_save);
+		abcd = _mm_add_epi32(abcd, abcd_save);
+	}
+
+	_mm_storeu_si128(reinterpret_cast<__m128i *>(state.data()), _mm_shuffle_epi32(abcd, 0x1b));
+	state[4] = static_cast<uint32_t>(_mm_extract_epi32(e0, 3));
+}
+
+__turner_hash_target
+inline void sha256_group (std::integral_constant<size_t, 0>, __m128i (&)[4], __m128i &, __m128i &) noexcept
+{ }
+
+template <size_t G>
+__turner_hash_target
+inline void sha256_group (std::integral_constant<size_t, G>, __m128i (&msg)[4], __m128i &state0, __m128i &state1) noexcept
+{
+	sha256_group(std::integral_constant<size_t, G - 1>{}, msg, state0, state1);
+
+	constexpr size_t g = G - 1;
+	auto &m = msg[g % 4];
+
+	auto k = _mm_add_epi32(m, _mm_loadu_si128(reinterpret_cast<const __m128i *>(sha256_k + 4 * g)));
+	state1 = _mm_sha256rnds2_epu32(state1, state0, k);
+	if constexpr (g >= 3 && g <= 14)
+	{
+		auto &next = msg[(g + 1) % 4];
+		next = _mm_add_epi32(next, _mm_alignr_epi8(m, msg[(g + 3) % 4], 4));
+		next = _mm_sha256msg2_epu32(next, m);
+	}
+	state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(k, 0x0e));
+	if constexpr (g >= 1 && g <= 12)
+	{
+		msg[(g + 3) % 4] = _mm_sha256msg1_epu32(msg[(g + 3) % 4], m);
+	}
+}
+
+__turner_hash_target
+void sha256_ni (sha256::state_type &state, const std::byte *blocks, size_t count) noexcept
+{
+	const auto mask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+	auto dcba = _mm_loadu_si128(reinterpret_cast<const __m128i *>(state.data()));
+	auto hgfe = _mm_loadu_si128(reinterpret_cast<const __m128i *>(state.data() + 4));
+	auto cdab = _mm_shuffle_epi32(dcba, 0xb1);
+	auto efgh = _mm_shuffle_epi32(hgfe, 0x1b);
+	auto state0 = _mm_alignr_epi8(cdab, efgh, 8); // ABEF
+	auto state1 = _mm_blend_epi16(efgh, cdab, 0xf0); // CDGH
+
+	for (/**/;  count;  --count, blocks += sha256::block_size_bytes)
+	{
+		auto state0_save = state0, state1_save = state1;
+
+		__m128i msg[4];
+		for (auto i = 0u;  i < 4;  ++i)
+		{
+			msg[i] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(blocks + 16 * i)), mask);
+		}
+
+		sha256_group(std::integral_constant<size_t, 16>{}, msg, state0, state1);
+
+		state0 = _mm_add_epi32(state0, state0_save);
+		state1 = _mm_add_epi32(state1, state1_save);
+	}
+
+	auto feba = _mm_shuffle_epi32(state0, 0x1b);
+	auto dchg = _mm_shuffle_epi32(state1, 0xb1);
+	_mm_storeu_si128(reinterpret_cast<__m128i *>(state.data()), _mm_blend_epi16(feba, dchg, 0xf0));
+	_mm_storeu_si128(reinterpret_cast<__m128i *>(state.data() + 4), _mm_alignr_epi8(dchg, feba, 8));
+}
+
+bool detect_sha_ni () noexcept
+{
+	#if defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] < 7)
+		{
+			return false;
+		}
+		__cpuid(info, 1);
+		auto ecx = info[2];
+		__cpuidex(info, 7, 0);
+		return (ecx & (1 << 9)) && (ecx & (1 << 19)) && (info[1] & (1 << 29));
+	#else
+		unsigned eax, ebx, ecx, edx;
+		if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)
+			|| !(ecx & bit_SSSE3)
+			|| !(ecx & bit_SSE4_1))
+		{
+			return false;
+		}
+		return __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)
+			&& (ebx & bit_SHA)
+		;
+	#endif
+}
+
+const bool cpu_has_sha_ni = detect_sha_ni();
+
+#else
+
+const bool cpu_has_sha_ni = false;
+
+#endif
+
+} // namespace
+
+bool has_sha_ni () noexcept
+{
+	return cpu_has_sha_ni;
+}
+
+void sha1::compress (state_type &state, const std::byte *blocks, size_t count) noexcept
+{
+	#if __turner_hash_sha_ni
+		if (cpu_has_sha_ni)
+		{
+			sha1_ni(state, blocks, count);
+			return;
+		}
+	#endif
+	compress_generic(state, blocks, count);
+}
+
+void sha1::compress_sha_ni (state_type &state, const std::byte *blocks, size_t count) noexcept
+{
+	#if __turner_hash_sha_ni
+		sha1_ni(state, blocks, count);
+	#else
+		compress_generic(state, blocks, count);
+	#endif
+}
+
+void sha1::compress_generic (state_type &state, const std::byte *blocks, size_t count) noexcept
+{
+	using std::rotl;
+
+	for (/**/;  count;  --count, blocks += block_size_bytes)
+	{
+		uint32_t w[16];
+		for (auto i = 0u;  i < 16;  ++i)
+		{
+			w[i] = load_be(blocks + i * sizeof(uint32_t));
+		}
+
+		auto a = state[0], b = state[1], c = state[2], d = state[3], e = state[4];
+
+		auto round = [&](uint32_t i, uint32_t f, uint32_t k) noexcept
+		{
+			if (i >= 16)
+			{
+				w[i & 15] = rotl(w[(i + 13) & 15] ^ w[(i + 8) & 15] ^ w[(i + 2) & 15] ^ w[i & 15], 1);
+			}
+			auto t = rotl(a, 5) + f + e + k + w[i & 15];
+			e = d;
+			d = c;
+			c = rotl(b, 30);
+			b = a;
+			a = t;
+		};
+
+		for (auto i = 0u;  i < 20;  ++i)
+		{
+			round(i, (b & c) | (~b & d), 0x5a827999);
+		}
+		for (auto i = 20u;  i < 40;  ++i)
+		{
+			round(i, b ^ c ^ d, 0x6ed9eba1);
+		}
+		for (auto i = 40u;  i < 60;  ++i)
+		{
+			round(i, (b & c) | (b & d) | (c & d), 0x8f1bbcdc);
+		}
+		for (auto i = 60u;  i < 80;  ++i)
+		{
+			round(i, b ^ c ^ d, 0xca62c1d6);
+		}
+
+		state[0] += a;
+		state[1] += b;
+		state[2] += c;
+		state[3] += d;
+		state[4] += e;
+	}
+}
+
+void sha256::compress (state_type &state, const std::byte *blocks, size_t count) noexcept
+{
+	#if __turner_hash_sha_ni
+		if (cpu_has_sha_ni)
+		{
+			sha256_ni(state, blocks, count);
+			return;
+		}
+	#endif
+	compress_generic(state, blocks, count);
+}
+
+void sha256::compress_sha_ni (state_type &state, const std::byte *blocks, size_t count) noexcept
+{
+	#if __turner_hash_sha_ni
+		sha256_ni(state, blocks, count);
+	#else
+		compress_generic(state, blocks, count);
+	#endif
+}
+
+void sha256::compress_generic (state_type &state, const std::byte *blocks, size_t count) noexcept
+{
+	using std::rotr;
+
+	for (/**/;  count;  --count, blocks += block_size_bytes)
+	{
+		uint32_t w[16];
+		for (auto i = 0u;  i < 16;  ++i)
+		{
+			w[i] = load_be(blocks + i * sizeof(uint32_t));
+		}
+
+		auto a = state[0], b = state[1], c = state[2], d = state[3];
+		auto e = state[4], f = state[5], g = state[6], h = state[7];
+
+		for (auto i = 0u;  i < 64;  ++i)
+		{
+			if (i >= 16)
+			{
+				auto w15 = w[(i + 1) & 15], w2 = w[(i + 14) & 15];
+				auto s0 = rotr(w15, 7) ^ rotr(w15, 18) ^ (w15 >> 3);
+				auto s1 = rotr(w2, 17) ^ rotr(w2, 19) ^ (w2 >> 10);
+				w[i & 15] += s0 + w[(i + 9) & 15] + s1;
+			}
+
+			auto t1 = h
+				+ (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25))
+				+ ((e & f) ^ (~e & g))
+				+ sha256_k[i]
+				+ w[i & 15]
+			;
+			auto t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22))
+				+ ((a & b) ^ (a & c) ^ (b & c))
+			;
+
+			h = g;
+			g = f;
+			f = e;
+			e = d + t1;
+			d = c;
+			c = b;
+			b = a;
+			a = t1 + t2;
+		}
+
+		state[0] += a;
+		state[1] += b;
+		state[2] += c;
+		state[3] += d;
+		state[4] += e;
+		state[5] += f;
+		state[6] += g;
+		state[7] += h;
+	}
+}
+
+void md5::compress (state_type &state, const std::byte *blocks, size_t count) noexcept
+{
+	using std::rotl;
+
+	static constexpr uint32_t k[] =
+	{
+		0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
+		0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be, 0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
+		0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+		0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a,
+		0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c, 0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
+		0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+		0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
+		0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1, 0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391,
+	};
+
+	static constexpr int r[4][4] =
+	{
+		{ 7, 12, 17, 22 },
+		{ 5,  9, 14, 20 },
+		{ 4, 11, 16, 23 },
+		{ 6, 10, 15, 21 },
+	};
+
+	for (/**/;  count;  --count, blocks += block_size_bytes)
+	{
+		uint32_t w[16];
+		for (auto i = 0u;  i < 16;  ++i)
+		{
+			w[i] = load_le(blocks + i * sizeof(uint32_t));
+		}
+
+		auto a = state[0], b = state[1], c = state[2], d = state[3];
+		for (auto i = 0u;  i < 64;  ++i)
+		{
+			uint32_t f, g;
+			switch (i / 16)
+			{
+				case 0:
+					f = (b & c) | (~b & d);
+					g = i;
+					break;
+				case 1:
+					f = (d & b) | (~d & c);
+					g = (5 * i + 1) & 15;
+					break;
+				case 2:
+					f = b ^ c ^ d;
+					g = (3 * i + 5) & 15;
+					break;
+				default:
+					f = c ^ (b | ~d);
+					g = (7 * i) & 15;
+					break;
+			}
+
+			auto t = d;
+			d = c;
+			c = b;
+			b += rotl(a + f + k[i] + w[g], r[i / 16][i % 4]);
+			a = t;
+		}
+
+		state[0] += a;
+		state[1] += b;
+		state[2] += c;
+		state[3] += d;
+	}
+}
+
+keyed_random::keyed_random ()
+{
+	std::random_device device;
+	std::array<std::byte, sha256::digest_size_bytes> key;
+	for (auto i = 0u;  i < key.size();  i += sizeof(uint32_t))
+	{
+		store_be(key.data() + i, static_cast<uint32_t>(device()));
+	}
+	key_ = hmac_key<sha256>{key};
+}
+
+} // namespace turner::__hash
@@ -0,0 +1,166 @@
+#include <turner/__hash>
+#include <turner/test>
+#include <catch2/catch_template_test_macros.hpp>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace turner_test;
+namespace hash = turner::__hash;
+
+template <typename Digest>
+std::string to_hex (const Digest &digest)
+{
+	static constexpr char digits[] = "0123456789abcdef";
+	std::string result;
+	for (auto b: digest)
+	{
+		result += digits[static_cast<uint8_t>(b) >> 4];
+		result += digits[static_cast<uint8_t>(b) & 0xf];
+	}
+	return result;
+}
+
+template <typename Algorithm>
+struct test_vector;
+
+template <>
+struct test_vector<hash::md5>
+{
+	static constexpr std::string_view empty = "d41d8cd98f00b204e9800998ecf8427e";
+	static constexpr std::string_view abc = "900150983cd24fb0d6963f7d28e17f72";
+	static constexpr std::string_view two_blocks = "8215ef0796a20bcaaae116d3876c664a";
+	static constexpr std::string_view million_a = "7707d6ae4e027c70eea2a935c2296f21";
+	static constexpr std::string_view hmac = "80070713463e7749b90c2dc24911e275";
+};
+
+template <>
+struct test_vector<hash::sha1>
+{
+	static constexpr std::string_view empty = "da39a3ee5e6b4b0d3255bfef95601890afd80709";
+	static constexpr std::string_view abc = "a9993e364706816aba3e25717850c26c9cd0d89d";
+	static constexpr std::string_view two_blocks = "84983e441c3bd26ebaae4aa1f95129e5e54670f1";
+	static constexpr std::string_view million_a = "34aa973cd4c4daa4f61eeb2bdbad27316534016f";
+	static constexpr std::string_view hmac = "de7c9b85b8b78aa6bc8a7a36f70a90701c9db4d9";
+};
+
+template <>
+struct test_vector<hash::sha256>
+{
+	static constexpr std::string_view empty = "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855";
+	static constexpr std::string_view abc = "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad";
+	static constexpr std::string_view two_blocks = "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1";
+	static constexpr std::string_view million_a = "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0";
+	static constexpr std::string_view hmac = "f7bc83f430538424b13298e6aa6fb143ef4d59a14946175997479dbc2d1a3cd8";
+};
+
+TEMPLATE_TEST_CASE("__hash", "",
+	hash::md5,
+	hash::sha1,
+	hash::sha256)
+{
+	using Algorithm = TestType;
+	using expected = test_vector<Algorithm>;
+
+	SECTION("empty")
+	{
+		CHECK(to_hex(hash::digest<Algorithm>({})) == expected::empty);
+	}
+
+	SECTION("single block")
+	{
+		CHECK(to_hex(hash::digest<Algorithm>("abc"_b)) == expected::abc);
+	}
+
+	SECTION("two blocks")
+	{
+		auto data = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"_b;
+		CHECK(to_hex(hash::digest<Algorithm>(data)) == expected::two_blocks);
+	}
+
+	SECTION("incremental")
+	{
+		// odd sized updates to cover buffered and direct block paths
+		std::vector<std::byte> data(1001, std::byte{'a'});
+		hash::context<Algorithm> context;
+		for (auto i = 0;  i < 1000;  ++i)
+		{
+			context.update(std::span{data}.first(i % 2 ? 999 : 1001));
+		}
+		CHECK(to_hex(context.finish()) == expected::million_a);
+	}
+
+	SECTION("implementations match")
+	{
+		if constexpr (requires { Algorithm::compress_sha_ni; })
+		{
+			if (!hash::has_sha_ni())
+			{
+				return;
+			}
+
+			std::vector<std::byte> buffer(16 * Algorithm::block_size_bytes);
+			std::mt19937 random{};
+			for (auto &b: buffer)
+			{
+				b = static_cast<std::byte>(random());
+			}
+
+			for (auto blocks = 1u;  blocks <= 16;  ++blocks)
+			{
+				auto generic = Algorithm::initial_state, sha_ni = Algorithm::initial_state;
+				Algorithm::compress_generic(generic, buffer.data(), blocks);
+				Algorithm::compress_sha_ni(sha_ni, buffer.data(), blocks);
+				CAPTURE(blocks);
+				CHECK(generic == sha_ni);
+			}
+		}
+	}
+
+	SECTION("hmac")
+	{
+		hash::hmac_key<Algorithm> key{"key"_b};
+		auto context = key.inner();
+		context.update("The quick brown fox jumps over the lazy dog"_b);
+		CHECK(to_hex(key.finish(context)) == expected::hmac);
+	}
+}
+
+TEST_CASE("__hash::keyed_random")
+{
+	SECTION("same key") //{{{1
+	{
+		hash::keyed_random a{"key"_b}, b{"key"_b};
+		for (auto i = 0;  i < 100;  ++i)
+		{
+			CHECK(a.next() == b.next());
+		}
+	}
+
+	SECTION("different key") //{{{1
+	{
+		hash::keyed_random a{"key"_b}, b{"KEY"_b};
+		for (auto i = 0;  i < 100;  ++i)
+		{
+			CHECK(a.next() != b.next());
+		}
+	}
+
+	SECTION("random key") //{{{1
+	{
+		hash::keyed_random a, b;
+		std::set<uint64_t> values;
+		for (auto i = 0;  i < 1000;  ++i)
+		{
+			CHECK(values.insert(a.next()).second);
+			CHECK(values.insert(b.next()).second);
+		}
+	}
+
+	//}}}1
+}
+
+} // namespace
@@ -0,0 +1,102 @@
+#include <turner/__hash_table>
+#include <turner/test>
+#include <vector>
+
+namespace {
+
+namespace hash_table = turner::__hash_table;
+
+TEST_CASE("__hash_table")
+{
+	SECTION("tag_of") //{{{1
+	{
+		CHECK(hash_table::tag_of(0) == 1);
+		CHECK(hash_table::tag_of(0xffff'ffff'0000'0000) == 1);
+		CHECK(hash_table::tag_of(0x1234'5678'9abc'def0) == 0x9abc'def0);
+	}
+
+	SECTION("hash") //{{{1
+	{
+		std::array<uint64_t, 2> a{1, 2}, b{2, 1};
+		CHECK(hash_table::hash(a) == hash_table::hash(a));
+		CHECK(hash_table::hash(a) != hash_table::hash(b));
+		CHECK(hash_table::hash(a, 1) != hash_table::hash(a));
+	}
+
+	SECTION("free_list") //{{{1
+	{
+		hash_table::free_list list{3};
+		CHECK(list.pop() == 0);
+		CHECK(list.pop() == 1);
+		list.push(0);
+		CHECK(list.pop() == 0);
+		CHECK(list.pop() == 2);
+		CHECK(list.empty());
+	}
+
+	SECTION("index") //{{{1
+	{
+		// 8 entries: tags with same low bits share home entry
+		hash_table::index index{4};
+		auto insert = [&](uint32_t tag, uint32_t slot)
+		{
+			auto e = index.find(tag, [](uint32_t) { return true; });
+			REQUIRE(e->tag == 0);
+			e->tag = tag;
+			e->slot = slot;
+		};
+		auto find = [&](uint32_t tag, uint32_t slot)
+		{
+			return index.find(tag, [slot](uint32_t s) { return s == slot; })->tag != 0;
+		};
+
+		// colliding on home 7, wrapping around to 0 and 1
+		insert(7, 0);
+		insert(15, 1);
+		insert(23, 2);
+		insert(8, 3);
+		CHECK(index.home(7).slot == 0);
+		CHECK(find(7, 0));
+		CHECK(find(15, 1));
+		CHECK(find(23, 2));
+		CHECK(find(8, 3));
+		CHECK_FALSE(find(7, 1));
+		CHECK_FALSE(find(31, 0));
+
+		// backward shift keeps remaining reachable
+		index.erase(index.find_slot(7, 0));
+		CHECK_FALSE(find(7, 0));
+		CHECK(find(15, 1));
+		CHECK(find(23, 2));
+		CHECK(find(8, 3));
+		CHECK(index.home(7).slot == 1);
+
+		index.erase(index.find_slot(15, 1));
+		CHECK(find(23, 2));
+		CHECK(find(8, 3));
+
+		index.clear();
+		CHECK_FALSE(find(23, 2));
+		CHECK_FALSE(find(8, 3));
+	}
+
+	SECTION("prefetch_batch") //{{{1
+	{
+		hash_table::index index{4};
+		auto e = index.find(3, [](uint32_t) { return true; });
+		e->tag = 3;
+		e->slot = 5;
+
+		uint64_t hashes[] = {3, 4, 3};
+		std::vector<std::pair<size_t, uint32_t>> prefetched;
+		hash_table::prefetch_batch(hashes, 3,
+			[&](size_t) -> auto & { return index; },
+			[&](size_t i, uint32_t slot) { prefetched.emplace_back(i, slot); }
+		);
+		CHECK(prefetched == std::vector<std::pair<size_t, uint32_t>>{{0, 5}, {2, 5}});
+	}
+
+	//}}}1
+}
+
+} // namespace
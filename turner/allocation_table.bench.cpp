@@ -0,0 +1,129 @@
+#include <turner/allocation_table>
+#include <turner/bench>
+#include <algorithm>
+#include <array>
+#include <random>
+#include <vector>
+
+namespace {
+
+using turner::allocation_table;
+using turner::five_tuple;
+
+constexpr size_t allocation_count = 1'000'000;
+
+five_tuple make_key (uint32_t index)
+{
+	return {
+		.client = {
+			pal::net::ip::address_v4{{
+				static_cast<uint8_t>(index >> 24),
+				static_cast<uint8_t>(index >> 16),
+				static_cast<uint8_t>(index >> 8),
+				static_cast<uint8_t>(index),
+			}},
+			static_cast<uint16_t>(1024 + index % 60000),
+		},
+		.server = {pal::net::ip::address_v4{{192, 0, 2, 1}}, 3478},
+		.transport = turner::transport_protocol::udp,
+	};
+}
+
+// shared by benchmarks: populating 1M allocations takes a while
+struct fixture
+{
+	allocation_table table{allocation_count, 8};
+	std::vector<five_tuple> hits{}, misses{};
+
+	fixture ()
+	{
+		std::mt19937 rng{1};
+		for (auto i = 0u;  i < allocation_count;  ++i)
+		{
+			auto key = make_key(rng());
+			if (table.try_emplace(key).second)
+			{
+				hits.push_back(key);
+			}
+			misses.push_back(make_key(rng()));
+		}
+		std::shuffle(hits.begin(), hits.end(), rng);
+	}
+
+	static fixture &instance ()
+	{
+		static fixture f;
+		return f;
+	}
+};
+
+void find_hit (benchmark::State &state)
+{
+	auto &f = fixture::instance();
+	size_t i = 0;
+	for (auto _: state)
+	{
+		auto h = f.table.find(f.hits[i]);
+		benchmark::DoNotOptimize(f.table.get(h));
+		if (++i == f.hits.size())
+		{
+			i = 0;
+		}
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(find_hit);
+
+void find_hit_batch (benchmark::State &state)
+{
+	auto &f = fixture::instance();
+	std::array<allocation_table::handle, allocation_table::max_batch_size> result;
+	size_t i = 0;
+	for (auto _: state)
+	{
+		f.table.find(std::span{f.hits}.subspan(i, result.size()), result);
+		benchmark::DoNotOptimize(result);
+		i += result.size();
+		if (i + result.size() > f.hits.size())
+		{
+			i = 0;
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * result.size());
+}
+BENCHMARK(find_hit_batch);
+
+void find_miss (benchmark::State &state)
+{
+	auto &f = fixture::instance();
+	size_t i = 0;
+	for (auto _: state)
+	{
+		benchmark::DoNotOptimize(f.table.find(f.misses[i]));
+		if (++i == f.misses.size())
+		{
+			i = 0;
+		}
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(find_miss);
+
+void erase_emplace (benchmark::State &state)
+{
+	auto &f = fixture::instance();
+	size_t i = 0;
+	for (auto _: state)
+	{
+		f.table.erase(f.hits[i]);
+		benchmark::DoNotOptimize(f.table.try_emplace(f.hits[i]));
+		if (++i == f.hits.size())
+		{
+			i = 0;
+		}
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(erase_emplace);
+
+} // namespace
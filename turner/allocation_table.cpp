@@ -0,0 +1,190 @@
+#include <turner/allocation_table>
+#include <algorithm>
+#include <cstring>
+
+namespace turner {
+
+using __hash_table::tag_of;
+
+namespace {
+
+inline void store_address (std::byte *p, const pal::net::ip::address &address) noexcept
+{
+	if (address.is_v4())
+	{
+		std::memcpy(p, address.v4().to_bytes().data(), 4);
+	}
+	else
+	{
+		std::memcpy(p, address.v6().to_bytes().data(), 16);
+	}
+}
+
+} // namespace
+
+allocation_table::key_type::key_type (const five_tuple &key) noexcept
+{
+	// layout: client address (16B), server address (16B), client port,
+	// server port, transport, address families
+	auto p = reinterpret_cast<std::byte *>(words.data());
+	store_address(p, key.client.address);
+	store_address(p + 16, key.server.address);
+
+	uint8_t tail[6] =
+	{
+		static_cast<uint8_t>(key.client.port >> 8),
+		static_cast<uint8_t>(key.client.port),
+		static_cast<uint8_t>(key.server.port >> 8),
+		static_cast<uint8_t>(key.server.port),
+		static_cast<uint8_t>(key.transport),
+		static_cast<uint8_t>(key.client.address.is_v4() << 1 | key.server.address.is_v4()),
+	};
+	std::memcpy(p + 32, tail, sizeof(tail));
+}
+
+uint64_t allocation_table::hash (const key_type &key) noexcept
+{
+	return __hash_table::hash(key.words);
+}
+
+uint64_t allocation_table::hash (const five_tuple &key) noexcept
+{
+	return hash(key_type{key});
+}
+
+allocation_table::allocation_table (size_t capacity, size_t shard_count)
+	: shards_{new shard[(std::max)(shard_count, size_t{1})]}
+	, shard_count_{(std::max)(shard_count, size_t{1})}
+{
+	auto shard_capacity = static_cast<uint32_t>((std::max)((capacity + shard_count_ - 1) / shard_count_, size_t{1}));
+	for (auto s = shards_.get();  s != shards_.get() + shard_count_;  ++s)
+	{
+		s->nodes.reset(new node[shard_capacity]);
+		s->values.reset(new allocation[shard_capacity]);
+		s->index = __hash_table::index{shard_capacity};
+		s->free = __hash_table::free_list{shard_capacity};
+		s->capacity = shard_capacity;
+	}
+}
+
+size_t allocation_table::size () const noexcept
+{
+	size_t result = 0;
+	for (auto s = shards_.get();  s != shards_.get() + shard_count_;  ++s)
+	{
+		result += s->size;
+	}
+	return result;
+}
+
+std::pair<allocation_table::handle, bool> allocation_table::try_emplace (const five_tuple &key) noexcept
+{
+	key_type k{key};
+	auto h = hash(k);
+	auto shard_index = shard_of(h);
+	auto &s = shards_[shard_index];
+
+	auto tag = tag_of(h);
+	auto e = s.find(k, tag);
+	if (e->tag)
+	{
+		return {{static_cast<uint32_t>(shard_index), e->slot, s.nodes[e->slot].generation}, false};
+	}
+	else if (s.size == s.capacity)
+	{
+		return {{}, false};
+	}
+
+	auto node_index = s.free.pop();
+	auto &n = s.nodes[node_index];
+	s.size++;
+
+	n.key = k;
+	n.generation++;
+	auto &value = s.values[node_index];
+	value.five_tuple = key;
+	value.relayed = {};
+	value.expires = {};
+	value.peers.clear();
+
+	e->tag = tag;
+	e->slot = node_index;
+	return {{static_cast<uint32_t>(shard_index), node_index, n.generation}, true};
+}
+
+allocation_table::handle allocation_table::find (const five_tuple &key) const noexcept
+{
+	key_type k{key};
+	auto h = hash(k);
+	auto shard_index = shard_of(h);
+	auto &s = shards_[shard_index];
+	if (auto e = s.find(k, tag_of(h));  e->tag)
+	{
+		return {static_cast<uint32_t>(shard_index), e->slot, s.nodes[e->slot].generation};
+	}
+	return {};
+}
+
+void allocation_table::find (const std::span<const five_tuple> &keys, const std::span<handle> &result) const noexcept
+{
+	auto count = (std::min)(keys.size(), result.size());
+	for (size_t first = 0;  first < count;  first += max_batch_size)
+	{
+		auto batch_size = (std::min)(max_batch_size, count - first);
+
+		key_type k[max_batch_size];
+		uint64_t h[max_batch_size];
+		const shard *s[max_batch_size];
+
+		// 1) hash keys
+		for (auto i = 0u;  i < batch_size;  ++i)
+		{
+			k[i] = key_type{keys[first + i]};
+			h[i] = hash(k[i]);
+			s[i] = &shards_[shard_of(h[i])];
+		}
+
+		// 2) prefetch home index entries and their nodes
+		__hash_table::prefetch_batch(h, batch_size,
+			[&](size_t i) -> auto & { return s[i]->index; },
+			[&](size_t i, uint32_t node) { __hash_table::prefetch(&s[i]->nodes[node]); }
+		);
+
+		// 3) probe
+		for (auto i = 0u;  i < batch_size;  ++i)
+		{
+			if (auto e = s[i]->find(k[i], tag_of(h[i]));  e->tag)
+			{
+				result[first + i] = {
+					static_cast<uint32_t>(s[i] - shards_.get()),
+					e->slot,
+					s[i]->nodes[e->slot].generation
+				};
+			}
+			else
+			{
+				result[first + i] = {};
+			}
+		}
+	}
+}
+
+bool allocation_table::erase (handle h) noexcept
+{
+	if (!get(h))
+	{
+		return false;
+	}
+
+	auto &s = shards_[h.shard_];
+	auto &n = s.nodes[h.node_];
+
+	s.index.erase(s.index.find_slot(tag_of(hash(n.key)), h.node_));
+
+	n.generation++;
+	s.free.push(h.node_);
+	s.size--;
+	return true;
+}
+
+} // namespace turner
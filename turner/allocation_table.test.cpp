@@ -0,0 +1,213 @@
+#include <turner/allocation_table>
+#include <turner/test>
+#include <map>
+#include <random>
+#include <vector>
+
+namespace {
+
+using namespace turner_test;
+using turner::allocation_table;
+using turner::five_tuple;
+
+five_tuple make_key (uint32_t index)
+{
+	return {
+		.client = {
+			pal::net::ip::address_v4{{
+				10,
+				static_cast<uint8_t>(index >> 16),
+				static_cast<uint8_t>(index >> 8),
+				static_cast<uint8_t>(index),
+			}},
+			static_cast<uint16_t>(1024 + index % 1000),
+		},
+		.server = {pal::net::ip::address_v4{{192, 0, 2, 1}}, 3478},
+		.transport = turner::transport_protocol::udp,
+	};
+}
+
+TEST_CASE("allocation_table")
+{
+	auto shard_count = GENERATE(values<size_t>({1, 4}));
+	allocation_table table{64, shard_count};
+	CHECK(table.shard_count() == shard_count);
+	CHECK(table.size() == 0);
+
+	auto key = make_key(1);
+
+	SECTION("slot_size_bytes") //{{{1
+	{
+		// documented per-slot footprint, mostly peer_table inline storage
+		CHECK(allocation_table::slot_size_bytes() > sizeof(turner::allocation));
+		CHECK(sizeof(turner::allocation) > sizeof(turner::peer_table));
+		CHECK(allocation_table::slot_size_bytes() < 1024);
+	}
+
+	SECTION("try_emplace") //{{{1
+	{
+		auto [h, inserted] = table.try_emplace(key);
+		REQUIRE(h);
+		CHECK(inserted);
+		CHECK(table.size() == 1);
+		CHECK(table.size(table.shard_of(key)) == 1);
+
+		auto *a = table.get(h);
+		REQUIRE(a != nullptr);
+		CHECK(a->five_tuple.client == key.client);
+		CHECK(a->five_tuple.server == key.server);
+		CHECK(a->peers.permission_count() == 0);
+		CHECK(a->peers.channel_count() == 0);
+		a->relayed = {pal::net::ip::address_v4{{192, 0, 2, 1}}, 49152};
+
+		auto [h1, inserted1] = table.try_emplace(key);
+		CHECK(h1 == h);
+		CHECK_FALSE(inserted1);
+		CHECK(table.get(h1)->relayed.port == 49152);
+		CHECK(table.size() == 1);
+	}
+
+	SECTION("find") //{{{1
+	{
+		CHECK_FALSE(table.find(key));
+
+		auto [h, inserted] = table.try_emplace(key);
+		CHECK(table.find(key) == h);
+
+		// any 5-tuple component differs
+		auto other = key;
+		other.client.port++;
+		CHECK_FALSE(table.find(other));
+
+		other = key;
+		other.server.port++;
+		CHECK_FALSE(table.find(other));
+
+		other = key;
+		other.transport = turner::transport_protocol::tcp;
+		CHECK_FALSE(table.find(other));
+
+		other = key;
+		other.client.address = pal::net::ip::address_v6::loopback();
+		CHECK_FALSE(table.find(other));
+	}
+
+	SECTION("find batch") //{{{1
+	{
+		// more than max_batch_size keys, every 3rd inserted
+		std::vector<five_tuple> keys;
+		for (auto i = 0u;  i < allocation_table::max_batch_size + 10;  ++i)
+		{
+			keys.push_back(make_key(i));
+			if (i % 3 == 0)
+			{
+				table.try_emplace(keys.back());
+			}
+		}
+
+		std::vector<allocation_table::handle> result(keys.size());
+		table.find(keys, result);
+		for (auto i = 0u;  i < keys.size();  ++i)
+		{
+			CHECK(result[i] == table.find(keys[i]));
+			CHECK(bool(result[i]) == (i % 3 == 0));
+		}
+	}
+
+	SECTION("erase") //{{{1
+	{
+		auto [h, inserted] = table.try_emplace(key);
+		CHECK(table.erase(key));
+		CHECK(table.size() == 0);
+		CHECK_FALSE(table.find(key));
+		CHECK_FALSE(table.erase(key));
+		CHECK_FALSE(table.erase(h));
+
+		// stale handle, even if node is reused
+		CHECK(h);
+		CHECK(table.get(h) == nullptr);
+		auto [h1, inserted1] = table.try_emplace(key);
+		CHECK(inserted1);
+		CHECK(h1 != h);
+		CHECK(table.get(h) == nullptr);
+		CHECK(table.get(h1) != nullptr);
+	}
+
+	SECTION("null handle") //{{{1
+	{
+		allocation_table::handle h;
+		CHECK_FALSE(h);
+		CHECK(table.get(h) == nullptr);
+		CHECK_FALSE(table.erase(h));
+	}
+
+	SECTION("full") //{{{1
+	{
+		// fill all shards
+		for (auto i = 0u;  table.size() < table.shard_count() * table.shard_capacity();  ++i)
+		{
+			table.try_emplace(make_key(i));
+		}
+
+		auto [h, inserted] = table.try_emplace(make_key(100'000));
+		CHECK_FALSE(h);
+		CHECK_FALSE(inserted);
+
+		// after erase, there is room again
+		auto victim = make_key(0);
+		auto shard = table.shard_of(victim);
+		REQUIRE(table.erase(victim));
+		for (auto i = 100'000u;  /**/;  ++i)
+		{
+			if (table.shard_of(make_key(i)) == shard)
+			{
+				CHECK(table.try_emplace(make_key(i)).second);
+				break;
+			}
+		}
+	}
+
+	SECTION("random insert/erase") //{{{1
+	{
+		allocation_table big{4096, shard_count};
+		std::map<uint32_t, allocation_table::handle> expected;
+		std::mt19937 rng{static_cast<uint32_t>(shard_count)};
+		std::uniform_int_distribution<uint32_t> pick{0, 5000};
+
+		for (auto step = 0u;  step < 20'000;  ++step)
+		{
+			auto index = pick(rng);
+			if (auto it = expected.find(index);  it != expected.end())
+			{
+				REQUIRE(big.erase(make_key(index)));
+				REQUIRE(big.get(it->second) == nullptr);
+				expected.erase(it);
+			}
+			else if (auto [h, inserted] = big.try_emplace(make_key(index));  h)
+			{
+				REQUIRE(inserted);
+				expected.emplace(index, h);
+			}
+		}
+
+		REQUIRE(big.size() == expected.size());
+		for (auto i = 0u;  i <= 5000;  ++i)
+		{
+			auto it = expected.find(i);
+			auto h = big.find(make_key(i));
+			if (it == expected.end())
+			{
+				CHECK_FALSE(h);
+			}
+			else
+			{
+				CHECK(h == it->second);
+				CHECK(big.get(h)->five_tuple.client == make_key(i).client);
+			}
+		}
+	}
+
+	//}}}1
+}
+
+} // namespace
@@ -4,6 +4,8 @@
 #include <turner/turn>
 #include <turner/test>
 #include <catch2/catch_template_test_macros.hpp>
+#include <string>
+#include <vector>
 
 namespace {
 
@@ -216,6 +218,111 @@ TEMPLATE_TEST_CASE("attribute_type_list", "",
 		REQUIRE(count == 2);
 		REQUIRE(list[0] == 0);
 	}
+
+	SECTION("visit")
+	{
+		struct handler
+		{
+			std::vector<std::string> visited{};
+
+			void operator() (decltype(Protocol::realm), pal::result<std::string_view> value)
+			{
+				visited.emplace_back("realm=" + std::string{value.value()});
+			}
+
+			void operator() (decltype(Protocol::username), pal::result<std::string_view> value)
+			{
+				visited.emplace_back("username=" + std::string{value.value()});
+			}
+
+			void operator() (decltype(Protocol::nonce), pal::result<std::string_view>)
+			{
+				visited.emplace_back("nonce");
+			}
+		} h;
+
+		// message order, not list order
+		auto count = reader->visit(turner::attributes<Protocol::username, Protocol::nonce, Protocol::realm>, h);
+		CHECK(count == 0);
+		CHECK(h.visited == std::vector<std::string>{"realm=realm", "username=user"});
+	}
+
+	SECTION("visit: unknown comprehension required")
+	{
+		struct handler
+		{
+			size_t calls = 0;
+
+			void operator() (decltype(Protocol::realm), pal::result<std::string_view> value)
+			{
+				CHECK(value.value() == "realm");
+				calls++;
+			}
+		} h;
+
+		std::array<uint16_t, 2> list{};
+		auto count = reader->visit(turner::attributes<Protocol::realm>, h, std::span{list});
+		CHECK(h.calls == 1);
+		REQUIRE(count == 1);
+		CHECK(list[0] == Protocol::username);
+
+		// if not satisfied, we have buffer overflow
+		list[0] = 0;
+		count = reader->visit(turner::attributes<Protocol::realm>, h, std::span{list}.first(0));
+		CHECK(count == 1);
+		CHECK(list[0] == 0);
+	}
+
+	SECTION("visit: optional attribute")
+	{
+		std::string value;
+		auto count = reader->visit(turner::attributes<custom_attribute>, [&](auto, auto v)
+		{
+			value = v.value();
+		});
+		CHECK(count == 2);
+		CHECK(value == "test");
+	}
+
+	SECTION("indexed: read")
+	{
+		auto indexed = reader->indexed();
+		CHECK(indexed.indexed_size() == 3);
+
+		auto attributes = turner::attributes<Protocol::realm, Protocol::username>;
+		auto [realm, username] = indexed.read(attributes);
+		CHECK(realm.value() == "realm");
+		CHECK(username.value() == "user");
+		CHECK(indexed.read(custom_attribute).value() == "test");
+	}
+
+	SECTION("indexed: read missing")
+	{
+		auto indexed = reader->indexed();
+		auto attributes = turner::attributes<Protocol::realm, Protocol::nonce>;
+		auto [realm, nonce] = indexed.read(attributes);
+		CHECK(realm.value() == "realm");
+		CHECK(nonce.error_or(std::error_code{}) == turner::errc::attribute_not_found);
+	}
+
+	SECTION("indexed: not_read")
+	{
+		auto indexed = reader->indexed();
+		auto attributes = turner::attributes<Protocol::realm>;
+		std::array<uint16_t, 2> list;
+
+		auto count = indexed.not_read(std::span{list}, attributes.any());
+		REQUIRE(count == 2);
+		CHECK(list[0] == Protocol::username);
+		CHECK(list[1] == custom_attribute);
+
+		count = indexed.not_read(std::span{list}, attributes.any_comprehension_required());
+		REQUIRE(count == 1);
+		CHECK(list[0] == Protocol::username);
+
+		count = indexed.not_read(std::span{list}.first(0), attributes.any());
+		CHECK(count == 2);
+	}
 }
 
 } // namespace
@@ -0,0 +1,37 @@
+#include <turner/msturn>
+#include <turner/stun>
+#include <turner/turn>
+#include <turner/bench>
+#include <array>
+#include <chrono>
+
+// FYI: per-protocol attribute value types read benchmarks are in
+// turner/<protocol>.bench.cpp
+
+namespace {
+
+using namespace turner_bench;
+using turner::msturn;
+using turner::stun;
+using turner::turn;
+
+const pal::net::ip::address_v4 address_v4{{192, 0, 2, 1}};
+const auto address_v6 = pal::net::ip::address_v6::loopback();
+const std::array<std::byte, 20> digest{};
+const std::array<std::byte, 160> payload{};
+
+__turner_bench_capture(read_attribute<msturn::bandwidth>, uint32, 0x01020304U);
+__turner_bench_capture(read_attribute<turn::lifetime>, seconds, std::chrono::seconds{600});
+__turner_bench_capture(read_attribute<turn::requested_address_family>, address_family, turner::address_family::v4);
+__turner_bench_capture(read_attribute<turn::requested_transport>, transport_protocol, turner::transport_protocol::udp);
+__turner_bench_capture(read_attribute<stun::software>, string, "turner");
+__turner_bench_capture(read_attribute<stun::message_integrity>, bytes_fixed, digest);
+__turner_bench_capture(read_attribute<turn::data>, bytes, payload);
+__turner_bench_capture(read_attribute<stun::error_code>, error_code, {turner::protocol_errc::unauthorized, "Unauthorized"});
+__turner_bench_capture(read_attribute<stun::unknown_attributes>, attribute_list, {2, {0x0001, 0x0002}});
+__turner_bench_capture(read_attribute<stun::mapped_address>, endpoint_v4, {address_v4, 3478});
+__turner_bench_capture(read_attribute<stun::mapped_address>, endpoint_v6, {address_v6, 3478});
+__turner_bench_capture(read_attribute<stun::xor_mapped_address>, xor_endpoint_v4, {address_v4, 3478});
+__turner_bench_capture(read_attribute<stun::xor_mapped_address>, xor_endpoint_v6, {address_v6, 3478});
+
+} // namespace
@@ -0,0 +1,50 @@
+#include <turner/bandwidth_shaper>
+#include <turner/cycle_clock>
+#include <turner/bench>
+#include <array>
+
+namespace {
+
+using turner::bandwidth_shaper;
+using turner::cycle_clock;
+using turner::msturn;
+
+constexpr size_t batch_size = 32;
+
+// batch of 200B datagrams per iteration, clock read once per batch.
+// state.range(0): bandwidth (kbps)
+void admit (benchmark::State &state)
+{
+	cycle_clock clock;
+	bandwidth_shaper shaper{
+		static_cast<uint32_t>(state.range(0)),
+		msturn::service_quality::best_effort,
+		clock.ticks_per_second(),
+		clock.now()
+	};
+
+	std::array<size_t, batch_size> sizes;
+	sizes.fill(200);
+	std::array<bool, batch_size> forward;
+
+	for (auto _: state)
+	{
+		benchmark::DoNotOptimize(shaper.admit(clock.now(), sizes, forward));
+	}
+	state.SetItemsProcessed(state.iterations() * batch_size);
+	state.counters["forwarded"] = static_cast<double>(shaper.stats().forwarded) / static_cast<double>(state.iterations() * batch_size);
+}
+BENCHMARK(admit)->Arg(0)->Arg(2'000)->Arg(10'000'000);
+
+// state.range(0): use time stamp counter (if invariant)
+void cycle_clock_now (benchmark::State &state)
+{
+	cycle_clock clock{std::chrono::milliseconds{10}, state.range(0) != 0};
+	for (auto _: state)
+	{
+		benchmark::DoNotOptimize(clock.now());
+	}
+}
+BENCHMARK(cycle_clock_now)->ArgName("tsc")->Arg(0)->Arg(1);
+
+} // namespace
@@ -0,0 +1,106 @@
+#include <turner/bandwidth_shaper>
+#include <algorithm>
+#include <limits>
+
+namespace turner {
+
+bandwidth_shaper::bandwidth_shaper (
+		uint32_t bandwidth_kbps,
+		msturn::service_quality quality,
+		uint64_t ticks_per_second,
+		uint64_t now,
+		std::chrono::milliseconds burst) noexcept
+	: bandwidth_kbps_{0}
+	, quality_{quality}
+	, ticks_per_second_{(std::max)(ticks_per_second, uint64_t{1})}
+	, burst_ms_{static_cast<uint64_t>((std::max)(burst.count(), std::chrono::milliseconds::rep{1}))}
+	, last_refill_{now}
+{
+	set_bandwidth(bandwidth_kbps);
+	tokens_ = capacity_;
+}
+
+void bandwidth_shaper::set_bandwidth (uint32_t bandwidth_kbps) noexcept
+{
+	bandwidth_kbps_ = bandwidth_kbps;
+	rate_ = uint64_t{bandwidth_kbps} * 1000 / 8;
+
+	// depth: burst worth of bytes, but at least largest datagram. Limit it
+	// so that byte-ticks arithmetic in refill() can't overflow
+	auto depth_bytes = (std::max)(rate_ * burst_ms_ / 1000, uint64_t{max_datagram_size_bytes});
+	depth_bytes = (std::min)(depth_bytes, (std::numeric_limits<uint64_t>::max)() / 4 / ticks_per_second_);
+	capacity_ = depth_bytes * ticks_per_second_;
+	tokens_ = (std::min)(tokens_, capacity_);
+	max_refill_ticks_ = rate_ ? capacity_ / rate_ + 1 : 0;
+}
+
+void bandwidth_shaper::configure (const msturn::message_reader &request) noexcept
+{
+	if (auto bandwidth = request.read(msturn::bandwidth))
+	{
+		set_bandwidth(*bandwidth);
+	}
+	if (auto service_quality = request.read(msturn::ms_service_quality))
+	{
+		quality_ = service_quality->quality;
+	}
+}
+
+void bandwidth_shaper::refill (uint64_t now) noexcept
+{
+	// clock may be read on different cores: ignore going backwards
+	if (now > last_refill_)
+	{
+		// cap elapsed time: full bucket after long idle, and no overflow
+		auto elapsed = (std::min)(now - last_refill_, max_refill_ticks_);
+		tokens_ = (std::min)(tokens_ + elapsed * rate_, capacity_);
+		last_refill_ = now;
+	}
+}
+
+size_t bandwidth_shaper::admit (uint64_t now, const std::span<const size_t> &sizes, const std::span<bool> &forward, bool congested) noexcept
+{
+	auto count = (std::min)(sizes.size(), forward.size());
+	if (!rate_)
+	{
+		std::fill_n(forward.begin(), count, true);
+		for (auto i = 0u;  i < count;  ++i)
+		{
+			stats_.forwarded_bytes += sizes[i];
+		}
+		stats_.forwarded += count;
+		return count;
+	}
+
+	refill(now);
+
+	auto cost_per_byte = ticks_per_second_;
+	if (congested && quality_ == msturn::service_quality::best_effort)
+	{
+		cost_per_byte *= congestion_penalty;
+	}
+
+	size_t forwarded = 0;
+	for (auto i = 0u;  i < count;  ++i)
+	{
+		auto size_bytes = (std::min)(sizes[i], max_datagram_size_bytes);
+		auto cost = size_bytes * cost_per_byte;
+		if (tokens_ >= cost)
+		{
+			tokens_ -= cost;
+			forward[i] = true;
+			stats_.forwarded_bytes += sizes[i];
+			forwarded++;
+		}
+		else
+		{
+			forward[i] = false;
+			stats_.dropped_bytes += sizes[i];
+		}
+	}
+	stats_.forwarded += forwarded;
+	stats_.dropped += count - forwarded;
+	return forwarded;
+}
+
+} // namespace turner
@@ -0,0 +1,191 @@
+#include <turner/bandwidth_shaper>
+#include <turner/test>
+#include <array>
+#include <memory>
+#include <vector>
+
+namespace {
+
+using namespace std::chrono_literals;
+using turner::bandwidth_shaper;
+using turner::msturn;
+
+// 1 tick = 1 microsecond
+constexpr uint64_t ticks_per_second = 1'000'000;
+constexpr uint64_t ms = ticks_per_second / 1000;
+
+// 800 kbps = 100'000 B/s = 100 B/ms, 100ms burst = 10'000B (less than
+// minimum depth)
+constexpr uint32_t bandwidth_kbps = 800;
+
+// 80 Mbps = 10'000'000 B/s = 10'000 B/ms, 100ms burst = 1'000'000B
+constexpr uint32_t high_bandwidth_kbps = 80'000;
+
+// send \a count datagrams of \a size_bytes at \a now, returning number of
+// forwarded
+size_t send (bandwidth_shaper &shaper, uint64_t now, size_t count, size_t size_bytes, bool congested = false)
+{
+	std::vector<size_t> sizes(count, size_bytes);
+	std::unique_ptr<bool[]> forward{new bool[count]};
+	return shaper.admit(now, sizes, {forward.get(), count}, congested);
+}
+
+TEST_CASE("bandwidth_shaper")
+{
+	uint64_t now = 1000 * ms;
+
+	SECTION("properties") //{{{1
+	{
+		bandwidth_shaper shaper{bandwidth_kbps, msturn::service_quality::reliable, ticks_per_second, now};
+		CHECK(shaper.bandwidth() == bandwidth_kbps);
+		CHECK(shaper.quality() == msturn::service_quality::reliable);
+
+		shaper.set_bandwidth(high_bandwidth_kbps);
+		CHECK(shaper.bandwidth() == high_bandwidth_kbps);
+		shaper.set_quality(msturn::service_quality::best_effort);
+		CHECK(shaper.quality() == msturn::service_quality::best_effort);
+	}
+
+	SECTION("burst") //{{{1
+	{
+		bandwidth_shaper shaper{high_bandwidth_kbps, msturn::service_quality::reliable, ticks_per_second, now};
+
+		// full bucket: 100ms worth
+		CHECK(send(shaper, now, 1000, 1000) == 1000);
+		CHECK(send(shaper, now, 1, 1000) == 0);
+
+		// refilled 10ms worth
+		now += 10 * ms;
+		CHECK(send(shaper, now, 1000, 1000) == 100);
+
+		CHECK(shaper.stats().forwarded == 1100);
+		CHECK(shaper.stats().forwarded_bytes == 1100 * 1000);
+		CHECK(shaper.stats().dropped == 901);
+		CHECK(shaper.stats().dropped_bytes == 901 * 1000);
+	}
+
+	SECTION("minimum depth") //{{{1
+	{
+		// largest datagram passes with full bucket even if burst is smaller
+		bandwidth_shaper shaper{bandwidth_kbps, msturn::service_quality::reliable, ticks_per_second, now};
+		CHECK(send(shaper, now, 1, bandwidth_shaper::max_datagram_size_bytes) == 1);
+		CHECK(send(shaper, now, 1, 1) == 0);
+	}
+
+	SECTION("rate") //{{{1
+	{
+		bandwidth_shaper shaper{high_bandwidth_kbps, msturn::service_quality::reliable, ticks_per_second, now};
+		send(shaper, now, 1000, 1000);
+
+		// 1s of 2x overload in 1ms batches: half forwarded
+		size_t forwarded = 0;
+		for (auto i = 0;  i < 1000;  ++i)
+		{
+			now += ms;
+			forwarded += send(shaper, now, 20, 1000);
+		}
+		CHECK(forwarded == 10'000);
+	}
+
+	SECTION("idle refill is capped") //{{{1
+	{
+		bandwidth_shaper shaper{high_bandwidth_kbps, msturn::service_quality::reliable, ticks_per_second, now};
+		send(shaper, now, 1000, 1000);
+
+		now += 3600'000 * ms;
+		CHECK(send(shaper, now, 2000, 1000) == 1000);
+	}
+
+	SECTION("clock going backwards") //{{{1
+	{
+		bandwidth_shaper shaper{high_bandwidth_kbps, msturn::service_quality::reliable, ticks_per_second, now};
+		send(shaper, now, 1000, 1000);
+		CHECK(send(shaper, now - 10 * ms, 1, 1000) == 0);
+		CHECK(send(shaper, now + ms, 100, 1000) == 10);
+	}
+
+	SECTION("unlimited") //{{{1
+	{
+		bandwidth_shaper shaper{0, msturn::service_quality::best_effort, ticks_per_second, now};
+		CHECK(send(shaper, now, 100'000, 1500, true) == 100'000);
+		CHECK(shaper.stats().dropped == 0);
+		CHECK(shaper.stats().forwarded_bytes == 100'000 * 1500);
+	}
+
+	SECTION("congestion") //{{{1
+	{
+		bandwidth_shaper reliable{high_bandwidth_kbps, msturn::service_quality::reliable, ticks_per_second, now};
+		bandwidth_shaper best_effort{high_bandwidth_kbps, msturn::service_quality::best_effort, ticks_per_second, now};
+
+		// not congested: same
+		CHECK(send(reliable, now, 2000, 1000) == 1000);
+		CHECK(send(best_effort, now, 2000, 1000) == 1000);
+
+		// congested: best_effort gets half
+		now += 10 * ms;
+		CHECK(send(reliable, now, 2000, 1000, true) == 100);
+		CHECK(send(best_effort, now, 2000, 1000, true) == 50);
+	}
+
+	SECTION("batch order") //{{{1
+	{
+		bandwidth_shaper shaper{high_bandwidth_kbps, msturn::service_quality::reliable, ticks_per_second, now};
+		send(shaper, now, 1000, 1000);
+		now += ms;
+
+		// 10'000B: fits first two, third doesn't, fourth small does
+		std::array<size_t, 4> sizes{4000, 5000, 2000, 1000};
+		std::array<bool, 4> forward{};
+		CHECK(shaper.admit(now, sizes, forward) == 3);
+		CHECK(forward == std::array{true, true, false, true});
+
+		// single
+		CHECK_FALSE(shaper.admit(now, 1));
+		now += ms;
+		CHECK(shaper.admit(now, 1));
+	}
+
+	SECTION("set_bandwidth") //{{{1
+	{
+		bandwidth_shaper shaper{high_bandwidth_kbps, msturn::service_quality::reliable, ticks_per_second, now};
+
+		// tokens clipped to new depth
+		shaper.set_bandwidth(bandwidth_kbps);
+		CHECK(send(shaper, now, 100, 1000) == 65);
+		now += 10 * ms;
+		CHECK(send(shaper, now, 100, 1000) == 1);
+	}
+
+	SECTION("configure") //{{{1
+	{
+		bandwidth_shaper shaper{0, msturn::service_quality::best_effort, ticks_per_second, now};
+
+		std::array<std::byte, 128> buffer;
+		msturn::message_writer writer{buffer, msturn::allocate, {}};
+		writer
+			.write(msturn::bandwidth, bandwidth_kbps)
+			.write(msturn::ms_service_quality, {msturn::stream_type::audio, msturn::service_quality::reliable})
+		;
+		shaper.configure(msturn::read_message(writer.finish().value()).value());
+		CHECK(shaper.bandwidth() == bandwidth_kbps);
+		CHECK(shaper.quality() == msturn::service_quality::reliable);
+
+		// missing attributes: unchanged
+		msturn::message_writer empty{buffer, msturn::allocate, {}};
+		shaper.configure(msturn::read_message(empty.finish().value()).value());
+		CHECK(shaper.bandwidth() == bandwidth_kbps);
+		CHECK(shaper.quality() == msturn::service_quality::reliable);
+	}
+
+	SECTION("no overflow") //{{{1
+	{
+		// maximum bandwidth with GHz clock
+		bandwidth_shaper shaper{0xffff'ffff, msturn::service_quality::reliable, 5'000'000'000, now};
+		CHECK(send(shaper, now, 1000, 1500) == 1000);
+		CHECK(send(shaper, now + 1'000'000'000'000, 1000, 1500) == 1000);
+	}
+
+	//}}}1
+}
+
+} // namespace
@@ -0,0 +1,171 @@
+#include <turner/connection_table>
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+namespace turner {
+
+using __hash_table::tag_of;
+
+namespace {
+
+inline size_t slot_count (size_t capacity) noexcept
+{
+	// leave at least 8 random bits in CONNECTION-ID
+	return std::bit_ceil(std::clamp(capacity, size_t{1}, size_t{1} << 24));
+}
+
+} // namespace
+
+connection_table::connection_table (size_t capacity)
+	: slot_mask_{slot_count(capacity) - 1}
+	, slot_bits_{std::countr_zero(slot_mask_ + 1)}
+	, slots_{new slot[slot_mask_ + 1]{}}
+	, index_{slot_mask_ + 1}
+	, free_{slot_mask_ + 1}
+{ }
+
+uint64_t connection_table::hash (const five_tuple &allocation, const endpoint &peer) noexcept
+{
+	uint64_t words[3]{};
+	if (peer.address.is_v4())
+	{
+		std::memcpy(words, peer.address.v4().to_bytes().data(), 4);
+	}
+	else
+	{
+		std::memcpy(words, peer.address.v6().to_bytes().data(), 16);
+	}
+	words[2] = uint64_t{peer.port} << 1 | peer.address.is_v4();
+
+	return __hash_table::hash(words, allocation_table::hash(allocation));
+}
+
+__hash_table::entry *connection_table::find_entry (const five_tuple &allocation, const endpoint &peer, uint32_t tag) const noexcept
+{
+	return index_.find(tag, [&](uint32_t slot)
+	{
+		return slots_[slot].value.peer == peer
+			&& same_allocation(slots_[slot].value.allocation, allocation)
+		;
+	});
+}
+
+connection_table::slot *connection_table::slot_of (connection_id id) const noexcept
+{
+	auto &s = slots_[id & slot_mask_];
+	return s.used && s.value.id == id ? &s : nullptr;
+}
+
+pal::result<connection_table::connection *> connection_table::insert (const five_tuple &allocation, const endpoint &peer, time_point now) noexcept
+{
+	auto h = hash(allocation, peer);
+	auto e = find_entry(allocation, peer, tag_of(h));
+	if (e->tag)
+	{
+		return pal::unexpected{make_error_code(protocol_errc::connection_already_exists)};
+	}
+	else if (free_.empty())
+	{
+		return pal::unexpected{make_error_code(protocol_errc::insufficient_capacity)};
+	}
+
+	auto slot_index = free_.pop();
+	e->tag = tag_of(h);
+	e->slot = slot_index;
+	size_++;
+
+	// slot index + keyed PRF bits: issued IDs do not reveal others
+	auto random = static_cast<connection_id>(id_random_.next());
+
+	auto &s = slots_[slot_index];
+	s.value = {};
+	s.value.id = (random << slot_bits_) | slot_index;
+	s.value.allocation = allocation;
+	s.value.peer = peer;
+	s.value.expires = now + bind_timeout;
+	s.hash = h;
+	s.used = true;
+	return &s.value;
+}
+
+void connection_table::release (size_t slot_index) noexcept
+{
+	auto &s = slots_[slot_index];
+
+	index_.erase(index_.find_slot(tag_of(s.hash), static_cast<uint32_t>(slot_index)));
+
+	s.used = false;
+	free_.push(static_cast<uint32_t>(slot_index));
+	size_--;
+}
+
+pal::result<connection_table::connection_id> connection_table::connect (const five_tuple &allocation, const endpoint &peer, time_point now) noexcept
+{
+	return insert(allocation, peer, now).transform([](connection *c)
+	{
+		return c->id;
+	});
+}
+
+bool connection_table::connected (connection_id id, uintptr_t peer_connection, time_point now) noexcept
+{
+	if (auto s = slot_of(id);  s && s->value.state == connection_state::connecting)
+	{
+		s->value.peer_connection = peer_connection;
+		s->value.expires = now + bind_timeout;
+		s->value.state = connection_state::pending_bind;
+		return true;
+	}
+	return false;
+}
+
+pal::result<connection_table::connection_id> connection_table::accept (const five_tuple &allocation, const endpoint &peer, uintptr_t peer_connection, time_point now) noexcept
+{
+	return insert(allocation, peer, now).transform([=](connection *c)
+	{
+		c->peer_connection = peer_connection;
+		c->state = connection_state::pending_bind;
+		return c->id;
+	});
+}
+
+const connection_table::connection *connection_table::bind (connection_id id, uintptr_t data_connection, time_point now) noexcept
+{
+	if (auto s = slot_of(id);  s
+		&& s->value.state == connection_state::pending_bind
+		&& s->value.expires > now)
+	{
+		s->value.data_connection = data_connection;
+		s->value.state = connection_state::bound;
+		return &s->value;
+	}
+	return nullptr;
+}
+
+const connection_table::connection *connection_table::find (connection_id id) const noexcept
+{
+	auto s = slot_of(id);
+	return s ? &s->value : nullptr;
+}
+
+const connection_table::connection *connection_table::find (const five_tuple &allocation, const endpoint &peer) const noexcept
+{
+	if (auto e = find_entry(allocation, peer, tag_of(hash(allocation, peer)));  e->tag)
+	{
+		return &slots_[e->slot].value;
+	}
+	return nullptr;
+}
+
+bool connection_table::erase (connection_id id) noexcept
+{
+	if (slot_of(id))
+	{
+		release(id & slot_mask_);
+		return true;
+	}
+	return false;
+}
+
+} // namespace turner
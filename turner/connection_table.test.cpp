@@ -0,0 +1,254 @@
+#include <turner/connection_table>
+#include <turner/test>
+#include <map>
+#include <random>
+#include <vector>
+
+namespace {
+
+using namespace std::chrono_literals;
+using turner::connection_table;
+using turner::five_tuple;
+using turner::endpoint;
+using turner::protocol_errc;
+using state = connection_table::connection_state;
+
+five_tuple make_allocation (uint8_t index)
+{
+	return {
+		.client = {pal::net::ip::address_v4{{10, 0, 0, index}}, 50000},
+		.server = {pal::net::ip::address_v4{{192, 0, 2, 1}}, 3478},
+		.transport = turner::transport_protocol::tcp,
+	};
+}
+
+endpoint make_peer (uint16_t index)
+{
+	if (index % 2)
+	{
+		return {pal::net::ip::address_v4{{198, 51, 100, static_cast<uint8_t>(index)}}, static_cast<uint16_t>(8000 + index)};
+	}
+	return {
+		pal::net::ip::address_v6{{0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, static_cast<uint8_t>(index)}},
+		static_cast<uint16_t>(8000 + index),
+	};
+}
+
+TEST_CASE("connection_table")
+{
+	connection_table table{4};
+	CHECK(table.capacity() == 4);
+	CHECK(table.size() == 0);
+
+	connection_table::time_point now{};
+	auto allocation = make_allocation(1);
+	auto peer = make_peer(1);
+
+	SECTION("capacity") //{{{1
+	{
+		CHECK(connection_table{0}.capacity() == 1);
+		CHECK(connection_table{5}.capacity() == 8);
+		CHECK(connection_table{64}.capacity() == 64);
+	}
+
+	SECTION("connect") //{{{1
+	{
+		auto id = table.connect(allocation, peer, now);
+		REQUIRE(id);
+		CHECK(table.size() == 1);
+
+		auto c = table.find(*id);
+		REQUIRE(c);
+		CHECK(c->id == *id);
+		CHECK(c->allocation.client == allocation.client);
+		CHECK(c->peer == peer);
+		CHECK(c->state == state::connecting);
+		CHECK(c->expires == now + connection_table::bind_timeout);
+		CHECK(table.find(allocation, peer) == c);
+
+		// not connected yet
+		CHECK(table.bind(*id, 1, now) == nullptr);
+
+		now += 1s;
+		CHECK(table.connected(*id, 10, now));
+		CHECK(c->state == state::pending_bind);
+		CHECK(c->peer_connection == 10);
+		CHECK(c->expires == now + connection_table::bind_timeout);
+		CHECK_FALSE(table.connected(*id, 10, now));
+
+		auto bound = table.bind(*id, 20, now);
+		CHECK(bound == c);
+		CHECK(c->state == state::bound);
+		CHECK(c->data_connection == 20);
+
+		// second ConnectionBind
+		CHECK(table.bind(*id, 21, now) == nullptr);
+		CHECK(c->data_connection == 20);
+	}
+
+	SECTION("accept") //{{{1
+	{
+		auto id = table.accept(allocation, peer, 10, now);
+		REQUIRE(id);
+		auto c = table.find(*id);
+		REQUIRE(c);
+		CHECK(c->state == state::pending_bind);
+		CHECK(c->peer_connection == 10);
+		CHECK_FALSE(table.connected(*id, 11, now));
+
+		CHECK(table.bind(*id, 20, now) == c);
+		CHECK(c->state == state::bound);
+	}
+
+	SECTION("connection already exists") //{{{1
+	{
+		REQUIRE(table.connect(allocation, peer, now));
+
+		auto id = table.connect(allocation, peer, now);
+		REQUIRE_FALSE(id);
+		CHECK(id.error() == protocol_errc::connection_already_exists);
+
+		auto accepted = table.accept(allocation, peer, 10, now);
+		REQUIRE_FALSE(accepted);
+		CHECK(accepted.error() == protocol_errc::connection_already_exists);
+		CHECK(table.size() == 1);
+
+		// other peer, other allocation
+		CHECK(table.connect(allocation, make_peer(2), now));
+		CHECK(table.connect(make_allocation(2), peer, now));
+
+		// other transport
+		auto tcp = allocation;
+		tcp.transport = turner::transport_protocol::udp;
+		CHECK(table.connect(tcp, peer, now));
+		CHECK(table.size() == 4);
+	}
+
+	SECTION("insufficient capacity") //{{{1
+	{
+		for (auto i = 0u;  i < table.capacity();  ++i)
+		{
+			CHECK(table.connect(allocation, make_peer(i), now));
+		}
+
+		auto id = table.connect(allocation, make_peer(table.capacity()), now);
+		REQUIRE_FALSE(id);
+		CHECK(id.error() == protocol_errc::insufficient_capacity);
+
+		// after erase, slot is reused with different CONNECTION-ID
+		auto c = table.find(allocation, make_peer(0));
+		REQUIRE(c);
+		auto erased_id = c->id;
+		CHECK(table.erase(erased_id));
+		CHECK_FALSE(table.erase(erased_id));
+
+		auto reused = table.connect(allocation, make_peer(0), now);
+		REQUIRE(reused);
+		CHECK(*reused != erased_id);
+		CHECK(table.find(erased_id) == nullptr);
+	}
+
+	SECTION("unknown id") //{{{1
+	{
+		auto id = table.accept(allocation, peer, 10, now);
+		REQUIRE(id);
+		auto other = *id ^ 0x100;
+		CHECK(table.find(other) == nullptr);
+		CHECK(table.bind(other, 20, now) == nullptr);
+		CHECK_FALSE(table.connected(other, 10, now));
+		CHECK_FALSE(table.erase(other));
+		CHECK(table.find(allocation, make_peer(2)) == nullptr);
+	}
+
+	SECTION("expire") //{{{1
+	{
+		auto connecting = table.connect(allocation, make_peer(1), now).value();
+		auto pending = table.accept(allocation, make_peer(2), 10, now).value();
+		auto bound = table.accept(allocation, make_peer(3), 11, now).value();
+		REQUIRE(table.bind(bound, 20, now));
+
+		std::vector<connection_table::connection_id> expired;
+		auto f = [&](const connection_table::connection &c)
+		{
+			expired.push_back(c.id);
+		};
+
+		CHECK(table.expire(now + connection_table::bind_timeout - 1s, f) == 0);
+
+		// expired but not yet collected
+		now += connection_table::bind_timeout;
+		CHECK(table.bind(pending, 21, now) == nullptr);
+
+		CHECK(table.expire(now, f) == 2);
+		CHECK(table.size() == 1);
+		std::ranges::sort(expired);
+		std::vector expected{connecting, pending};
+		std::ranges::sort(expected);
+		CHECK(expired == expected);
+		CHECK(table.find(bound));
+		CHECK(table.find(connecting) == nullptr);
+		CHECK(table.find(allocation, make_peer(1)) == nullptr);
+	}
+
+	SECTION("erase allocation") //{{{1
+	{
+		auto other = make_allocation(2);
+		table.connect(allocation, make_peer(1), now).value();
+		table.accept(allocation, make_peer(2), 10, now).value();
+		auto kept = table.connect(other, make_peer(1), now).value();
+
+		size_t closed = 0;
+		CHECK(table.erase(allocation, [&](const connection_table::connection &c)
+		{
+			CHECK(c.allocation.client == allocation.client);
+			closed++;
+		}) == 2);
+		CHECK(closed == 2);
+		CHECK(table.size() == 1);
+		CHECK(table.find(kept));
+	}
+
+	//}}}1
+}
+
+TEST_CASE("connection_table/stress")
+{
+	// random connect/erase against reference map: exercises index backward
+	// shift deletion
+	connection_table table{256};
+	connection_table::time_point now{};
+	std::map<std::pair<uint8_t, uint16_t>, connection_table::connection_id> expected;
+	std::mt19937 rng{1};
+
+	for (auto i = 0u;  i < 100000;  ++i)
+	{
+		auto a = static_cast<uint8_t>(rng() % 8);
+		auto p = static_cast<uint16_t>(rng() % 32);
+		auto allocation = make_allocation(a);
+		auto peer = make_peer(p);
+		if (auto it = expected.find({a, p});  it != expected.end())
+		{
+			auto c = table.find(allocation, peer);
+			REQUIRE(c);
+			REQUIRE(c->id == it->second);
+			REQUIRE(table.erase(it->second));
+			expected.erase(it);
+		}
+		else
+		{
+			auto id = table.connect(allocation, peer, now);
+			REQUIRE(id);
+			expected.emplace(std::pair{a, p}, *id);
+		}
+		REQUIRE(table.size() == expected.size());
+	}
+
+	for (auto &[key, id]: expected)
+	{
+		auto c = table.find(make_allocation(key.first), make_peer(key.second));
+		REQUIRE(c);
+		CHECK(c->id == id);
+	}
+}
+
+} // namespace
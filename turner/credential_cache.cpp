@@ -0,0 +1,257 @@
+#include <turner/credential_cache>
+#include <turner/__hash>
+#include <bit>
+#include <cstring>
+
+namespace turner {
+
+namespace {
+
+inline std::span<const std::byte> as_bytes (std::string_view v) noexcept
+{
+	return std::as_bytes(std::span{v.data(), v.size()});
+}
+
+template <typename Algorithm>
+long_term_key make_key (std::string_view username, std::string_view realm, std::string_view password) noexcept
+{
+	auto key = __hash::context<Algorithm>{}
+		.update(as_bytes(username))
+		.update(as_bytes(":"))
+		.update(as_bytes(realm))
+		.update(as_bytes(":"))
+		.update(as_bytes(password))
+		.finish()
+	;
+	return {
+		.sha1 = message_integrity_key{key},
+		.sha256 = message_integrity_sha256_key{key},
+	};
+}
+
+uint64_t hash (std::string_view username, std::string_view realm, password_algorithm algorithm) noexcept
+{
+	// FNV-1a: names are short, collisions are resolved by full compare
+	uint64_t h = 0xcbf29ce484222325;
+	auto add = [&h](std::string_view v) noexcept
+	{
+		for (auto c: v)
+		{
+			h = (h ^ static_cast<uint8_t>(c)) * 0x100000001b3;
+		}
+		h = (h ^ ':') * 0x100000001b3;
+	};
+	add(username);
+	add(realm);
+	h = (h ^ static_cast<uint16_t>(algorithm)) * 0x100000001b3;
+
+	// 0 is reserved for empty slot
+	return h ? h : 1;
+}
+
+inline bool is_cacheable (std::string_view username, std::string_view realm) noexcept
+{
+	return username.size() + realm.size() <= credential_cache::max_names_size_bytes;
+}
+
+} // namespace
+
+long_term_key long_term_key::make (
+	password_algorithm algorithm,
+	std::string_view username,
+	std::string_view realm,
+	std::string_view password) noexcept
+{
+	if (algorithm == password_algorithm::sha256)
+	{
+		return make_key<__hash::sha256>(username, realm, password);
+	}
+	return make_key<__hash::md5>(username, realm, password);
+}
+
+credential_cache::credential_cache (size_t capacity)
+	: slots_{new slot[std::bit_ceil((std::max)(capacity, probe_window_size))]}
+	, mask_{std::bit_ceil((std::max)(capacity, probe_window_size)) - 1}
+{ }
+
+bool credential_cache::load (const slot &s, entry &e) noexcept
+{
+	uint64_t words[entry_words];
+	for (;;)
+	{
+		auto sequence = s.sequence.load(std::memory_order_acquire);
+		if (sequence & 1)
+		{
+			// writer in progress
+			continue;
+		}
+
+		for (auto i = 0u;  i < entry_words;  ++i)
+		{
+			words[i] = s.words[i].load(std::memory_order_relaxed);
+		}
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (s.sequence.load(std::memory_order_relaxed) == sequence)
+		{
+			break;
+		}
+	}
+	std::memcpy(&e, words, sizeof(e));
+	return e.hash != 0;
+}
+
+void credential_cache::store (slot &s, const entry &e) noexcept
+{
+	uint64_t words[entry_words]{};
+	std::memcpy(words, &e, sizeof(e));
+
+	auto sequence = s.sequence.load(std::memory_order_relaxed);
+	s.sequence.store(sequence + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	for (auto i = 0u;  i < entry_words;  ++i)
+	{
+		s.words[i].store(words[i], std::memory_order_relaxed);
+	}
+
+	s.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+namespace {
+
+template <typename Entry>
+bool matches (
+	const Entry &e,
+	uint64_t hash,
+	std::string_view username,
+	std::string_view realm,
+	password_algorithm algorithm) noexcept
+{
+	return e.hash == hash
+		&& e.algorithm == algorithm
+		&& e.username_size == username.size()
+		&& e.realm_size == realm.size()
+		&& std::memcmp(e.names, username.data(), username.size()) == 0
+		&& std::memcmp(e.names + username.size(), realm.data(), realm.size()) == 0
+	;
+}
+
+} // namespace
+
+std::optional<long_term_key> credential_cache::find (
+	std::string_view username,
+	std::string_view realm,
+	password_algorithm algorithm) const noexcept
+{
+	if (!is_cacheable(username, realm))
+	{
+		return std::nullopt;
+	}
+
+	auto h = hash(username, realm, algorithm);
+	auto first = window(h);
+	for (auto s = first;  s != first + probe_window_size;  ++s)
+	{
+		// cheap pre-check: 1st word is hash
+		if (s->words[0].load(std::memory_order_relaxed) != h)
+		{
+			continue;
+		}
+
+		entry e;
+		if (load(*s, e) && matches(e, h, username, realm, algorithm))
+		{
+			// avoid dirtying shared cache line if already set
+			if (!s->referenced.load(std::memory_order_relaxed))
+			{
+				s->referenced.store(true, std::memory_order_relaxed);
+			}
+			return e.key;
+		}
+	}
+
+	return std::nullopt;
+}
+
+long_term_key credential_cache::insert (
+	std::string_view username,
+	std::string_view realm,
+	std::string_view password,
+	password_algorithm algorithm) noexcept
+{
+	auto key = long_term_key::make(algorithm, username, realm, password);
+	if (!is_cacheable(username, realm))
+	{
+		return key;
+	}
+
+	entry e;
+	e.hash = hash(username, realm, algorithm);
+	e.username_size = static_cast<uint16_t>(username.size());
+	e.realm_size = static_cast<uint16_t>(realm.size());
+	e.algorithm = algorithm;
+	std::memcpy(e.names, username.data(), username.size());
+	std::memcpy(e.names + username.size(), realm.data(), realm.size());
+	e.key = key;
+
+	std::lock_guard lock{insert_mutex_};
+
+	// existing or empty slot
+	auto first = window(e.hash);
+	slot *victim = nullptr;
+	for (auto s = first;  s != first + probe_window_size;  ++s)
+	{
+		entry current;
+		if (!load(*s, current))
+		{
+			victim = victim ? victim : s;
+		}
+		else if (matches(current, e.hash, username, realm, algorithm))
+		{
+			victim = s;
+			break;
+		}
+	}
+
+	// CLOCK: give referenced slots second chance
+	for (auto i = 0u;  !victim;  ++i)
+	{
+		auto s = first + (clock_hand_ + i) % probe_window_size;
+		if (!s->referenced.exchange(false, std::memory_order_relaxed))
+		{
+			victim = s;
+			clock_hand_ += i + 1;
+		}
+	}
+
+	victim->referenced.store(false, std::memory_order_relaxed);
+	store(*victim, e);
+	return key;
+}
+
+void credential_cache::erase (
+	std::string_view username,
+	std::string_view realm,
+	password_algorithm algorithm) noexcept
+{
+	if (!is_cacheable(username, realm))
+	{
+		return;
+	}
+
+	auto h = hash(username, realm, algorithm);
+	std::lock_guard lock{insert_mutex_};
+
+	auto first = window(h);
+	for (auto s = first;  s != first + probe_window_size;  ++s)
+	{
+		entry current;
+		if (load(*s, current) && matches(current, h, username, realm, algorithm))
+		{
+			store(*s, entry{});
+		}
+	}
+}
+
+} // namespace turner
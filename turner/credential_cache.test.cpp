@@ -0,0 +1,260 @@
+#include <turner/credential_cache>
+#include <turner/test>
+#include <array>
+#include <string>
+#include <thread>
+
+namespace {
+
+using namespace turner_test;
+using turner::password_algorithm;
+
+// https://datatracker.ietf.org/doc/html/rfc5769#section-2.4
+constexpr std::string_view username = "マトリックス";
+constexpr std::string_view realm = "example.org";
+constexpr std::string_view password = "TheMatrIX";
+
+// MD5(username ":" realm ":" password)
+constexpr uint8_t md5_key[] =
+{
+	0xe8, 0xca, 0x7a, 0xd5,
+	0x9d, 0x5e, 0xb0, 0x51,
+	0x8e, 0x31, 0x29, 0x11,
+	0xd2, 0xda, 0xb2, 0xa9,
+};
+
+// SHA256(username ":" realm ":" password)
+constexpr uint8_t sha256_key[] =
+{
+	0xdd, 0x29, 0x5a, 0x61,
+	0x3b, 0x90, 0x58, 0xc3,
+	0xc2, 0x3d, 0x6d, 0xc7,
+	0x16, 0x5b, 0xda, 0x07,
+	0x23, 0x04, 0xd9, 0x89,
+	0xc9, 0xd0, 0xaf, 0x3a,
+	0x8c, 0x7e, 0x18, 0x4b,
+	0x4f, 0x9b, 0xb4, 0xa1,
+};
+
+// sign empty message with both keys
+auto sign (const turner::long_term_key &key)
+{
+	static constexpr std::array<std::byte, 20> message{};
+	return std::pair{key.sha1.digest(message, 0), key.sha256.digest(message, 0)};
+}
+
+auto sign (const std::span<const uint8_t> &raw_key)
+{
+	auto bytes = std::as_bytes(raw_key);
+	return sign({
+		.sha1 = turner::message_integrity_key{bytes},
+		.sha256 = turner::message_integrity_sha256_key{bytes},
+	});
+}
+
+std::string user (size_t index)
+{
+	return "user" + std::to_string(index);
+}
+
+TEST_CASE("credential_cache")
+{
+	SECTION("long_term_key")
+	{
+		SECTION("md5")
+		{
+			auto key = turner::long_term_key::make(password_algorithm::md5, username, realm, password);
+			CHECK(sign(key) == sign(md5_key));
+		}
+
+		SECTION("sha256")
+		{
+			auto key = turner::long_term_key::make(password_algorithm::sha256, username, realm, password);
+			CHECK(sign(key) == sign(sha256_key));
+		}
+	}
+
+	turner::credential_cache cache{16};
+	CHECK(cache.capacity() == 16);
+
+	SECTION("capacity")
+	{
+		CHECK(turner::credential_cache{1}.capacity() == turner::credential_cache::probe_window_size);
+		CHECK(turner::credential_cache{17}.capacity() == 32);
+	}
+
+	SECTION("find empty")
+	{
+		CHECK_FALSE(cache.find(username, realm));
+	}
+
+	SECTION("insert")
+	{
+		auto inserted = cache.insert(username, realm, password);
+		CHECK(sign(inserted) == sign(md5_key));
+
+		auto found = cache.find(username, realm);
+		REQUIRE(found);
+		CHECK(sign(*found) == sign(md5_key));
+
+		CHECK_FALSE(cache.find(username, realm, password_algorithm::sha256));
+		CHECK_FALSE(cache.find(username, "example.com"));
+		CHECK_FALSE(cache.find("user", realm));
+	}
+
+	SECTION("insert both algorithms")
+	{
+		cache.insert(username, realm, password, password_algorithm::md5);
+		cache.insert(username, realm, password, password_algorithm::sha256);
+
+		auto md5 = cache.find(username, realm, password_algorithm::md5);
+		REQUIRE(md5);
+		CHECK(sign(*md5) == sign(md5_key));
+
+		auto sha256 = cache.find(username, realm, password_algorithm::sha256);
+		REQUIRE(sha256);
+		CHECK(sign(*sha256) == sign(sha256_key));
+	}
+
+	SECTION("insert existing")
+	{
+		cache.insert(username, realm, "password");
+		cache.insert(username, realm, password);
+
+		auto found = cache.find(username, realm);
+		REQUIRE(found);
+		CHECK(sign(*found) == sign(md5_key));
+
+		// no duplicate entries left behind
+		cache.erase(username, realm);
+		CHECK_FALSE(cache.find(username, realm));
+	}
+
+	SECTION("erase")
+	{
+		cache.insert(username, realm, password);
+		cache.erase(username, realm);
+		CHECK_FALSE(cache.find(username, realm));
+
+		// erasing missing is no-op
+		cache.erase(username, realm);
+		CHECK_FALSE(cache.find(username, realm));
+	}
+
+	SECTION("not cacheable")
+	{
+		std::string long_username(turner::credential_cache::max_names_size_bytes, 'x');
+		auto inserted = cache.insert(long_username, realm, password);
+		CHECK(sign(inserted) == sign(turner::long_term_key::make(password_algorithm::md5, long_username, realm, password)));
+		CHECK_FALSE(cache.find(long_username, realm));
+		cache.erase(long_username, realm);
+	}
+
+	SECTION("find_or_insert")
+	{
+		auto calls = 0;
+		auto get_password = [&calls](std::string_view, std::string_view r) -> std::optional<std::string_view>
+		{
+			calls++;
+			if (r == realm)
+			{
+				return password;
+			}
+			return std::nullopt;
+		};
+
+		auto key = cache.find_or_insert(username, realm, get_password);
+		REQUIRE(key);
+		CHECK(sign(*key) == sign(md5_key));
+		CHECK(calls == 1);
+
+		key = cache.find_or_insert(username, realm, get_password);
+		REQUIRE(key);
+		CHECK(sign(*key) == sign(md5_key));
+		CHECK(calls == 1);
+
+		CHECK_FALSE(cache.find_or_insert(username, "example.com", get_password));
+		CHECK(calls == 2);
+	}
+
+	SECTION("clock eviction")
+	{
+		// single window: all entries compete for same slots
+		turner::credential_cache small{turner::credential_cache::probe_window_size};
+		constexpr auto size = turner::credential_cache::probe_window_size;
+
+		for (auto i = 0u;  i < size;  ++i)
+		{
+			small.insert(user(i), realm, password);
+		}
+		for (auto i = 0u;  i < size;  ++i)
+		{
+			CHECK(small.find(user(i), realm));
+		}
+
+		// all referenced: 1st sweep clears, evicts slot under hand
+		small.insert(user(size), realm, password);
+		CHECK_FALSE(small.find(user(0), realm));
+		CHECK(small.find(user(size), realm));
+
+		// touch all but user(2): it is evicted next
+		for (auto i = 1u;  i <= size;  ++i)
+		{
+			if (i != 2)
+			{
+				CHECK(small.find(user(i), realm));
+			}
+		}
+		small.insert(user(size + 1), realm, password);
+		CHECK_FALSE(small.find(user(2), realm));
+		for (auto i = 1u;  i <= size + 1;  ++i)
+		{
+			if (i != 2)
+			{
+				CHECK(small.find(user(i), realm));
+			}
+		}
+	}
+
+	SECTION("concurrent find and insert")
+	{
+		constexpr auto users = 64u;
+		std::atomic<bool> done{false};
+		std::atomic<size_t> mismatches{0};
+
+		auto reader = [&]
+		{
+			while (!done)
+			{
+				for (auto i = 0u;  i < users;  ++i)
+				{
+					auto name = user(i);
+					if (auto key = cache.find(name, realm))
+					{
+						if (sign(*key) != sign(turner::long_term_key::make(password_algorithm::md5, name, realm, name)))
+						{
+							mismatches++;
+						}
+					}
+				}
+			}
+		};
+
+		std::thread r1{reader}, r2{reader};
+		for (auto round = 0;  round < 20;  ++round)
+		{
+			for (auto i = 0u;  i < users;  ++i)
+			{
+				auto name = user(i);
+				cache.insert(name, realm, name);
+			}
+		}
+		done = true;
+		r1.join();
+		r2.join();
+
+		CHECK(mismatches == 0);
+	}
+}
+
+} // namespace
@@ -0,0 +1,66 @@
+#include <turner/cycle_clock>
+#include <thread>
+
+#if __turner_cycle_clock_tsc && !defined(_MSC_VER)
+	#include <cpuid.h>
+#endif
+
+namespace turner {
+
+namespace {
+
+uint64_t measure_ticks_per_second (const cycle_clock &clock, std::chrono::milliseconds calibration)
+{
+	if (!clock.uses_tsc())
+	{
+		return 1'000'000'000;
+	}
+
+	using std::chrono::steady_clock;
+
+	auto start_time = steady_clock::now();
+	auto start_tick = clock.now();
+	std::this_thread::sleep_for(calibration);
+	auto end_time = steady_clock::now();
+	auto end_tick = clock.now();
+
+	auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time).count();
+	if (elapsed <= 0 || end_tick <= start_tick)
+	{
+		return 1'000'000'000;
+	}
+	return static_cast<uint64_t>(static_cast<double>(end_tick - start_tick) * 1e9 / static_cast<double>(elapsed));
+}
+
+} // namespace
+
+bool cycle_clock::has_invariant_tsc () noexcept
+{
+	// CPUID.80000007H:EDX[8]
+	constexpr unsigned leaf = 0x8000'0007, invariant_tsc = 1u << 8;
+
+	#if __turner_cycle_clock_tsc && defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 0x8000'0000);
+		if (static_cast<unsigned>(info[0]) < leaf)
+		{
+			return false;
+		}
+		__cpuid(info, leaf);
+		return (static_cast<unsigned>(info[3]) & invariant_tsc) != 0;
+	#elif __turner_cycle_clock_tsc
+		unsigned eax, ebx, ecx, edx;
+		return __get_cpuid(leaf, &eax, &ebx, &ecx, &edx) && (edx & invariant_tsc) != 0;
+	#else
+		(void)leaf;
+		(void)invariant_tsc;
+		return false;
+	#endif
+}
+
+cycle_clock::cycle_clock (std::chrono::milliseconds calibration, bool use_tsc)
+	: uses_tsc_{use_tsc && has_invariant_tsc()}
+	, ticks_per_second_{measure_ticks_per_second(*this, calibration)}
+{ }
+
+} // namespace turner
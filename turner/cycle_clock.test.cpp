@@ -0,0 +1,59 @@
+#include <turner/cycle_clock>
+#include <turner/test>
+#include <thread>
+
+namespace {
+
+using namespace std::chrono_literals;
+using turner::cycle_clock;
+
+TEST_CASE("cycle_clock")
+{
+	cycle_clock clock{5ms};
+
+	SECTION("monotonic") //{{{1
+	{
+		auto previous = clock.now();
+		for (auto i = 0;  i < 1000;  ++i)
+		{
+			auto now = clock.now();
+			CHECK(now >= previous);
+			previous = now;
+		}
+	}
+
+	SECTION("ticks_per_second") //{{{1
+	{
+		// at least 100MHz, no more than 100GHz
+		CHECK(clock.ticks_per_second() >= 100'000'000);
+		CHECK(clock.ticks_per_second() <= 100'000'000'000);
+
+		auto start = clock.now();
+		std::this_thread::sleep_for(20ms);
+		auto elapsed = static_cast<double>(clock.now() - start) / static_cast<double>(clock.ticks_per_second());
+		CHECK(elapsed >= 0.019);
+		CHECK(elapsed < 1.0);
+	}
+
+	SECTION("invariant TSC") //{{{1
+	{
+		CHECK(clock.uses_tsc() == cycle_clock::has_invariant_tsc());
+	}
+
+	SECTION("steady_clock fallback") //{{{1
+	{
+		cycle_clock fallback{5ms, false};
+		CHECK_FALSE(fallback.uses_tsc());
+		CHECK(fallback.ticks_per_second() == 1'000'000'000);
+
+		auto before = std::chrono::steady_clock::now().time_since_epoch() / 1ns;
+		auto now = fallback.now();
+		auto after = std::chrono::steady_clock::now().time_since_epoch() / 1ns;
+		CHECK(now >= static_cast<uint64_t>(before));
+		CHECK(now <= static_cast<uint64_t>(after));
+	}
+
+	//}}}1
+}
+
+} // namespace
@@ -0,0 +1,173 @@
+#include <turner/demux>
+#include <turner/test>
+
+
+namespace {
+
+using namespace turner_test;
+using turner::msturn;
+using turner::stun;
+using turner::turn;
+
+constexpr stun::transaction_id_type stun_transaction_id
+{
+	0x00, 0x01, 0x02, 0x03,
+	0x04, 0x05, 0x06, 0x07,
+	0x08, 0x09, 0x0a, 0x0b,
+};
+
+constexpr msturn::transaction_id_type msturn_transaction_id
+{
+	0x00, 0x01, 0x02, 0x03,
+	0x04, 0x05, 0x06, 0x07,
+	0x08, 0x09, 0x0a, 0x0b,
+	0x0c, 0x0d, 0x0e, 0x0f,
+};
+
+TEST_CASE("demux")
+{
+	std::array<std::byte, 128> buffer{};
+
+	SECTION("stun") //{{{1
+	{
+		stun::message_writer writer{std::span{buffer}, stun::binding, stun_transaction_id};
+		writer.write(stun::software, "test");
+		writer.add_fingerprint();
+		auto span = *writer.finish();
+
+		auto packet = turner::demux(span);
+		REQUIRE(packet);
+		auto reader = std::get_if<turn::message_reader>(&*packet);
+		REQUIRE(reader != nullptr);
+		CHECK(reader->expect(stun::binding));
+		CHECK(reader->as_bytes().data() == span.data());
+		CHECK(reader->read(stun::software).value() == "test");
+
+		SECTION("fingerprint mismatch")
+		{
+			buffer[span.size_bytes() - 1] ^= std::byte{1};
+			packet = turner::demux(span);
+			REQUIRE(!packet);
+			CHECK(packet.error() == turner::errc::fingerprint_mismatch);
+		}
+
+		SECTION("invalid magic cookie")
+		{
+			buffer[stun::cookie_offset] ^= std::byte{1};
+			packet = turner::demux(span);
+			REQUIRE(!packet);
+			CHECK(packet.error() == turner::errc::invalid_magic_cookie);
+		}
+
+		SECTION("unexpected message length")
+		{
+			packet = turner::demux(span.first(span.size_bytes() - 4));
+			REQUIRE(!packet);
+			CHECK(packet.error() == turner::errc::unexpected_message_length);
+
+			packet = turner::demux(span.first(stun::header_size_bytes - 4));
+			REQUIRE(!packet);
+			CHECK(packet.error() == turner::errc::unexpected_message_length);
+
+			packet = turner::demux(span.first(span.size_bytes() - 1));
+			REQUIRE(!packet);
+			CHECK(packet.error() == turner::errc::unexpected_message_length);
+		}
+	}
+
+	SECTION("msturn") //{{{1
+	{
+		msturn::message_writer writer{std::span{buffer}, msturn::allocate, msturn_transaction_id};
+		writer.write(msturn::username, "test");
+		auto span = *writer.finish();
+
+		auto packet = turner::demux(span);
+		REQUIRE(packet);
+		auto reader = std::get_if<msturn::message_reader>(&*packet);
+		REQUIRE(reader != nullptr);
+		CHECK(reader->expect(msturn::allocate));
+		CHECK(reader->as_bytes().data() == span.data());
+		CHECK(reader->read(msturn::username).value() == "test");
+
+		SECTION("invalid magic cookie")
+		{
+			buffer[msturn::cookie_offset] ^= std::byte{1};
+			packet = turner::demux(span);
+			REQUIRE(!packet);
+			CHECK(packet.error() == turner::errc::invalid_magic_cookie);
+		}
+
+		SECTION("unexpected attribute length")
+		{
+			// username attribute length past message end
+			buffer[msturn::cookie_offset + msturn::magic_cookie.size() + 3] = std::byte{0xff};
+			packet = turner::demux(span);
+			REQUIRE(!packet);
+			CHECK(packet.error() == turner::errc::unexpected_attribute_length);
+		}
+	}
+
+	SECTION("channel_data") //{{{1
+	{
+		constexpr uint8_t data[] =
+		{
+			0x40, 0x01, 0x00, 0x04, // channel 0x4001, length 4
+			'T',  'e',  's',  't',
+		};
+		auto packet = turner::demux(std::as_bytes(std::span{data}));
+		REQUIRE(packet);
+		auto reader = std::get_if<turn::channel_data_reader>(&*packet);
+		REQUIRE(reader != nullptr);
+		CHECK(reader->channel_number() == 0x4001);
+		CHECK(reader->data().size_bytes() == 4);
+
+		packet = turner::demux(std::as_bytes(std::span{data}).first(6));
+		REQUIRE(!packet);
+		CHECK(packet.error() == turner::errc::unexpected_message_length);
+	}
+
+	SECTION("passthrough") //{{{1
+	{
+		auto first_byte = GENERATE(range(16, 64), range(128, 192));
+		buffer[0] = static_cast<std::byte>(first_byte);
+		auto span = std::span{buffer}.first(24);
+
+		auto packet = turner::demux(span);
+		REQUIRE(packet);
+		if (first_byte < 20)
+		{
+			REQUIRE(std::holds_alternative<turner::zrtp_packet>(*packet));
+			CHECK(std::get<turner::zrtp_packet>(*packet).data.data() == span.data());
+		}
+		else if (first_byte < 64)
+		{
+			REQUIRE(std::holds_alternative<turner::dtls_packet>(*packet));
+			CHECK(std::get<turner::dtls_packet>(*packet).data.data() == span.data());
+		}
+		else
+		{
+			REQUIRE(std::holds_alternative<turner::rtp_packet>(*packet));
+			CHECK(std::get<turner::rtp_packet>(*packet).data.data() == span.data());
+		}
+	}
+
+	SECTION("unexpected message type") //{{{1
+	{
+		auto first_byte = GENERATE(range(4, 16), range(192, 256));
+		buffer[0] = static_cast<std::byte>(first_byte);
+		auto packet = turner::demux(std::span{buffer}.first(24));
+		REQUIRE(!packet);
+		CHECK(packet.error() == turner::errc::unexpected_message_type);
+	}
+
+	SECTION("empty") //{{{1
+	{
+		auto packet = turner::demux(std::span{buffer}.first(0));
+		REQUIRE(!packet);
+		CHECK(packet.error() == turner::errc::unexpected_message_length);
+	}
+
+	//}}}1
+}
+
+} // namespace
@@ -6,22 +6,58 @@ configure_file(
 list(APPEND turner_sources ${CMAKE_CURRENT_BINARY_DIR}/version.cpp)
 
 list(APPEND turner_sources
+	turner/__crc32
+	turner/__crc32.cpp
+	turner/__hash
+	turner/__hash.cpp
+	turner/__hash_table
 	turner/__view
+	turner/allocation_table
+	turner/allocation_table.cpp
 	turner/attribute_type
 	turner/attribute_type_list
 	turner/attribute_value_type
 	turner/attribute_value_type.cpp
+	turner/bandwidth_shaper
+	turner/bandwidth_shaper.cpp
+	turner/connection_table
+	turner/connection_table.cpp
+	turner/credential_cache
+	turner/credential_cache.cpp
+	turner/cycle_clock
+	turner/cycle_clock.cpp
+	turner/demux
 	turner/error
 	turner/error.cpp
 	turner/fwd
+	turner/message_integrity
 	turner/message_reader
 	turner/message_type
+	turner/message_writer
 	turner/msturn
 	turner/msturn.cpp
+	turner/msturn_session
+	turner/msturn_session.cpp
+	turner/nonce
+	turner/nonce.cpp
+	turner/peer_table
+	turner/peer_table.cpp
+	turner/port_pool
+	turner/port_pool.cpp
 	turner/protocol_error
 	turner/protocol_error.cpp
+	turner/replay_window
+	turner/replay_window.cpp
+	turner/response_cache
+	turner/response_cache.cpp
+	turner/server
+	turner/server.cpp
+	turner/stream_framer
+	turner/stream_framer.cpp
 	turner/stun
 	turner/stun.cpp
+	turner/timer_wheel
+	turner/timer_wheel.cpp
 	turner/turn
 	turner/version
 )
@@ -29,14 +65,57 @@ list(APPEND turner_sources
 list(APPEND turner_test_sources
 	turner/test
 	turner/test.cpp
+	turner/__crc32.test.cpp
+	turner/__hash.test.cpp
+	turner/__hash_table.test.cpp
+	turner/allocation_table.test.cpp
 	turner/attribute_type.test.cpp
 	turner/attribute_type_list.test.cpp
 	turner/attribute_value_type.test.cpp
+	turner/bandwidth_shaper.test.cpp
+	turner/connection_table.test.cpp
+	turner/credential_cache.test.cpp
+	turner/cycle_clock.test.cpp
+	turner/demux.test.cpp
 	turner/error.test.cpp
+	turner/message_integrity.test.cpp
 	turner/message_reader.test.cpp
 	turner/message_type.test.cpp
+	turner/message_writer.test.cpp
 	turner/msturn.test.cpp
+	turner/msturn_session.test.cpp
+	turner/nonce.test.cpp
+	turner/peer_table.test.cpp
+	turner/port_pool.test.cpp
 	turner/protocol_error.test.cpp
+	turner/replay_window.test.cpp
+	turner/response_cache.test.cpp
+	turner/server.test.cpp
+	turner/stream_framer.test.cpp
 	turner/stun.test.cpp
+	turner/timer_wheel.test.cpp
 	turner/turn.test.cpp
 )
+
+list(APPEND turner_bench_sources
+	turner/bench
+	turner/__crc32.bench.cpp
+	turner/allocation_table.bench.cpp
+	turner/attribute_value_type.bench.cpp
+	turner/bandwidth_shaper.bench.cpp
+	turner/message_integrity.bench.cpp
+	turner/message_reader.bench.cpp
+	turner/message_writer.bench.cpp
+	turner/msturn.bench.cpp
+	turner/msturn_session.bench.cpp
+	turner/nonce.bench.cpp
+	turner/peer_table.bench.cpp
+	turner/port_pool.bench.cpp
+	turner/replay_window.bench.cpp
+	turner/response_cache.bench.cpp
+	turner/server.bench.cpp
+	turner/stream_framer.bench.cpp
+	turner/stun.bench.cpp
+	turner/timer_wheel.bench.cpp
+	turner/turn.bench.cpp
+)
@@ -0,0 +1,59 @@
+#include <turner/stun>
+#include <turner/bench>
+#include <benchmark/benchmark.h>
+#include <array>
+
+namespace {
+
+using turner::stun;
+
+constexpr std::string_view password = "VOkJxbRl1RmTxUk/WvJxBt";
+
+// Allocate request sized message with MESSAGE-INTEGRITY + FINGERPRINT
+template <typename Key, typename A>
+std::span<const std::byte> make_request (std::span<std::byte> buffer, A attribute)
+{
+	stun::message_writer writer{buffer, stun::binding, {}};
+	writer
+		.write(stun::username, "3d4ec1c0-5e1b-4d3c-9b85-b8ffc8d37e7a:9f6c")
+		.write(stun::realm, "example.org")
+		.write(stun::nonce, "obMatJos2AAACf//499k954d6OL34oL9FSTvy64sA")
+		.write(stun::software, "turner")
+		.add_integrity(attribute, Key{password})
+		.add_fingerprint()
+	;
+	return writer.finish().value();
+}
+
+template <typename Key, typename A>
+void verify_precomputed (benchmark::State &state, A attribute)
+{
+	std::array<std::byte, 256> buffer;
+	auto reader = stun::read_message(make_request<Key>(buffer, attribute)).value();
+	const Key key{password};
+	for (auto _: state)
+	{
+		benchmark::DoNotOptimize(reader.verify_integrity(attribute, key));
+	}
+	state.SetBytesProcessed(state.iterations() * reader.as_bytes().size_bytes());
+}
+
+template <typename Key, typename A>
+void verify_per_message_key (benchmark::State &state, A attribute)
+{
+	std::array<std::byte, 256> buffer;
+	auto reader = stun::read_message(make_request<Key>(buffer, attribute)).value();
+	for (auto _: state)
+	{
+		const Key key{password};
+		benchmark::DoNotOptimize(reader.verify_integrity(attribute, key));
+	}
+	state.SetBytesProcessed(state.iterations() * reader.as_bytes().size_bytes());
+}
+
+__turner_bench_capture(verify_precomputed<turner::message_integrity_key>, sha1, stun::message_integrity);
+__turner_bench_capture(verify_per_message_key<turner::message_integrity_key>, sha1, stun::message_integrity);
+__turner_bench_capture(verify_precomputed<turner::message_integrity_sha256_key>, sha256, stun::message_integrity_sha256);
+__turner_bench_capture(verify_per_message_key<turner::message_integrity_sha256_key>, sha256, stun::message_integrity_sha256);
+
+} // namespace
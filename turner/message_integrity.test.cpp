@@ -0,0 +1,363 @@
+#include <turner/message_integrity>
+#include <turner/stun>
+#include <turner/turn>
+#include <turner/test>
+#include <catch2/catch_template_test_macros.hpp>
+#include <vector>
+
+namespace {
+
+using namespace turner_test;
+using turner::stun;
+using turner::turn;
+
+// https://datatracker.ietf.org/doc/html/rfc5769#section-2
+constexpr std::string_view password = "VOkJxbRl1RmTxUk/WvJxBt";
+
+// https://datatracker.ietf.org/doc/html/rfc5769#section-2.1
+constexpr uint8_t sample_request[] =
+{
+	0x00, 0x01, 0x00, 0x58, // Request type and message length
+	0x21, 0x12, 0xa4, 0x42, // Magic cookie
+	0xb7, 0xe7, 0xa7, 0x01, // Transaction ID
+	0xbc, 0x34, 0xd6, 0x86,
+	0xfa, 0x87, 0xdf, 0xae,
+	0x80, 0x22, 0x00, 0x10, // SOFTWARE
+	0x53, 0x54, 0x55, 0x4e,
+	0x20, 0x74, 0x65, 0x73,
+	0x74, 0x20, 0x63, 0x6c,
+	0x69, 0x65, 0x6e, 0x74,
+	0x00, 0x24, 0x00, 0x04, // PRIORITY
+	0x6e, 0x00, 0x01, 0xff,
+	0x80, 0x29, 0x00, 0x08, // ICE-CONTROLLED
+	0x93, 0x2f, 0xf9, 0xb1,
+	0x51, 0x26, 0x3b, 0x36,
+	0x00, 0x06, 0x00, 0x09, // USERNAME
+	0x65, 0x76, 0x74, 0x6a,
+	0x3a, 0x68, 0x36, 0x76,
+	0x59, 0x20, 0x20, 0x20,
+	0x00, 0x08, 0x00, 0x14, // MESSAGE-INTEGRITY
+	0x9a, 0xea, 0xa7, 0x0c,
+	0xbf, 0xd8, 0xcb, 0x56,
+	0x78, 0x1e, 0xf2, 0xb5,
+	0xb2, 0xd3, 0xf2, 0x49,
+	0xc1, 0xb5, 0x71, 0xa2,
+	0x80, 0x28, 0x00, 0x04, // FINGERPRINT
+	0xe5, 0x7a, 0x3b, 0xcf,
+};
+
+// https://datatracker.ietf.org/doc/html/rfc5769#section-2.2
+constexpr uint8_t sample_response[] =
+{
+	0x01, 0x01, 0x00, 0x3c, // Response type and message length
+	0x21, 0x12, 0xa4, 0x42, // Magic cookie
+	0xb7, 0xe7, 0xa7, 0x01, // Transaction ID
+	0xbc, 0x34, 0xd6, 0x86,
+	0xfa, 0x87, 0xdf, 0xae,
+	0x80, 0x22, 0x00, 0x0b, // SOFTWARE
+	0x74, 0x65, 0x73, 0x74,
+	0x20, 0x76, 0x65, 0x63,
+	0x74, 0x6f, 0x72, 0x20,
+	0x00, 0x20, 0x00, 0x08, // XOR-MAPPED-ADDRESS
+	0x00, 0x01, 0xa1, 0x47,
+	0xe1, 0x12, 0xa6, 0x43,
+	0x00, 0x08, 0x00, 0x14, // MESSAGE-INTEGRITY
+	0x2b, 0x91, 0xf5, 0x99,
+	0xfd, 0x9e, 0x90, 0xc3,
+	0x8c, 0x74, 0x89, 0xf9,
+	0x2a, 0xf9, 0xba, 0x53,
+	0xf0, 0x6b, 0xe7, 0xd7,
+	0x80, 0x28, 0x00, 0x04, // FINGERPRINT
+	0xc0, 0x7d, 0x4c, 0x96,
+};
+
+// https://datatracker.ietf.org/doc/html/rfc5769#section-2.4
+constexpr uint8_t sample_long_term_request[] =
+{
+	0x00, 0x01, 0x00, 0x60, // Request type and message length
+	0x21, 0x12, 0xa4, 0x42, // Magic cookie
+	0x78, 0xad, 0x34, 0x33, // Transaction ID
+	0xc6, 0xad, 0x72, 0xc0,
+	0x29, 0xda, 0x41, 0x2e,
+	0x00, 0x06, 0x00, 0x12, // USERNAME
+	0xe3, 0x83, 0x9e, 0xe3,
+	0x83, 0x88, 0xe3, 0x83,
+	0xaa, 0xe3, 0x83, 0x83,
+	0xe3, 0x82, 0xaf, 0xe3,
+	0x82, 0xb9, 0x00, 0x00,
+	0x00, 0x15, 0x00, 0x1c, // NONCE
+	0x66, 0x2f, 0x2f, 0x34,
+	0x39, 0x39, 0x6b, 0x39,
+	0x35, 0x34, 0x64, 0x36,
+	0x4f, 0x4c, 0x33, 0x34,
+	0x6f, 0x4c, 0x39, 0x46,
+	0x53, 0x54, 0x76, 0x79,
+	0x36, 0x34, 0x73, 0x41,
+	0x00, 0x14, 0x00, 0x0b, // REALM
+	0x65, 0x78, 0x61, 0x6d,
+	0x70, 0x6c, 0x65, 0x2e,
+	0x6f, 0x72, 0x67, 0x00,
+	0x00, 0x08, 0x00, 0x14, // MESSAGE-INTEGRITY
+	0xf6, 0x70, 0x24, 0x65,
+	0x6d, 0xd6, 0x4a, 0x3e,
+	0x02, 0xb8, 0xe0, 0x71,
+	0x2e, 0x85, 0xc9, 0xa2,
+	0x8c, 0xa8, 0x96, 0x66,
+};
+
+// MD5("<username>:example.org:TheMatrIX") for sample_long_term_request
+constexpr uint8_t sample_long_term_key[] =
+{
+	0xe8, 0xca, 0x7a, 0xd5,
+	0x9d, 0x5e, 0xb0, 0x51,
+	0x8e, 0x31, 0x29, 0x11,
+	0xd2, 0xda, 0xb2, 0xa9,
+};
+
+// sample_response attributes before MESSAGE-INTEGRITY followed by
+// MESSAGE-INTEGRITY-SHA256 (no test vectors in RFC, calculated independently)
+constexpr uint8_t sample_sha256_response[] =
+{
+	0x01, 0x01, 0x00, 0x40, // Response type and message length
+	0x21, 0x12, 0xa4, 0x42, // Magic cookie
+	0xb7, 0xe7, 0xa7, 0x01, // Transaction ID
+	0xbc, 0x34, 0xd6, 0x86,
+	0xfa, 0x87, 0xdf, 0xae,
+	0x80, 0x22, 0x00, 0x0b, // SOFTWARE
+	0x74, 0x65, 0x73, 0x74,
+	0x20, 0x76, 0x65, 0x63,
+	0x74, 0x6f, 0x72, 0x20,
+	0x00, 0x20, 0x00, 0x08, // XOR-MAPPED-ADDRESS
+	0x00, 0x01, 0xa1, 0x47,
+	0xe1, 0x12, 0xa6, 0x43,
+	0x00, 0x1c, 0x00, 0x20, // MESSAGE-INTEGRITY-SHA256
+	0x99, 0xec, 0x9d, 0x43,
+	0xed, 0x1d, 0x73, 0x8d,
+	0x05, 0x2a, 0x57, 0x38,
+	0x8b, 0xd5, 0x34, 0xfe,
+	0xc0, 0x2c, 0x49, 0x90,
+	0xd3, 0xfe, 0xd8, 0xa1,
+	0x84, 0x6b, 0x3b, 0x14,
+	0x8a, 0x9c, 0xf7, 0x37,
+};
+
+// same as sample_sha256_response with digest truncated to 16B
+constexpr uint8_t sample_truncated_sha256_response[] =
+{
+	0x01, 0x01, 0x00, 0x30, // Response type and message length
+	0x21, 0x12, 0xa4, 0x42, // Magic cookie
+	0xb7, 0xe7, 0xa7, 0x01, // Transaction ID
+	0xbc, 0x34, 0xd6, 0x86,
+	0xfa, 0x87, 0xdf, 0xae,
+	0x80, 0x22, 0x00, 0x0b, // SOFTWARE
+	0x74, 0x65, 0x73, 0x74,
+	0x20, 0x76, 0x65, 0x63,
+	0x74, 0x6f, 0x72, 0x20,
+	0x00, 0x20, 0x00, 0x08, // XOR-MAPPED-ADDRESS
+	0x00, 0x01, 0xa1, 0x47,
+	0xe1, 0x12, 0xa6, 0x43,
+	0x00, 0x1c, 0x00, 0x10, // MESSAGE-INTEGRITY-SHA256
+	0x2b, 0x75, 0xc2, 0x05,
+	0x7b, 0x86, 0xda, 0x82,
+	0x90, 0x1d, 0xbb, 0xd8,
+	0x90, 0x96, 0x5a, 0xed,
+};
+
+auto read (const std::span<const uint8_t> &data)
+{
+	return stun::read_message(std::as_bytes(data)).value();
+}
+
+template <typename Protocol, typename Attribute, typename Key>
+concept verifiable_with = requires (const typename Protocol::message_reader &reader, Attribute attribute, const Key &key)
+{
+	reader.verify_integrity(attribute, key);
+};
+
+template <typename Protocol, typename Attribute, typename Key>
+concept writable_with = requires (typename Protocol::message_writer &writer, Attribute attribute, const Key &key)
+{
+	writer.add_integrity(attribute, key);
+};
+
+TEST_CASE("message_integrity")
+{
+	const turner::message_integrity_key key{password};
+	const turner::message_integrity_sha256_key sha256_key{password};
+
+	SECTION("short-term request")
+	{
+		auto reader = read(sample_request);
+		CHECK(!reader.verify_integrity(stun::message_integrity, key));
+	}
+
+	SECTION("short-term response")
+	{
+		auto reader = read(sample_response);
+		CHECK(!reader.verify_integrity(stun::message_integrity, key));
+	}
+
+	SECTION("long-term request")
+	{
+		auto reader = read(sample_long_term_request);
+		turner::message_integrity_key long_term_key{std::as_bytes(std::span{sample_long_term_key})};
+		CHECK(!reader.verify_integrity(stun::message_integrity, long_term_key));
+	}
+
+	SECTION("sha256")
+	{
+		auto reader = read(sample_sha256_response);
+		CHECK(!reader.verify_integrity(stun::message_integrity_sha256, sha256_key));
+	}
+
+	SECTION("sha256 truncated")
+	{
+		auto reader = read(sample_truncated_sha256_response);
+		CHECK(!reader.verify_integrity(stun::message_integrity_sha256, sha256_key));
+	}
+
+	SECTION("turn")
+	{
+		auto reader = turn::read_message(std::as_bytes(std::span{sample_request})).value();
+		CHECK(!reader.verify_integrity(turn::message_integrity, key));
+	}
+
+	SECTION("key type")
+	{
+		using sha1_attribute = decltype(stun::message_integrity);
+		using sha256_attribute = decltype(stun::message_integrity_sha256);
+		using sha1_key = turner::message_integrity_key;
+		using sha256_key = turner::message_integrity_sha256_key;
+
+		__turner_check(verifiable_with<stun, sha1_attribute, sha1_key>);
+		__turner_check(verifiable_with<stun, sha256_attribute, sha256_key>);
+		__turner_check(!verifiable_with<stun, sha1_attribute, sha256_key>);
+		__turner_check(!verifiable_with<stun, sha256_attribute, sha1_key>);
+		__turner_check(!verifiable_with<stun, decltype(stun::fingerprint), sha1_key>);
+
+		__turner_check(writable_with<turn, sha1_attribute, sha1_key>);
+		__turner_check(writable_with<turn, sha256_attribute, sha256_key>);
+		__turner_check(!writable_with<turn, sha1_attribute, sha256_key>);
+		__turner_check(!writable_with<turn, sha256_attribute, sha1_key>);
+	}
+
+	SECTION("invalid key")
+	{
+		auto reader = read(sample_request);
+		turner::message_integrity_key invalid_key{"password"};
+		CHECK(reader.verify_integrity(stun::message_integrity, invalid_key) == turner::errc::message_integrity_mismatch);
+	}
+
+	SECTION("unkeyed key")
+	{
+		// default constructed key has no key material: anyone can compute
+		// its HMAC
+		const turner::message_integrity_key unkeyed_key{};
+		const turner::message_integrity_sha256_key unkeyed_sha256_key{};
+		CHECK_FALSE(unkeyed_key.valid());
+		CHECK_FALSE(unkeyed_sha256_key.valid());
+		CHECK(key.valid());
+		CHECK(sha256_key.valid());
+
+		auto reader = read(sample_request);
+		CHECK(reader.verify_integrity(stun::message_integrity, unkeyed_key) == turner::errc::invalid_integrity_key);
+
+		// forged with unkeyed HMAC
+		std::array<std::byte, 256> buffer;
+		stun::message_writer writer{std::span{buffer}, stun::binding, {}};
+		auto prefix = *writer.write(stun::software, "forged").finish();
+		auto digest = unkeyed_sha256_key.digest(prefix, prefix.size_bytes() - stun::header_size_bytes + 4 + turner::message_integrity_sha256_key::digest_size_bytes);
+		std::ranges::copy(digest, writer.append(stun::message_integrity_sha256.type, digest.size()).begin());
+		reader = stun::read_message(*writer.finish()).value();
+		CHECK(reader.verify_integrity(stun::message_integrity_sha256, unkeyed_sha256_key) == turner::errc::invalid_integrity_key);
+	}
+
+	SECTION("modified message")
+	{
+		std::vector<uint8_t> data{std::begin(sample_sha256_response), std::end(sample_sha256_response)};
+		data[24] ^= 0x01;
+		auto reader = read(data);
+		CHECK(reader.verify_integrity(stun::message_integrity_sha256, sha256_key) == turner::errc::message_integrity_mismatch);
+	}
+
+	SECTION("attribute not found")
+	{
+		auto reader = read(sample_request);
+		CHECK(reader.verify_integrity(stun::message_integrity_sha256, sha256_key) == turner::errc::attribute_not_found);
+	}
+
+	SECTION("unexpected attribute length")
+	{
+		std::vector<uint8_t> data{std::begin(sample_truncated_sha256_response), std::end(sample_truncated_sha256_response)};
+		data[3] -= 4;
+		data[51] -= 4;
+		data.resize(data.size() - 4);
+		auto reader = read(data);
+		CHECK(reader.verify_integrity(stun::message_integrity_sha256, sha256_key) == turner::errc::unexpected_attribute_length);
+	}
+}
+
+TEMPLATE_TEST_CASE("message_integrity: writer", "",
+	stun,
+	turn)
+{
+	using Protocol = TestType;
+	const turner::message_integrity_key key{password};
+	const turner::message_integrity_sha256_key sha256_key{password};
+
+	std::array<std::byte, 256> buffer;
+	typename Protocol::transaction_id_type transaction_id{};
+	typename Protocol::message_writer writer{std::span{buffer}, stun::binding.success, transaction_id};
+	writer.write(stun::software, "test vector");
+
+	SECTION("sample long-term request")
+	{
+		// same transaction ID and attributes as RFC 5769 sample request
+		std::copy_n(sample_long_term_request + 8, transaction_id.size(), transaction_id.begin());
+		turner::message_integrity_key long_term_key{std::as_bytes(std::span{sample_long_term_key})};
+		typename Protocol::message_writer request{std::span{buffer}, stun::binding, transaction_id};
+		request
+			.write(stun::username, "\u30de\u30c8\u30ea\u30c3\u30af\u30b9")
+			.write(stun::nonce, "f//499k954d6OL34oL9FSTvy64sA")
+			.write(stun::realm, "example.org")
+			.add_integrity(stun::message_integrity, long_term_key)
+		;
+		auto message = request.finish();
+		REQUIRE(message);
+		CHECK(std::ranges::equal(*message, std::as_bytes(std::span{sample_long_term_request})));
+	}
+
+	SECTION("sha1 and sha256")
+	{
+		writer
+			.add_integrity(stun::message_integrity, key)
+			.add_integrity(stun::message_integrity_sha256, sha256_key)
+			.add_fingerprint()
+		;
+		auto message = writer.finish();
+		REQUIRE(message);
+
+		auto reader = Protocol::read_message(*message).value();
+		CHECK(!reader.verify_integrity(stun::message_integrity, key));
+		CHECK(!reader.verify_integrity(stun::message_integrity_sha256, sha256_key));
+	}
+
+	SECTION("unkeyed key")
+	{
+		writer.add_integrity(stun::message_integrity, turner::message_integrity_key{});
+		auto message = writer.finish();
+		REQUIRE(!message);
+		CHECK(message.error() == turner::errc::invalid_integrity_key);
+	}
+
+	SECTION("insufficient buffer")
+	{
+		typename Protocol::message_writer writer{std::span{buffer}.first(40), stun::binding.success, transaction_id};
+		writer.add_integrity(stun::message_integrity, key);
+		auto message = writer.finish();
+		REQUIRE(!message);
+		CHECK(message.error() == turner::errc::insufficient_buffer);
+	}
+}
+
+} // namespace
@@ -0,0 +1,236 @@
+#include <turner/msturn>
+#include <turner/stun>
+#include <turner/turn>
+#include <turner/bench>
+#include <array>
+#include <string_view>
+
+// FYI: per-protocol attribute value types read benchmarks are in
+// turner/<protocol>.bench.cpp
+
+namespace {
+
+using namespace turner_bench;
+using turner::msturn;
+using turner::stun;
+using turner::turn;
+
+using message_fn = std::vector<std::byte>(bool with_fingerprint);
+
+const turn::xor_endpoint_value_type::native_value_type peer_endpoint
+{
+	pal::net::ip::address_v4{{192, 0, 2, 1}},
+	32853,
+};
+
+const std::array<std::byte, 1200> payload{};
+
+const std::array<std::byte, 20> integrity{};
+
+// Messages {{{1
+
+std::vector<std::byte> stun_binding (bool with_fingerprint)
+{
+	return make_message<stun>(stun::binding, [&](auto &writer)
+	{
+		writer.write(stun::software, "turner");
+		if (with_fingerprint)
+		{
+			writer.add_fingerprint();
+		}
+	});
+}
+
+std::vector<std::byte> turn_allocate (bool with_fingerprint)
+{
+	static const turner::message_integrity_key key{"password"};
+	return make_message<turn>(turn::allocate, [&](auto &writer)
+	{
+		writer.write(turn::requested_transport, turner::transport_protocol::udp);
+		writer.write(turn::lifetime, std::chrono::seconds{600});
+		writer.write(turn::username, "user");
+		writer.write(turn::realm, "turner.example.com");
+		writer.write(turn::nonce, "f//499k954d6OL34oL9FSTvy64sA");
+		writer.add_integrity(turn::message_integrity, key);
+		if (with_fingerprint)
+		{
+			writer.add_fingerprint();
+		}
+	});
+}
+
+template <size_t PayloadSizeBytes>
+std::vector<std::byte> turn_send (bool with_fingerprint)
+{
+	return make_message<turn>(turn::send_indication, [&](auto &writer)
+	{
+		writer.write(turn::xor_peer_address, peer_endpoint);
+		writer.write(turn::data, std::span{payload}.first(PayloadSizeBytes));
+		if (with_fingerprint)
+		{
+			writer.add_fingerprint();
+		}
+	});
+}
+
+std::vector<std::byte> msturn_allocate (bool)
+{
+	return make_message<msturn>(msturn::allocate, [&](auto &writer)
+	{
+		writer.write(msturn::ms_version, msturn::protocol_version::v6);
+		writer.write(msturn::username, "user");
+		writer.write(msturn::realm, "turner.example.com");
+		writer.write(msturn::nonce, "f//499k954d6OL34oL9FSTvy64sA");
+		writer.write(msturn::message_integrity, integrity);
+	});
+}
+
+template <size_t PayloadSizeBytes>
+std::vector<std::byte> msturn_send (bool)
+{
+	return make_message<msturn>(msturn::send_request, [&](auto &writer)
+	{
+		writer.write(msturn::destination_address, {peer_endpoint.address, peer_endpoint.port});
+		writer.write(msturn::data, std::span{payload}.first(PayloadSizeBytes));
+	});
+}
+
+// read_message {{{1
+
+template <typename Protocol>
+void read_message (benchmark::State &state, message_fn *make, bool with_fingerprint)
+{
+	auto message = make(with_fingerprint);
+	for (auto _: state)
+	{
+		auto reader = Protocol::read_message(message);
+		benchmark::DoNotOptimize(reader);
+	}
+	set_messages_processed(state, message.size());
+}
+
+__turner_bench_capture(read_message<stun>, stun_binding, stun_binding, false);
+__turner_bench_capture(read_message<stun>, stun_binding_fingerprint, stun_binding, true);
+__turner_bench_capture(read_message<turn>, turn_allocate, turn_allocate, false);
+__turner_bench_capture(read_message<turn>, turn_allocate_fingerprint, turn_allocate, true);
+__turner_bench_capture(read_message<turn>, turn_send_160, turn_send<160>, false);
+__turner_bench_capture(read_message<turn>, turn_send_160_fingerprint, turn_send<160>, true);
+__turner_bench_capture(read_message<turn>, turn_send_1200, turn_send<1200>, false);
+__turner_bench_capture(read_message<turn>, turn_send_1200_fingerprint, turn_send<1200>, true);
+__turner_bench_capture(read_message<msturn>, msturn_allocate, msturn_allocate, false);
+__turner_bench_capture(read_message<msturn>, msturn_send_160, msturn_send<160>, false);
+__turner_bench_capture(read_message<msturn>, msturn_send_1200, msturn_send<1200>, false);
+
+// validation_policy {{{1
+
+template <turner::validation_policy Policy>
+void read_turn_message (benchmark::State &state, message_fn *make)
+{
+	auto message = make(true);
+	for (auto _: state)
+	{
+		auto reader = turn::read_message<Policy>(message);
+		benchmark::DoNotOptimize(reader);
+	}
+	set_messages_processed(state, message.size());
+}
+
+using turner::validation_policy;
+__turner_bench_capture(read_turn_message<validation_policy::full>, allocate, turn_allocate);
+__turner_bench_capture(read_turn_message<validation_policy::structural>, allocate, turn_allocate);
+__turner_bench_capture(read_turn_message<validation_policy::header_only>, allocate, turn_allocate);
+__turner_bench_capture(read_turn_message<validation_policy::full>, send_1200, turn_send<1200>);
+__turner_bench_capture(read_turn_message<validation_policy::structural>, send_1200, turn_send<1200>);
+__turner_bench_capture(read_turn_message<validation_policy::header_only>, send_1200, turn_send<1200>);
+
+// attribute_type_list {{{1
+
+constexpr auto allocate_attributes = turner::attributes<
+	turn::requested_transport,
+	turn::lifetime,
+	turn::username,
+	turn::realm,
+	turn::nonce,
+	turn::message_integrity
+>;
+
+void read_attribute_type_list (benchmark::State &state)
+{
+	auto message = turn_allocate(true);
+	auto reader = turn::read_message(message).value();
+	for (auto _: state)
+	{
+		auto values = reader.read(allocate_attributes);
+		benchmark::DoNotOptimize(values);
+	}
+	set_messages_processed(state, message.size());
+}
+BENCHMARK(read_attribute_type_list);
+
+void read_attribute_type_list_indexed (benchmark::State &state)
+{
+	auto message = turn_allocate(true);
+	auto reader = turn::read_message(message).value();
+	for (auto _: state)
+	{
+		auto values = reader.indexed().read(allocate_attributes);
+		benchmark::DoNotOptimize(values);
+	}
+	set_messages_processed(state, message.size());
+}
+BENCHMARK(read_attribute_type_list_indexed);
+
+// visit {{{1
+
+void visit (benchmark::State &state)
+{
+	auto message = turn_allocate(true);
+	auto reader = turn::read_message(message).value();
+	std::array<uint16_t, 8> unread;
+	for (auto _: state)
+	{
+		auto count = reader.visit(allocate_attributes, [](auto, const auto &value)
+		{
+			benchmark::DoNotOptimize(value);
+		}, std::span{unread});
+		benchmark::DoNotOptimize(count);
+	}
+	set_messages_processed(state, message.size());
+}
+BENCHMARK(visit);
+
+// not_read {{{1
+
+void not_read (benchmark::State &state)
+{
+	auto message = turn_allocate(true);
+	auto reader = turn::read_message(message).value();
+	std::array<uint16_t, 8> unread;
+	for (auto _: state)
+	{
+		auto count = reader.not_read(std::span{unread}, allocate_attributes.any_comprehension_required());
+		benchmark::DoNotOptimize(count);
+		benchmark::DoNotOptimize(unread);
+	}
+	set_messages_processed(state, message.size());
+}
+BENCHMARK(not_read);
+
+void not_read_indexed (benchmark::State &state)
+{
+	auto message = turn_allocate(true);
+	auto reader = turn::read_message(message).value().indexed();
+	std::array<uint16_t, 8> unread;
+	for (auto _: state)
+	{
+		auto count = reader.not_read(std::span{unread}, allocate_attributes.any_comprehension_required());
+		benchmark::DoNotOptimize(count);
+		benchmark::DoNotOptimize(unread);
+	}
+	set_messages_processed(state, message.size());
+}
+BENCHMARK(not_read_indexed);
+
+//}}}1
+
+} // namespace
@@ -241,6 +241,11 @@ TEMPLATE_TEST_CASE("message_reader", "",
 		auto reader = Protocol::read_message(span);
 		REQUIRE(!reader);
 		CHECK(reader.error() == turner::errc::invalid_magic_cookie);
+
+		// header is validated by all policies
+		reader = Protocol::template read_message<turner::validation_policy::header_only>(span);
+		REQUIRE(!reader);
+		CHECK(reader.error() == turner::errc::invalid_magic_cookie);
 	}
 
 	SECTION("unexpected message length")
@@ -317,6 +322,14 @@ TEMPLATE_TEST_CASE("message_reader", "",
 		auto reader = Protocol::read_message(std::as_bytes(std::span{data}));
 		REQUIRE(!reader);
 		CHECK(reader.error() == turner::errc::unexpected_attribute_length);
+
+		reader = Protocol::template read_message<turner::validation_policy::structural>(std::as_bytes(std::span{data}));
+		REQUIRE(!reader);
+		CHECK(reader.error() == turner::errc::unexpected_attribute_length);
+
+		// attributes are not walked
+		reader = Protocol::template read_message<turner::validation_policy::header_only>(std::as_bytes(std::span{data}));
+		CHECK(reader);
 	}
 
 	SECTION("attribute not found")
@@ -327,6 +340,69 @@ TEMPLATE_TEST_CASE("message_reader", "",
 		auto value = reader.read(not_found_attribute);
 		REQUIRE(!value);
 		CHECK(value.error() == turner::errc::attribute_not_found);
+
+		auto indexed = reader.indexed();
+		value = indexed.read(not_found_attribute);
+		REQUIRE(!value);
+		CHECK(value.error() == turner::errc::attribute_not_found);
+	}
+
+	SECTION("indexed")
+	{
+		// header (+ MS-TURN Magic Cookie) from valid message
+		constexpr size_t prefix_size = std::is_same_v<TestType, msturn> ? 28 : 20;
+		std::vector<uint8_t> data{
+			TestType::valid_message,
+			TestType::valid_message + prefix_size
+		};
+
+		// more attributes than index can hold + duplicate of 1st
+		constexpr uint16_t attribute_count = 2 * turner::indexed_message_reader<Protocol>::max_indexed_attributes;
+		for (uint16_t i = 0;  i <= attribute_count;  ++i)
+		{
+			auto type = 0x8100 + i % attribute_count;
+			data.insert(data.end(), {
+				uint8_t(type >> 8), uint8_t(type), 0x00, 0x04,
+				0x00, 0x00, uint8_t(i >> 8), uint8_t(i),
+			});
+		}
+		auto payload_size = uint16_t(data.size() - Protocol::header_size_bytes);
+		data[2] = uint8_t(payload_size >> 8);
+		data[3] = uint8_t(payload_size);
+
+		auto reader = Protocol::read_message(std::as_bytes(std::span{data}));
+		REQUIRE(reader);
+		auto indexed = reader->indexed();
+		CHECK(indexed.indexed_size() == indexed.max_indexed_attributes);
+
+		SECTION("read")
+		{
+			using uint32 = turner::uint32_value_type;
+			CHECK(indexed.read(turner::attribute<Protocol, uint32, 0x8100>).value() == 0);
+			CHECK(indexed.read(turner::attribute<Protocol, uint32, 0x8101>).value() == 1);
+			CHECK(indexed.read(turner::attribute<Protocol, uint32, 0x8117>).value() == 23);
+			CHECK(indexed.read(turner::attribute<Protocol, uint32, 0x8118>).value() == 24);
+			CHECK(indexed.read(turner::attribute<Protocol, uint32, 0x812f>).value() == 47);
+
+			auto [a0, a1, a2] = indexed.read(turner::attributes<
+				turner::attribute<Protocol, uint32, 0x812f>,
+				turner::attribute<Protocol, uint32, 0x8100>,
+				turner::attribute<Protocol, uint32, 0x8130>
+			>);
+			CHECK(a0.value() == 47);
+			CHECK(a1.value() == 0);
+			CHECK(a2.error_or(std::error_code{}) == turner::errc::attribute_not_found);
+		}
+
+		SECTION("not_read")
+		{
+			std::array<uint16_t, attribute_count + 1> indexed_list{}, list{};
+			auto all = [](uint16_t) noexcept { return true; };
+			auto count = indexed.not_read(std::span{indexed_list}, all);
+			CHECK(count == attribute_count + 1u);
+			CHECK(count == reader->not_read(std::span{list}, all));
+			CHECK(indexed_list == list);
+		}
 	}
 }
 
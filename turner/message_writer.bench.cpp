@@ -0,0 +1,41 @@
+#include <turner/stun>
+#include <turner/bench>
+#include <benchmark/benchmark.h>
+#include <array>
+
+namespace {
+
+using turner::stun;
+using turner_bench::set_messages_processed;
+using turner_bench::transaction_id;
+
+const stun::xor_endpoint_value_type::native_value_type mapped_endpoint
+{
+	pal::net::ip::address_v4{{192, 0, 2, 1}},
+	32853,
+};
+
+void binding_success (benchmark::State &state, bool with_fingerprint)
+{
+	std::array<std::byte, 128> buffer;
+	size_t size_bytes = 0;
+	for (auto _: state)
+	{
+		stun::message_writer writer{std::span{buffer}, stun::binding.success, transaction_id<stun>()};
+		writer.write(stun::xor_mapped_address, mapped_endpoint);
+		if (with_fingerprint)
+		{
+			writer.add_fingerprint();
+		}
+		auto message = writer.finish();
+		size_bytes = message->size_bytes();
+		benchmark::DoNotOptimize(message);
+		benchmark::ClobberMemory();
+	}
+	set_messages_processed(state, size_bytes);
+}
+
+BENCHMARK_CAPTURE(binding_success, no_fingerprint, false);
+BENCHMARK_CAPTURE(binding_success, fingerprint, true);
+
+} // namespace
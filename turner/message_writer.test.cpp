@@ -0,0 +1,440 @@
+#include <turner/message_writer>
+#include <turner/msturn>
+#include <turner/stun>
+#include <turner/turn>
+#include <turner/test>
+#include <catch2/catch_template_test_macros.hpp>
+
+// FYI: per-protocol attribute value types write tests are in
+// turner/<protocol>.test.cpp
+
+namespace {
+
+using namespace turner_test;
+using namespace std::chrono_literals;
+
+using turner::msturn;
+using turner::stun;
+using turner::turn;
+
+template <typename Protocol>
+constexpr auto test_transaction_id () noexcept
+{
+	if constexpr (std::is_same_v<Protocol, msturn>)
+	{
+		// same bytes as STUN Magic Cookie + transaction ID, XOR'ed
+		// endpoints are then equal for all protocols
+		return msturn::transaction_id_type{
+			0x21, 0x12, 0xa4, 0x42,
+			0x00, 0x01, 0x02, 0x03,
+			0x04, 0x05, 0x06, 0x07,
+			0x08, 0x09, 0x0a, 0x0b,
+		};
+	}
+	else
+	{
+		return stun::transaction_id_type{
+			0x00, 0x01, 0x02, 0x03,
+			0x04, 0x05, 0x06, 0x07,
+			0x08, 0x09, 0x0a, 0x0b,
+		};
+	}
+}
+
+template <typename Protocol>
+struct writer_fixture
+{
+	std::array<std::byte, 128> buffer{};
+	turner::message_writer<Protocol> writer{
+		std::span{buffer},
+		turner::request<Protocol, 0x0001>,
+		test_transaction_id<Protocol>()
+	};
+
+	template <typename Attribute, typename V = typename Attribute::value_type::native_value_type>
+	pal::result<V> round_trip (Attribute attribute, const std::type_identity_t<V> &value)
+	{
+		auto bytes = writer.write(attribute, value).finish();
+		if (!bytes)
+		{
+			return pal::unexpected{bytes.error()};
+		}
+		return Protocol::read_message(*bytes).value().read(attribute);
+	}
+
+	std::span<const std::byte> last_attribute_value (size_t size) const
+	{
+		auto bytes = writer.as_bytes();
+		return bytes.last(size);
+	}
+};
+
+TEMPLATE_TEST_CASE("message_writer", "",
+	msturn,
+	stun,
+	turn)
+{
+	using Protocol = TestType;
+	writer_fixture<Protocol> test;
+	auto &writer = test.writer;
+
+	SECTION("header")
+	{
+		auto bytes = writer.finish();
+		REQUIRE(bytes);
+		auto reader = Protocol::read_message(*bytes);
+		REQUIRE(reader);
+		CHECK(reader->expect(turner::request<Protocol, 0x0001>));
+		CHECK(reader->transaction_id() == test_transaction_id<Protocol>());
+		CHECK(writer.transaction_id() == test_transaction_id<Protocol>());
+		CHECK(reader->begin() == reader->end());
+	}
+
+	SECTION("insufficient buffer for header")
+	{
+		std::array<std::byte, Protocol::header_size_bytes - 1> buffer;
+		turner::message_writer<Protocol> w{std::span{buffer}, turner::request<Protocol, 0x0001>, {}};
+		auto bytes = w.finish();
+		REQUIRE(!bytes);
+		CHECK(bytes.error() == turner::errc::insufficient_buffer);
+	}
+
+	SECTION("insufficient buffer for attribute")
+	{
+		std::array<std::byte, 40> buffer;
+		turner::message_writer<Protocol> w{std::span{buffer}, turner::request<Protocol, 0x0001>, {}};
+		w.write(Protocol::username, "0123456789abcdefghij");
+		auto bytes = w.finish();
+		REQUIRE(!bytes);
+		CHECK(bytes.error() == turner::errc::insufficient_buffer);
+	}
+
+	SECTION("insufficient buffer for padding")
+	{
+		// value fits but padding does not
+		std::array<std::byte, 51> buffer;
+		turner::message_writer<Protocol> w{std::span{buffer}, turner::request<Protocol, 0x0001>, {}};
+		auto header_size = w.as_bytes().size();
+		std::string_view value = "0123456789abcdefghijklmnopqrstu";
+		w.write(Protocol::username, value.substr(0, buffer.size() - header_size - 4));
+		auto bytes = w.finish();
+		REQUIRE(!bytes);
+		CHECK(bytes.error() == turner::errc::insufficient_buffer);
+	}
+
+	SECTION("append")
+	{
+		auto value = writer.append(0x8080, 5);
+		REQUIRE(value.size() == 5);
+		std::memcpy(value.data(), "value", 5);
+
+		auto reader = Protocol::read_message(writer.finish().value()).value();
+		auto attribute = turner::attribute<Protocol, turner::string_value_type<>, 0x8080>;
+		CHECK(reader.read(attribute).value() == "value");
+		CHECK(writer.as_bytes().back() == std::byte{0});
+	}
+
+	SECTION("constexpr")
+	{
+		// header and raw attribute framing at compile time
+		constexpr auto message = []
+		{
+			std::array<std::byte, 64> buffer{};
+			turner::message_writer<Protocol> w{std::span{buffer}, turner::request<Protocol, 0x0001>, test_transaction_id<Protocol>()};
+			for (auto &b: w.append(0x8080, 3))
+			{
+				b = std::byte{'v'};
+			}
+			return std::make_pair(buffer, w.as_bytes().size());
+		}();
+		static_assert(message.second % 4 == 0);
+
+		for (auto &b: writer.append(0x8080, 3))
+		{
+			b = std::byte{'v'};
+		}
+		CHECK(std::ranges::equal(writer.finish().value(), std::span{message.first}.first(message.second)));
+	}
+
+	SECTION("sticky error")
+	{
+		std::array<std::byte, 40> buffer;
+		turner::message_writer<Protocol> w{std::span{buffer}, turner::request<Protocol, 0x0001>, {}};
+		w.write(Protocol::username, "0123456789abcdefghij");
+		w.write(Protocol::realm, "r");
+		CHECK(w.append(0x8080, 0).empty());
+		auto bytes = w.finish();
+		REQUIRE(!bytes);
+		CHECK(bytes.error() == turner::errc::insufficient_buffer);
+	}
+
+	SECTION("multiple attributes")
+	{
+		writer
+			.write(Protocol::username, "user")
+			.write(Protocol::realm, "realm")
+			.write(Protocol::nonce, "nonce")
+		;
+		auto reader = Protocol::read_message(writer.finish().value()).value();
+		auto [username, realm, nonce] = reader.read(turner::attributes<
+			Protocol::username,
+			Protocol::realm,
+			Protocol::nonce
+		>);
+		CHECK(username.value() == "user");
+		CHECK(realm.value() == "realm");
+		CHECK(nonce.value() == "nonce");
+	}
+
+	SECTION("uint32_value_type") //{{{1
+	{
+		auto attribute = turner::attribute<Protocol, turner::uint32_value_type, 0x8080>;
+		CHECK(test.round_trip(attribute, 0x01020304u).value() == 0x01020304u);
+	}
+
+	SECTION("seconds_value_type") //{{{1
+	{
+		auto attribute = turner::attribute<Protocol, turner::seconds_value_type, 0x8080>;
+
+		SECTION("valid")
+		{
+			CHECK(test.round_trip(attribute, 600s).value() == 600s);
+		}
+
+		SECTION("unexpected attribute value")
+		{
+			auto value = test.round_trip(attribute, -1s);
+			REQUIRE(!value);
+			CHECK(value.error() == turner::errc::unexpected_attribute_value);
+		}
+	}
+
+	SECTION("address_family_value_type") //{{{1
+	{
+		auto attribute = turner::attribute<Protocol, turner::address_family_value_type, 0x8080>;
+		CHECK(test.round_trip(attribute, turner::address_family::v6).value() == turner::address_family::v6);
+	}
+
+	SECTION("transport_protocol_value_type") //{{{1
+	{
+		auto attribute = turner::attribute<Protocol, turner::transport_protocol_value_type, 0x8080>;
+		CHECK(test.round_trip(attribute, turner::transport_protocol::udp).value() == turner::transport_protocol::udp);
+	}
+
+	SECTION("string_value_type") //{{{1
+	{
+		auto attribute = turner::attribute<Protocol, turner::string_value_type<5>, 0x8080>;
+
+		SECTION("valid")
+		{
+			CHECK(test.round_trip(attribute, "test").value() == "test");
+		}
+
+		SECTION("empty")
+		{
+			CHECK(test.round_trip(attribute, "").value() == "");
+		}
+
+		SECTION("unexpected attribute length")
+		{
+			auto value = test.round_trip(attribute, "too long");
+			REQUIRE(!value);
+			CHECK(value.error() == turner::errc::unexpected_attribute_length);
+		}
+	}
+
+	SECTION("bytes_value_type") //{{{1
+	{
+		constexpr uint8_t data[] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+		auto bytes = std::as_bytes(std::span{data});
+
+		SECTION("dynamic extent")
+		{
+			auto attribute = turner::attribute<Protocol, turner::bytes_value_type<>, 0x8080>;
+			auto value = test.round_trip(attribute, bytes.first(5));
+			REQUIRE(value);
+			CHECK(std::equal(value->begin(), value->end(), bytes.begin(), bytes.begin() + 5));
+		}
+
+		SECTION("static extent")
+		{
+			auto attribute = turner::attribute<Protocol, turner::bytes_value_type<8>, 0x8080>;
+			auto value = test.round_trip(attribute, bytes.first<8>());
+			REQUIRE(value);
+			CHECK(std::equal(value->begin(), value->end(), bytes.begin(), bytes.end()));
+		}
+	}
+
+	SECTION("error_code_value_type") //{{{1
+	{
+		auto attribute = turner::attribute<Protocol, turner::error_code_value_type, 0x8080>;
+
+		SECTION("valid")
+		{
+			auto value = test.round_trip(attribute, {turner::protocol_errc::stale_nonce, "Stale Nonce"});
+			REQUIRE(value);
+			CHECK(value->code == turner::protocol_errc::stale_nonce);
+			CHECK(value->reason == "Stale Nonce");
+		}
+
+		SECTION("unexpected attribute value")
+		{
+			auto value = test.round_trip(attribute, {turner::protocol_errc(200), "OK"});
+			REQUIRE(!value);
+			CHECK(value.error() == turner::errc::unexpected_attribute_value);
+		}
+	}
+
+	SECTION("attribute_list_value_type") //{{{1
+	{
+		auto attribute = turner::attribute<Protocol, turner::attribute_list_value_type, 0x8080>;
+
+		SECTION("valid")
+		{
+			auto value = test.round_trip(attribute, {2, {0x0001, 0x8002}});
+			REQUIRE(value);
+			CHECK(value->size == 2);
+			CHECK(value->list[0] == 0x0001);
+			CHECK(value->list[1] == 0x8002);
+		}
+
+		SECTION("overflow")
+		{
+			auto value = test.round_trip(attribute, {6, {0x0001, 0x0002, 0x0003, 0x0004}});
+			REQUIRE(value);
+			CHECK(value->size == 4);
+		}
+	}
+
+	SECTION("endpoint_value_type") //{{{1
+	{
+		auto attribute = turner::attribute<Protocol, turner::endpoint_value_type<Protocol>, 0x8080>;
+
+		SECTION("IPv4")
+		{
+			auto value = test.round_trip(attribute, {pal::net::ip::address_v4::loopback(), 0x1234});
+			REQUIRE(value);
+			CHECK(value->address == pal::net::ip::address_v4::loopback());
+			CHECK(value->port == 0x1234);
+
+			constexpr uint8_t expected[] =
+			{
+				0x00, 0x01, 0x12, 0x34,
+				0x7f, 0x00, 0x00, 0x01,
+			};
+			CHECK(std::ranges::equal(test.last_attribute_value(8), std::as_bytes(std::span{expected})));
+		}
+
+		SECTION("IPv6")
+		{
+			auto value = test.round_trip(attribute, {pal::net::ip::address_v6::loopback(), 0x2345});
+			REQUIRE(value);
+			CHECK(value->address == pal::net::ip::address_v6::loopback());
+			CHECK(value->port == 0x2345);
+		}
+	}
+
+	SECTION("xor_endpoint_value_type") //{{{1
+	{
+		auto attribute = turner::attribute<Protocol, turner::xor_endpoint_value_type<Protocol>, 0x8080>;
+
+		SECTION("IPv4")
+		{
+			auto value = test.round_trip(attribute, {pal::net::ip::address_v4::loopback(), 0x1234});
+			REQUIRE(value);
+			CHECK(value->address == pal::net::ip::address_v4::loopback());
+			CHECK(value->port == 0x1234);
+
+			constexpr uint8_t expected[] =
+			{
+				0x00, 0x01, 0x33, 0x26,
+				0x5e, 0x12, 0xa4, 0x43,
+			};
+			CHECK(std::ranges::equal(test.last_attribute_value(8), std::as_bytes(std::span{expected})));
+		}
+
+		SECTION("IPv6")
+		{
+			auto value = test.round_trip(attribute, {pal::net::ip::address_v6::loopback(), 0x2345});
+			REQUIRE(value);
+			CHECK(value->address == pal::net::ip::address_v6::loopback());
+			CHECK(value->port == 0x2345);
+
+			constexpr uint8_t expected[] =
+			{
+				0x00, 0x02, 0x02, 0x57,
+				0x21, 0x12, 0xa4, 0x42,
+				0x00, 0x01, 0x02, 0x03,
+				0x04, 0x05, 0x06, 0x07,
+				0x08, 0x09, 0x0a, 0x0a,
+			};
+			CHECK(std::ranges::equal(test.last_attribute_value(20), std::as_bytes(std::span{expected})));
+		}
+	}
+
+	//}}}1
+}
+
+TEMPLATE_TEST_CASE("message_writer: fingerprint", "",
+	stun,
+	turn)
+{
+	using Protocol = TestType;
+	std::array<std::byte, 64> buffer;
+
+	SECTION("fingerprint")
+	{
+		// same as turner/message_reader.test.cpp valid messages
+		auto message = std::conditional_t<std::is_same_v<Protocol, stun>,
+			decltype(stun::binding),
+			decltype(turn::allocate)
+		>{};
+		auto expected_fingerprint = std::is_same_v<Protocol, stun> ? 0x5b0ff6fcU : 0x2fbbf00dU;
+
+		turner::message_writer<Protocol> writer{std::span{buffer}, message, test_transaction_id<Protocol>()};
+		auto bytes = writer.add_fingerprint().finish();
+		REQUIRE(bytes);
+		CHECK(bytes->size() == 28);
+
+		auto reader = Protocol::read_message(*bytes);
+		REQUIRE(reader);
+		CHECK(reader->read(Protocol::fingerprint).value() == expected_fingerprint);
+	}
+
+	SECTION("fingerprint with attributes")
+	{
+		turner::message_writer<Protocol> writer{std::span{buffer}, Protocol::binding.success, test_transaction_id<Protocol>()};
+		writer
+			.write(Protocol::xor_mapped_address, {pal::net::ip::address_v4::loopback(), 3478})
+			.write(Protocol::software, "turner")
+			.add_fingerprint()
+		;
+		auto bytes = writer.finish();
+		REQUIRE(bytes);
+
+		auto reader = Protocol::read_message(*bytes);
+		REQUIRE(reader);
+		CHECK(reader->expect(Protocol::binding.success));
+		CHECK(reader->read(Protocol::xor_mapped_address)->port == 3478);
+		CHECK(reader->read(Protocol::software).value() == "turner");
+	}
+
+	SECTION("fingerprint not last")
+	{
+		turner::message_writer<Protocol> writer{std::span{buffer}, Protocol::binding, test_transaction_id<Protocol>()};
+		writer.add_fingerprint().write(Protocol::software, "turner");
+		auto bytes = writer.finish();
+		REQUIRE(!bytes);
+		CHECK(bytes.error() == turner::errc::fingerprint_not_last);
+	}
+
+	SECTION("fingerprint insufficient buffer")
+	{
+		turner::message_writer<Protocol> writer{std::span{buffer}.first(24), Protocol::binding, test_transaction_id<Protocol>()};
+		auto bytes = writer.add_fingerprint().finish();
+		REQUIRE(!bytes);
+		CHECK(bytes.error() == turner::errc::insufficient_buffer);
+	}
+}
+
+} // namespace
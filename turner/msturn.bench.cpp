@@ -0,0 +1,22 @@
+#include <turner/msturn>
+#include <turner/bench>
+#include <array>
+
+namespace {
+
+using namespace turner_bench;
+using turner::msturn;
+
+const pal::net::ip::address_v4 address_v4{{192, 0, 2, 1}};
+
+// attribute value types
+
+__turner_bench_capture(read_attribute<msturn::ms_version>, protocol_version, msturn::protocol_version::v6);
+__turner_bench_capture(read_attribute<msturn::ms_service_quality>, service_quality,
+	{msturn::stream_type::audio, msturn::service_quality::reliable}
+);
+__turner_bench_capture(read_attribute<msturn::ms_sequence_number>, sequence_number, {msturn::connection_id_type{}, 1});
+__turner_bench_capture(read_attribute<msturn::destination_address>, endpoint_v4, {address_v4, 3478});
+__turner_bench_capture(read_attribute<msturn::xor_mapped_address>, xor_endpoint_v4, {address_v4, 3478});
+
+} // namespace
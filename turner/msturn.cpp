@@ -12,6 +12,7 @@ using attribute_view = __view::attribute<msturn>;
 
 } // namespace
 
+template <validation_policy Policy>
 pal::result<msturn::message_reader> msturn::read_message (const std::span<const std::byte> &span) noexcept
 {
 	constexpr auto min_span_size_bytes = header_size_bytes + magic_cookie.size();
@@ -38,6 +39,24 @@ pal::result<msturn::message_reader> msturn::read_message (const std::span<const
 		return make_unexpected(errc::unexpected_message_type);
 	}
 
+	if constexpr (Policy == validation_policy::header_only)
+	{
+		return message_reader{span};
+	}
+	else
+	{
+		// no FINGERPRINT, structural is same as full
+		return read_message_attributes(span);
+	}
+}
+
+template pal::result<msturn::message_reader> msturn::read_message<validation_policy::full> (const std::span<const std::byte> &) noexcept;
+template pal::result<msturn::message_reader> msturn::read_message<validation_policy::structural> (const std::span<const std::byte> &) noexcept;
+template pal::result<msturn::message_reader> msturn::read_message<validation_policy::header_only> (const std::span<const std::byte> &) noexcept;
+
+pal::result<msturn::message_reader> msturn::read_message_attributes (const std::span<const std::byte> &span) noexcept
+{
+	auto &message = *reinterpret_cast<const message_view *>(span.data());
 	auto it = message.begin(), end = message.end();
 	while (it < end)
 	{
@@ -10,6 +10,9 @@ using turner::msturn;
 template <typename ValueType>
 using test_message = turner_test::test_message<msturn, ValueType>;
 
+template <typename ValueType>
+using test_writer = turner_test::test_writer<msturn, ValueType>;
+
 
 TEST_CASE("msturn")
 {
@@ -216,6 +219,141 @@ TEST_CASE("msturn")
 		}
 	}
 
+	SECTION("write") //{{{1
+	{
+		SECTION("protocol_version_value_type")
+		{
+			test_writer<msturn::protocol_version_value_type> v{msturn::protocol_version::with_ipv6};
+			CHECK(v.value.value() == msturn::protocol_version::with_ipv6);
+		}
+
+		SECTION("service_quality_value_type")
+		{
+			test_writer<msturn::service_quality_value_type> v{{
+				msturn::stream_type::audio,
+				msturn::service_quality::reliable
+			}};
+			REQUIRE(v.value);
+			CHECK(v.value->type == msturn::stream_type::audio);
+			CHECK(v.value->quality == msturn::service_quality::reliable);
+
+			test_writer<msturn::service_quality_value_type> invalid{{
+				msturn::stream_type(0),
+				msturn::service_quality::reliable
+			}};
+			REQUIRE(!invalid.value);
+			CHECK(invalid.value.error() == turner::errc::unexpected_attribute_value);
+		}
+
+		SECTION("sequence_number_value_type")
+		{
+			constexpr msturn::connection_id_type connection_id
+			{
+				0x01, 0x02, 0x03, 0x04,
+				0x05, 0x06, 0x07, 0x08,
+				0x09, 0x0a, 0x0b, 0x0c,
+				0x0d, 0x0e, 0x0f, 0x10,
+				0x11, 0x12, 0x13, 0x14,
+			};
+			test_writer<msturn::sequence_number_value_type> v{{connection_id, 0x12345678}};
+			REQUIRE(v.value);
+			CHECK(v.value->connection_id == connection_id);
+			CHECK(v.value->sequence_number == 0x12345678);
+		}
+	}
+
+	SECTION("relay framing") //{{{1
+	{
+		constexpr msturn::transaction_id_type transaction_id
+		{
+			0x00, 0x01, 0x02, 0x03,
+			0x04, 0x05, 0x06, 0x07,
+			0x08, 0x09, 0x0a, 0x0b,
+			0x0c, 0x0d, 0x0e, 0x0f,
+		};
+
+		struct param
+		{
+			msturn::endpoint_value_type::native_value_type peer;
+			size_t payload_size;
+		};
+		auto generated = GENERATE(values<param>({
+			{{pal::net::ip::address_v4{{192, 0, 2, 1}}, 32853}, 0},
+			{{pal::net::ip::address_v4{{192, 0, 2, 1}}, 32853}, 1},
+			{{pal::net::ip::address_v6::loopback(), 32853}, 4},
+			{{pal::net::ip::address_v6::loopback(), 32853}, 63},
+		}));
+		const auto &peer = generated.peer;
+		const auto payload_size = generated.payload_size;
+
+		// payload received leaving maximum headroom
+		constexpr size_t payload_offset = msturn::data_indication_headroom_bytes;
+		std::array<std::byte, payload_offset + 64 + msturn::relay_tailroom_bytes> buffer;
+		buffer.fill(std::byte{0xff});
+		auto payload = std::span{buffer}.subspan(payload_offset, payload_size);
+		for (auto i = 0u;  i < payload.size();  ++i)
+		{
+			payload[i] = std::byte(i);
+		}
+
+		SECTION("wrap_data_indication")
+		{
+			auto message = msturn::wrap_data_indication(buffer, payload_offset, payload_size, peer, transaction_id);
+			REQUIRE(message);
+			CHECK(message->data() + message->size_bytes() == payload.data() + ((payload_size + 3) & ~3));
+
+			auto reader = msturn::read_message(*message);
+			REQUIRE(reader);
+			CHECK(reader->expect(msturn::data_indication));
+			CHECK(reader->transaction_id() == transaction_id);
+
+			auto remote_address = reader->read(msturn::remote_address);
+			REQUIRE(remote_address);
+			CHECK(remote_address->address == peer.address);
+			CHECK(remote_address->port == peer.port);
+
+			auto data = reader->read(msturn::data);
+			REQUIRE(data);
+			CHECK(data->data() == payload.data());
+			CHECK(data->size_bytes() == payload.size_bytes());
+			for (auto i = 0u;  i < data->size();  ++i)
+			{
+				CHECK((*data)[i] == std::byte(i));
+			}
+		}
+
+		SECTION("wrap_data_indication: insufficient headroom")
+		{
+			auto headroom = peer.address.is_v4()
+				? msturn::data_indication_headroom_bytes - 12
+				: msturn::data_indication_headroom_bytes
+			;
+			auto message = msturn::wrap_data_indication(std::span{buffer}.subspan(payload_offset - headroom + 1),
+				headroom - 1, payload_size, peer, transaction_id
+			);
+			REQUIRE(!message);
+			CHECK(message.error() == turner::errc::insufficient_buffer);
+
+			// exact headroom
+			message = msturn::wrap_data_indication(std::span{buffer}.subspan(payload_offset - headroom),
+				headroom, payload_size, peer, transaction_id
+			);
+			CHECK(message);
+		}
+
+		SECTION("wrap_data_indication: insufficient tailroom")
+		{
+			auto message = msturn::wrap_data_indication(std::span{buffer}.first(payload_offset + payload_size - 1),
+				payload_offset, payload_size, peer, transaction_id
+			);
+			if (payload_size)
+			{
+				REQUIRE(!message);
+				CHECK(message.error() == turner::errc::insufficient_buffer);
+			}
+		}
+	}
+
 	//}}}1
 }
 
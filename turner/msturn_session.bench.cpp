@@ -0,0 +1,87 @@
+#include <turner/msturn_session>
+#include <turner/bench>
+#include <array>
+
+namespace {
+
+using turner::msturn;
+using turner::msturn_session;
+using turner::endpoint;
+
+constexpr size_t payload_size_bytes = 160;
+const msturn::connection_id_type connection_id{1, 2, 3, 4, 5};
+const endpoint peer{pal::net::ip::address_v4{{203, 0, 113, 1}}, 50000};
+
+// client Send Request to peer (sequence number rewritten in place per
+// iteration)
+void send_request (benchmark::State &state)
+{
+	msturn_session session{connection_id};
+	turner::peer_table peers;
+	turner::replay_window sequences{1};
+	sequences.insert(connection_id, 0);
+	msturn_session::time_point now{};
+
+	std::array<std::byte, 512> buffer{};
+	std::array<std::byte, payload_size_bytes> payload{};
+	msturn::message_writer writer{buffer, msturn::send_request, {}};
+	writer
+		.write(msturn::destination_address, peer)
+		.write(msturn::data, payload)
+		.write(msturn::ms_sequence_number, {connection_id, 0})
+	;
+	auto message = writer.finish().value();
+	auto sequence_number = reinterpret_cast<uint32_t *>(const_cast<std::byte *>(message.data() + message.size() - 4));
+	auto reader = msturn::read_message(message).value();
+
+	uint32_t sequence = 0;
+	for (auto _: state)
+	{
+		*sequence_number = pal::hton(++sequence);
+		auto data = session.send_request(reader, peers, sequences, now);
+		benchmark::DoNotOptimize(data);
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(send_request);
+
+// peer data to client: state.range(0) ? active destination : Data Indication
+void peer_data (benchmark::State &state)
+{
+	msturn_session session{connection_id};
+	turner::peer_table peers;
+	turner::replay_window sequences{1};
+	sequences.insert(connection_id, 0);
+	msturn_session::time_point now{};
+
+	std::array<std::byte, 512> buffer{};
+	auto request = [&](auto type)
+	{
+		msturn::message_writer writer{buffer, type, {}};
+		writer
+			.write(msturn::destination_address, peer)
+			.write(msturn::data, {})
+			.write(msturn::ms_sequence_number, {connection_id, 1})
+		;
+		return msturn::read_message(writer.finish().value()).value();
+	};
+	if (state.range(0))
+	{
+		(void)session.set_active_destination(request(msturn::set_active_destination), peers, sequences, now);
+	}
+	else
+	{
+		(void)session.send_request(request(msturn::send_request), peers, sequences, now);
+	}
+
+	std::array<std::byte, msturn::data_indication_headroom_bytes + payload_size_bytes + msturn::relay_tailroom_bytes> rx{};
+	for (auto _: state)
+	{
+		auto message = session.wrap_peer_data(rx, msturn::data_indication_headroom_bytes, payload_size_bytes, peer, peers, now);
+		benchmark::DoNotOptimize(message);
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(peer_data)->ArgName("active")->Arg(0)->Arg(1);
+
+} // namespace
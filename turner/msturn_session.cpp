@@ -0,0 +1,116 @@
+#include <turner/msturn_session>
+#include <turner/protocol_error>
+
+namespace turner {
+
+std::error_code msturn_session::accept_sequence_number (const pal::result<msturn::sequence_number_value_type::native_value_type> &sequence, replay_window &sequences) const noexcept
+{
+	if (!sequence)
+	{
+		return sequence.error();
+	}
+	else if (sequence->connection_id != connection_id_
+		|| sequences.check(sequence->connection_id, sequence->sequence_number) != replay_window::verdict::accepted)
+	{
+		return errc::unexpected_sequence_number;
+	}
+	return {};
+}
+
+pal::result<msturn_session::peer_data> msturn_session::send_request (const msturn::message_reader &request, peer_table &peers, replay_window &sequences, time_point now)
+{
+	if (!request.expect(msturn::send_request))
+	{
+		return make_unexpected(errc::unexpected_message_type);
+	}
+
+	auto [destination, data, sequence] = request.read(attributes<
+		msturn::destination_address,
+		msturn::data,
+		msturn::ms_sequence_number
+	>);
+	if (!destination)
+	{
+		return pal::unexpected{destination.error()};
+	}
+	else if (!data)
+	{
+		return pal::unexpected{data.error()};
+	}
+	else if (auto error = accept_sequence_number(sequence, sequences))
+	{
+		return pal::unexpected{error};
+	}
+
+	peers.add_permission(destination->address, now + permission_lifetime);
+	return peer_data{*destination, *data};
+}
+
+pal::result<const endpoint *> msturn_session::set_active_destination (const msturn::message_reader &request, peer_table &peers, replay_window &sequences, time_point now)
+{
+	if (!request.expect(msturn::set_active_destination))
+	{
+		return make_unexpected(errc::unexpected_message_type);
+	}
+
+	auto [destination, sequence] = request.read(attributes<
+		msturn::destination_address,
+		msturn::ms_sequence_number
+	>);
+	if (!destination && destination.error() != errc::attribute_not_found)
+	{
+		return pal::unexpected{destination.error()};
+	}
+	else if (auto error = accept_sequence_number(sequence, sequences))
+	{
+		return pal::unexpected{error};
+	}
+
+	if (!destination)
+	{
+		has_active_destination_ = false;
+		return nullptr;
+	}
+
+	peers.add_permission(destination->address, now + permission_lifetime);
+	active_destination_ = *destination;
+	has_active_destination_ = true;
+	return &active_destination_;
+}
+
+pal::result<std::span<const std::byte>> msturn_session::wrap_peer_data (
+	const std::span<std::byte> &buffer,
+	size_t payload_offset,
+	size_t payload_size_bytes,
+	const endpoint &peer,
+	const peer_table &peers,
+	time_point now) noexcept
+{
+	if (has_active_destination_ && peer == active_destination_)
+	{
+		// client's raw datagrams to active destination do not refresh its
+		// permission: active destination is exempt while it is set
+		if (payload_offset > buffer.size_bytes() || buffer.size_bytes() - payload_offset < payload_size_bytes)
+		{
+			return make_unexpected(errc::insufficient_buffer);
+		}
+		return std::span<const std::byte>{buffer.subspan(payload_offset, payload_size_bytes)};
+	}
+	else if (!peers.has_permission(peer.address, now))
+	{
+		return pal::unexpected{make_error_code(protocol_errc::forbidden)};
+	}
+
+	// transaction ID of indication is not used for matching, counter is
+	// sufficient
+	for (auto &b: next_transaction_id_)
+	{
+		if (++b != 0)
+		{
+			break;
+		}
+	}
+	return msturn::wrap_data_indication(buffer, payload_offset, payload_size_bytes, peer, next_transaction_id_);
+}
+
+} // namespace turner
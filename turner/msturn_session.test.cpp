@@ -0,0 +1,268 @@
+#include <turner/msturn_session>
+#include <turner/test>
+#include <array>
+#include <vector>
+
+namespace {
+
+using namespace std::chrono_literals;
+using turner::msturn;
+using turner::msturn_session;
+using turner::peer_table;
+using turner::replay_window;
+
+constexpr msturn::connection_id_type connection_id
+{
+	0x01, 0x02, 0x03, 0x04,
+	0x05, 0x06, 0x07, 0x08,
+	0x09, 0x0a, 0x0b, 0x0c,
+	0x0d, 0x0e, 0x0f, 0x10,
+	0x11, 0x12, 0x13, 0x14,
+};
+
+const turner::endpoint peer{pal::net::ip::address_v4{{192, 0, 2, 1}}, 32853};
+const turner::endpoint other_peer{pal::net::ip::address_v4{{192, 0, 2, 2}}, 32853};
+
+struct request_buffer
+{
+	std::array<std::byte, 256> buffer;
+	std::array<std::byte, 5> payload{std::byte{1}, std::byte{2}, std::byte{3}, std::byte{4}, std::byte{5}};
+
+	template <typename Request>
+	msturn::message_reader make (Request request,
+		const turner::endpoint *destination,
+		uint32_t sequence_number,
+		const msturn::connection_id_type &id = connection_id)
+	{
+		msturn::message_writer writer{buffer, request, {}};
+		if (destination)
+		{
+			writer.write(msturn::destination_address, *destination);
+		}
+		writer.write(msturn::data, payload);
+		writer.write(msturn::ms_sequence_number, {id, sequence_number});
+		return msturn::read_message(writer.finish().value()).value();
+	}
+};
+
+TEST_CASE("msturn_session")
+{
+	msturn_session session{connection_id};
+	peer_table peers;
+	replay_window sequences{16};
+	REQUIRE(sequences.insert(connection_id, 10));
+	peer_table::time_point now{};
+	request_buffer request;
+
+	// returns true if sequence_number is not accepted anymore
+	auto consumed = [&](uint32_t sequence_number)
+	{
+		return sequences.check(connection_id, sequence_number) != replay_window::verdict::accepted;
+	};
+
+	CHECK(session.connection_id() == connection_id);
+	CHECK(session.active_destination() == nullptr);
+
+	SECTION("send_request") //{{{1
+	{
+		auto data = session.send_request(request.make(msturn::send_request, &peer, 11), peers, sequences, now);
+		REQUIRE(data);
+		CHECK(data->peer.address == peer.address);
+		CHECK(data->peer.port == peer.port);
+		CHECK(data->payload.size() == request.payload.size());
+		CHECK(data->payload.data() > request.buffer.data());
+		CHECK(data->payload.data() < request.buffer.data() + request.buffer.size());
+		CHECK(consumed(11));
+
+		CHECK(peers.has_permission(peer.address, now));
+		CHECK(peers.has_permission(peer.address, now + msturn_session::permission_lifetime - 1s));
+		CHECK_FALSE(peers.has_permission(peer.address, now + msturn_session::permission_lifetime));
+		CHECK_FALSE(peers.has_permission(other_peer.address, now));
+	}
+
+	SECTION("send_request: sequence number") //{{{1
+	{
+		struct param
+		{
+			uint32_t sequence_number;
+			bool valid;
+		};
+		auto [sequence_number, valid] = GENERATE(values<param>({
+			{ 10u - replay_window::window_size, false },
+			{ 9, true },
+			{ 10, false },
+			{ 11, true },
+			{ 10u + 0x7fff'ffff, true },
+			{ 10u + 0x8000'0000, false },
+		}));
+
+		auto data = session.send_request(request.make(msturn::send_request, &peer, sequence_number), peers, sequences, now);
+		CHECK(static_cast<bool>(data) == valid);
+		if (valid)
+		{
+			CHECK(consumed(sequence_number));
+		}
+		else
+		{
+			CHECK(data.error() == turner::errc::unexpected_sequence_number);
+			CHECK_FALSE(peers.has_permission(peer.address, now));
+		}
+	}
+
+	SECTION("send_request: reordered and replayed") //{{{1
+	{
+		CHECK(session.send_request(request.make(msturn::send_request, &peer, 13), peers, sequences, now));
+		CHECK(session.send_request(request.make(msturn::send_request, &peer, 11), peers, sequences, now));
+		CHECK(session.send_request(request.make(msturn::send_request, &peer, 12), peers, sequences, now));
+
+		auto replayed = session.send_request(request.make(msturn::send_request, &peer, 12), peers, sequences, now);
+		REQUIRE_FALSE(replayed);
+		CHECK(replayed.error() == turner::errc::unexpected_sequence_number);
+	}
+
+	SECTION("send_request: sequence number wraparound") //{{{1
+	{
+		REQUIRE(sequences.erase(connection_id));
+		REQUIRE(sequences.insert(connection_id, 0xffff'fffe));
+		CHECK(session.send_request(request.make(msturn::send_request, &peer, 0xffff'ffff), peers, sequences, now));
+		CHECK(session.send_request(request.make(msturn::send_request, &peer, 0), peers, sequences, now));
+		CHECK(session.send_request(request.make(msturn::send_request, &peer, 1), peers, sequences, now));
+		CHECK_FALSE(session.send_request(request.make(msturn::send_request, &peer, 0xffff'ffff), peers, sequences, now));
+	}
+
+	SECTION("send_request: unknown connection") //{{{1
+	{
+		REQUIRE(sequences.erase(connection_id));
+		auto data = session.send_request(request.make(msturn::send_request, &peer, 11), peers, sequences, now);
+		REQUIRE_FALSE(data);
+		CHECK(data.error() == turner::errc::unexpected_sequence_number);
+	}
+
+	SECTION("send_request: connection ID mismatch") //{{{1
+	{
+		auto other_id = connection_id;
+		other_id.back() ^= 1;
+		auto data = session.send_request(request.make(msturn::send_request, &peer, 11, other_id), peers, sequences, now);
+		REQUIRE_FALSE(data);
+		CHECK(data.error() == turner::errc::unexpected_sequence_number);
+		CHECK_FALSE(consumed(11));
+	}
+
+	SECTION("send_request: missing destination") //{{{1
+	{
+		auto data = session.send_request(request.make(msturn::send_request, nullptr, 11), peers, sequences, now);
+		REQUIRE_FALSE(data);
+		CHECK(data.error() == turner::errc::attribute_not_found);
+		CHECK_FALSE(consumed(11));
+	}
+
+	SECTION("send_request: unexpected message type") //{{{1
+	{
+		auto data = session.send_request(request.make(msturn::set_active_destination, &peer, 11), peers, sequences, now);
+		REQUIRE_FALSE(data);
+		CHECK(data.error() == turner::errc::unexpected_message_type);
+
+		auto destination = session.set_active_destination(request.make(msturn::send_request, &peer, 11), peers, sequences, now);
+		REQUIRE_FALSE(destination);
+		CHECK(destination.error() == turner::errc::unexpected_message_type);
+	}
+
+	SECTION("set_active_destination") //{{{1
+	{
+		auto destination = session.set_active_destination(request.make(msturn::set_active_destination, &peer, 11), peers, sequences, now);
+		REQUIRE(destination);
+		REQUIRE(*destination == session.active_destination());
+		CHECK(session.active_destination()->address == peer.address);
+		CHECK(session.active_destination()->port == peer.port);
+		CHECK(peers.has_permission(peer.address, now));
+
+		// stale
+		auto stale = session.set_active_destination(request.make(msturn::set_active_destination, &other_peer, 11), peers, sequences, now);
+		REQUIRE_FALSE(stale);
+		CHECK(stale.error() == turner::errc::unexpected_sequence_number);
+		CHECK(session.active_destination()->address == peer.address);
+
+		// reset
+		auto reset = session.set_active_destination(request.make(msturn::set_active_destination, nullptr, 12), peers, sequences, now);
+		REQUIRE(reset);
+		CHECK(*reset == nullptr);
+		CHECK(session.active_destination() == nullptr);
+	}
+
+	SECTION("wrap_peer_data") //{{{1
+	{
+		constexpr size_t payload_offset = msturn::data_indication_headroom_bytes;
+		constexpr size_t payload_size = 5;
+		std::array<std::byte, payload_offset + payload_size + msturn::relay_tailroom_bytes> buffer{};
+		auto payload = std::span{buffer}.subspan(payload_offset, payload_size);
+
+		// no permission
+		auto message = session.wrap_peer_data(buffer, payload_offset, payload_size, peer, peers, now);
+		REQUIRE_FALSE(message);
+		CHECK(message.error() == turner::protocol_errc::forbidden);
+
+		REQUIRE(session.send_request(request.make(msturn::send_request, &peer, 11), peers, sequences, now));
+		REQUIRE(session.send_request(request.make(msturn::send_request, &other_peer, 12), peers, sequences, now));
+
+		// Data Indication, each with different transaction ID
+		std::vector<msturn::transaction_id_type> transaction_ids;
+		for (auto i = 0;  i < 2;  ++i)
+		{
+			message = session.wrap_peer_data(buffer, payload_offset, payload_size, peer, peers, now);
+			REQUIRE(message);
+			auto reader = msturn::read_message(*message);
+			REQUIRE(reader);
+			CHECK(reader->expect(msturn::data_indication));
+			auto remote_address = reader->read(msturn::remote_address);
+			REQUIRE(remote_address);
+			CHECK(remote_address->address == peer.address);
+			auto data = reader->read(msturn::data);
+			REQUIRE(data);
+			CHECK(data->data() == payload.data());
+			transaction_ids.push_back(reader->transaction_id());
+		}
+		CHECK(transaction_ids[0] != transaction_ids[1]);
+
+		// active destination: as-is, others still framed
+		REQUIRE(session.set_active_destination(request.make(msturn::set_active_destination, &peer, 13), peers, sequences, now));
+		message = session.wrap_peer_data(buffer, payload_offset, payload_size, peer, peers, now);
+		REQUIRE(message);
+		CHECK(message->data() == payload.data());
+		CHECK(message->size() == payload.size());
+
+		message = session.wrap_peer_data(buffer, payload_offset, payload_size, other_peer, peers, now);
+		REQUIRE(message);
+		CHECK(msturn::read_message(*message));
+
+		// same address, different port
+		auto other_port = peer;
+		other_port.port++;
+		message = session.wrap_peer_data(buffer, payload_offset, payload_size, other_port, peers, now);
+		REQUIRE(message);
+		CHECK(message->data() < payload.data());
+
+		// permission expired: active destination is exempt
+		auto later = now + msturn_session::permission_lifetime + 1s;
+		message = session.wrap_peer_data(buffer, payload_offset, payload_size, other_peer, peers, later);
+		REQUIRE_FALSE(message);
+		CHECK(message.error() == turner::protocol_errc::forbidden);
+		message = session.wrap_peer_data(buffer, payload_offset, payload_size, peer, peers, later);
+		REQUIRE(message);
+		CHECK(message->data() == payload.data());
+
+		// until it is reset
+		REQUIRE(session.set_active_destination(request.make(msturn::set_active_destination, nullptr, 14), peers, sequences, later));
+		message = session.wrap_peer_data(buffer, payload_offset, payload_size, peer, peers, later);
+		REQUIRE_FALSE(message);
+		CHECK(message.error() == turner::protocol_errc::forbidden);
+
+		// insufficient headroom
+		message = session.wrap_peer_data(buffer, 10, payload_size, other_peer, peers, now);
+		REQUIRE_FALSE(message);
+		CHECK(message.error() == turner::errc::insufficient_buffer);
+	}
+
+	//}}}1
+}
+
+} // namespace
@@ -0,0 +1,37 @@
+#include <turner/nonce>
+#include <turner/bench>
+
+namespace {
+
+using namespace std::chrono_literals;
+using turner::stateless_nonce;
+
+const auto secret = std::as_bytes(std::span{"0123456789abcdef0123456789abcdef", 32});
+const pal::net::ip::address client = pal::net::ip::address_v4{{192, 0, 2, 1}};
+const stateless_nonce::time_point now{1'700'000'000s};
+
+void make (benchmark::State &state)
+{
+	stateless_nonce nonce{secret, 10min};
+	for (auto _: state)
+	{
+		benchmark::DoNotOptimize(nonce.make(client, now));
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(make);
+
+void validate (benchmark::State &state)
+{
+	stateless_nonce nonce{secret, 10min};
+	auto value = nonce.make(client, now);
+	std::string_view view{value.data(), value.size()};
+	for (auto _: state)
+	{
+		benchmark::DoNotOptimize(nonce.validate(view, client, now));
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(validate);
+
+} // namespace
@@ -0,0 +1,172 @@
+#include <turner/nonce>
+#include <pal/byte_order>
+#include <cstring>
+
+namespace turner {
+
+namespace {
+
+constexpr char base64_alphabet[] =
+	"ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+	"abcdefghijklmnopqrstuvwxyz"
+	"0123456789-_"
+;
+
+// base64url value of each character, 0xff for characters not in alphabet
+constexpr auto base64_values = []
+{
+	std::array<uint8_t, 256> result{};
+	result.fill(0xff);
+	for (auto i = 0u;  i < 64;  ++i)
+	{
+		result[static_cast<uint8_t>(base64_alphabet[i])] = static_cast<uint8_t>(i);
+	}
+	return result;
+}();
+
+template <size_t N, size_t M>
+void encode (const std::array<std::byte, N> &in, std::array<char, M> &out) noexcept
+{
+	static_assert(M == (N * 8 + 5) / 6);
+
+	uint32_t bits = 0;
+	size_t bit_count = 0, o = 0;
+	for (auto b: in)
+	{
+		bits = (bits << 8) | static_cast<uint8_t>(b);
+		bit_count += 8;
+		while (bit_count >= 6)
+		{
+			bit_count -= 6;
+			out[o++] = base64_alphabet[(bits >> bit_count) & 0x3f];
+		}
+	}
+	if (bit_count)
+	{
+		out[o++] = base64_alphabet[(bits << (6 - bit_count)) & 0x3f];
+	}
+}
+
+template <size_t N>
+bool decode (std::string_view in, std::array<std::byte, N> &out) noexcept
+{
+	if (in.size() != (N * 8 + 5) / 6)
+	{
+		return false;
+	}
+
+	// accumulate invalid characters instead of branching on each
+	uint32_t bits = 0, invalid = 0;
+	size_t bit_count = 0, o = 0;
+	for (auto c: in)
+	{
+		auto v = base64_values[static_cast<uint8_t>(c)];
+		invalid |= v & 0x40;
+		bits = (bits << 6) | (v & 0x3f);
+		bit_count += 6;
+		if (bit_count >= 8)
+		{
+			bit_count -= 8;
+			out[o++] = static_cast<std::byte>(bits >> bit_count);
+		}
+	}
+	return invalid == 0;
+}
+
+} // namespace
+
+stateless_nonce::stateless_nonce (const std::span<const std::byte> &secret, duration lifetime) noexcept
+	: lifetime_{lifetime}
+{
+	keys_[current_ & 1] = __hash::hmac_key<__hash::sha256>{secret};
+	has_key_[current_ & 1] = true;
+}
+
+void stateless_nonce::rotate (const std::span<const std::byte> &secret) noexcept
+{
+	current_++;
+	keys_[current_ & 1] = __hash::hmac_key<__hash::sha256>{secret};
+	has_key_[current_ & 1] = true;
+}
+
+stateless_nonce::mac_type stateless_nonce::mac (
+	uint8_t key_id,
+	const std::byte *expires,
+	const pal::net::ip::address &client) const noexcept
+{
+	// key ID, expiration time, address family and 16B address (IPv4 zero
+	// padded): fixed size input, single block with HMAC padding
+	std::array<std::byte, 1 + 4 + 1 + 16> input{};
+	input[0] = std::byte{key_id};
+	std::memcpy(input.data() + 1, expires, 4);
+	if (client.is_v4())
+	{
+		input[5] = std::byte{4};
+		std::memcpy(input.data() + 6, client.v4().to_bytes().data(), 4);
+	}
+	else
+	{
+		input[5] = std::byte{6};
+		std::memcpy(input.data() + 6, client.v6().to_bytes().data(), 16);
+	}
+
+	const auto &key = keys_[key_id & 1];
+	auto context = key.inner();
+	context.update(input);
+	auto digest = key.finish(context);
+
+	mac_type result;
+	std::memcpy(result.data(), digest.data(), result.size());
+	return result;
+}
+
+stateless_nonce::value_type stateless_nonce::make (const pal::net::ip::address &client, time_point now) const noexcept
+{
+	auto expires = std::chrono::duration_cast<std::chrono::seconds>((now + lifetime_).time_since_epoch());
+	auto expires_be = pal::hton(static_cast<uint32_t>(expires.count()));
+
+	raw_type raw;
+	raw[0] = std::byte{current_};
+	std::memcpy(raw.data() + 1, &expires_be, sizeof(expires_be));
+	auto m = mac(current_, raw.data() + 1, client);
+	std::memcpy(raw.data() + 5, m.data(), m.size());
+
+	value_type result;
+	encode(raw, result);
+	return result;
+}
+
+std::error_code stateless_nonce::validate (std::string_view nonce, const pal::net::ip::address &client, time_point now) const noexcept
+{
+	raw_type raw;
+	if (!decode(nonce, raw))
+	{
+		return protocol_errc::stale_nonce;
+	}
+
+	auto key_id = static_cast<uint8_t>(raw[0]);
+	if (key_id != current_ && (key_id != static_cast<uint8_t>(current_ - 1) || !has_key_[key_id & 1]))
+	{
+		return protocol_errc::stale_nonce;
+	}
+
+	// constant time compare
+	auto expected = mac(key_id, raw.data() + 1, client);
+	uint8_t diff = 0;
+	for (auto i = 0u;  i < expected.size();  ++i)
+	{
+		diff |= static_cast<uint8_t>(expected[i] ^ raw[5 + i]);
+	}
+
+	uint32_t expires_be;
+	std::memcpy(&expires_be, raw.data() + 1, sizeof(expires_be));
+	auto expires = time_point{std::chrono::seconds{pal::ntoh(expires_be)}};
+
+	if (diff != 0 || expires <= now)
+	{
+		return protocol_errc::stale_nonce;
+	}
+	return {};
+}
+
+} // namespace turner
@@ -0,0 +1,137 @@
+#include <turner/nonce>
+#include <turner/test>
+#include <cctype>
+#include <string>
+
+namespace {
+
+using namespace std::chrono_literals;
+using turner::stateless_nonce;
+
+std::span<const std::byte> as_bytes (std::string_view v)
+{
+	return std::as_bytes(std::span{v.data(), v.size()});
+}
+
+std::string as_string (const stateless_nonce::value_type &v)
+{
+	return {v.data(), v.size()};
+}
+
+TEST_CASE("stateless_nonce")
+{
+	stateless_nonce nonce{as_bytes("secret"), 10min};
+	CHECK(nonce.lifetime() == 10min);
+
+	const pal::net::ip::address client = pal::net::ip::address_v4{{192, 0, 2, 1}};
+	const stateless_nonce::time_point now{1'700'000'000s};
+	auto value = as_string(nonce.make(client, now));
+	CHECK(value.size() == stateless_nonce::size_bytes);
+
+	SECTION("valid") //{{{1
+	{
+		CHECK_FALSE(nonce.validate(value, client, now));
+		CHECK_FALSE(nonce.validate(value, client, now + 10min - 1s));
+
+		// printable, valid for NONCE attribute
+		for (auto c: value)
+		{
+			CHECK((std::isalnum(static_cast<unsigned char>(c)) || c == '-' || c == '_'));
+		}
+	}
+
+	SECTION("IPv6") //{{{1
+	{
+		const pal::net::ip::address v6 = pal::net::ip::address_v6::loopback();
+		stateless_nonce::value_type buffer;
+		auto v = nonce.make(buffer, v6, now);
+		CHECK(v.size() == stateless_nonce::size_bytes);
+		CHECK_FALSE(nonce.validate(v, v6, now));
+		CHECK(nonce.validate(v, client, now) == turner::protocol_errc::stale_nonce);
+	}
+
+	SECTION("expired") //{{{1
+	{
+		CHECK(nonce.validate(value, client, now + 10min) == turner::protocol_errc::stale_nonce);
+		CHECK(nonce.validate(value, client, now + 1h) == turner::protocol_errc::stale_nonce);
+	}
+
+	SECTION("other client") //{{{1
+	{
+		const pal::net::ip::address other = pal::net::ip::address_v4{{192, 0, 2, 2}};
+		CHECK(nonce.validate(value, other, now) == turner::protocol_errc::stale_nonce);
+	}
+
+	SECTION("other secret") //{{{1
+	{
+		stateless_nonce other{as_bytes("other"), 10min};
+		CHECK(other.validate(value, client, now) == turner::protocol_errc::stale_nonce);
+	}
+
+	SECTION("tampered") //{{{1
+	{
+		for (auto i = 0u;  i < value.size();  ++i)
+		{
+			auto tampered = value;
+			tampered[i] = tampered[i] == 'A' ? 'B' : 'A';
+			CHECK(nonce.validate(tampered, client, now) == turner::protocol_errc::stale_nonce);
+		}
+	}
+
+	SECTION("malformed") //{{{1
+	{
+		CHECK(nonce.validate("", client, now) == turner::protocol_errc::stale_nonce);
+		CHECK(nonce.validate(value.substr(1), client, now) == turner::protocol_errc::stale_nonce);
+		CHECK(nonce.validate(value + "A", client, now) == turner::protocol_errc::stale_nonce);
+
+		auto invalid = value;
+		invalid[3] = '+';
+		CHECK(nonce.validate(invalid, client, now) == turner::protocol_errc::stale_nonce);
+	}
+
+	SECTION("rotate") //{{{1
+	{
+		auto id = nonce.key_id();
+		nonce.rotate(as_bytes("secret 2"));
+		CHECK(nonce.key_id() == static_cast<uint8_t>(id + 1));
+
+		// previous secret still accepted
+		auto value2 = as_string(nonce.make(client, now));
+		CHECK(value2 != value);
+		CHECK_FALSE(nonce.validate(value, client, now));
+		CHECK_FALSE(nonce.validate(value2, client, now));
+
+		// until next rotation
+		nonce.rotate(as_bytes("secret 3"));
+		CHECK(nonce.validate(value, client, now) == turner::protocol_errc::stale_nonce);
+		CHECK_FALSE(nonce.validate(value2, client, now));
+
+		// other instance rotated with same secrets accepts same nonces
+		stateless_nonce copy{as_bytes("secret"), 10min};
+		copy.rotate(as_bytes("secret 2"));
+		copy.rotate(as_bytes("secret 3"));
+		CHECK_FALSE(copy.validate(value2, client, now));
+		CHECK(as_string(copy.make(client, now)) == as_string(nonce.make(client, now)));
+	}
+
+	SECTION("key ID wraps around") //{{{1
+	{
+		for (auto i = 0;  i < 255;  ++i)
+		{
+			nonce.rotate(as_bytes("secret"));
+		}
+		CHECK(nonce.key_id() == 255);
+		auto value255 = as_string(nonce.make(client, now));
+		nonce.rotate(as_bytes("secret 256"));
+		CHECK(nonce.key_id() == 0);
+		CHECK_FALSE(nonce.validate(value255, client, now));
+		CHECK_FALSE(nonce.validate(as_string(nonce.make(client, now)), client, now));
+
+		// key ID 0 is reused: original nonce authenticated with other secret
+		CHECK(nonce.validate(value, client, now) == turner::protocol_errc::stale_nonce);
+	}
+
+	//}}}1
+}
+
+} // namespace
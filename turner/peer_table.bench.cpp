@@ -0,0 +1,88 @@
+#include <turner/peer_table>
+#include <turner/bench>
+#include <vector>
+
+namespace {
+
+using namespace std::chrono_literals;
+using turner::peer_table;
+using turner::endpoint;
+
+pal::net::ip::address peer_address (size_t index, bool v6)
+{
+	auto last = static_cast<uint8_t>(index);
+	if (v6)
+	{
+		return pal::net::ip::address_v6{{0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, last}};
+	}
+	return pal::net::ip::address_v4{{192, 0, 2, last}};
+}
+
+// table with range(0) peers, lookups cycle over all of them
+struct fixture
+{
+	peer_table table{};
+	std::vector<endpoint> peers{};
+	peer_table::time_point now{};
+
+	fixture (size_t peer_count, bool v6)
+	{
+		for (auto i = 0u;  i < peer_count;  ++i)
+		{
+			peers.push_back({peer_address(i, v6), 3478});
+			table.add_permission(peers.back().address, now + 300s);
+			table.bind_channel(static_cast<uint16_t>(0x4000 + i), peers.back(), now + 600s);
+		}
+	}
+};
+
+void has_permission (benchmark::State &state, bool v6)
+{
+	fixture f{static_cast<size_t>(state.range(0)), v6};
+	size_t i = 0;
+	for (auto _: state)
+	{
+		benchmark::DoNotOptimize(f.table.has_permission(f.peers[i].address, f.now));
+		if (++i == f.peers.size())
+		{
+			i = 0;
+		}
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_CAPTURE(has_permission, v4, false)->Arg(1)->Arg(4)->Arg(8)->Arg(32);
+BENCHMARK_CAPTURE(has_permission, v6, true)->Arg(1)->Arg(4)->Arg(8)->Arg(32);
+
+void find_channel (benchmark::State &state)
+{
+	fixture f{static_cast<size_t>(state.range(0)), false};
+	size_t i = 0;
+	for (auto _: state)
+	{
+		benchmark::DoNotOptimize(f.table.find_channel(f.peers[i], f.now));
+		if (++i == f.peers.size())
+		{
+			i = 0;
+		}
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(find_channel)->Arg(1)->Arg(4)->Arg(8)->Arg(32);
+
+void find_peer (benchmark::State &state)
+{
+	fixture f{static_cast<size_t>(state.range(0)), false};
+	size_t i = 0;
+	for (auto _: state)
+	{
+		benchmark::DoNotOptimize(f.table.find_peer(static_cast<uint16_t>(0x4000 + i), f.now));
+		if (++i == f.peers.size())
+		{
+			i = 0;
+		}
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(find_peer)->Arg(1)->Arg(4)->Arg(8)->Arg(32);
+
+} // namespace
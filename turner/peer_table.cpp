@@ -0,0 +1,283 @@
+#include <turner/peer_table>
+#include <turner/__hash_table>
+#include <algorithm>
+#include <unordered_map>
+
+namespace turner {
+
+using __hash_table::mix;
+
+// Entries past inline capacity. Spilling is expected to be rare (allocation
+// talking to many peers), so standard containers are good enough here.
+struct peer_table::spill
+{
+	struct peer_key
+	{
+		key_type address;
+		uint16_t port;
+
+		bool operator== (const peer_key &) const noexcept = default;
+	};
+
+	struct hash
+	{
+		size_t operator() (const key_type &key) const noexcept
+		{
+			return static_cast<size_t>(mix(mix(0, key.lo), key.hi));
+		}
+
+		size_t operator() (const peer_key &key) const noexcept
+		{
+			return static_cast<size_t>(mix((*this)(key.address), key.port));
+		}
+	};
+
+	struct channel
+	{
+		endpoint peer;
+		key_type key;
+		time_point expires;
+	};
+
+	std::unordered_map<key_type, time_point, hash> permissions{};
+
+	// channel number -> peer (client to peer direction)
+	std::unordered_map<uint16_t, channel> channels{};
+
+	// peer -> channel number (peer to client direction)
+	std::unordered_map<peer_key, uint16_t, hash> numbers{};
+
+	bool empty () const noexcept
+	{
+		return permissions.empty() && channels.empty();
+	}
+};
+
+peer_table::peer_table () noexcept = default;
+peer_table::~peer_table () noexcept = default;
+
+size_t peer_table::permission_count () const noexcept
+{
+	return permission_size_ + (spill_ ? spill_->permissions.size() : 0);
+}
+
+size_t peer_table::channel_count () const noexcept
+{
+	return channel_size_ + (spill_ ? spill_->channels.size() : 0);
+}
+
+void peer_table::add_permission (const pal::net::ip::address &peer, time_point expires)
+{
+	auto key = to_key(peer);
+	if (auto i = find_inline_permission(key);  i < permission_size_)
+	{
+		permission_expires_[i] = expires;
+		return;
+	}
+
+	if (spill_)
+	{
+		if (auto it = spill_->permissions.find(key);  it != spill_->permissions.end())
+		{
+			it->second = expires;
+			return;
+		}
+	}
+
+	if (permission_size_ < inline_capacity)
+	{
+		permission_key_[permission_size_] = key;
+		permission_expires_[permission_size_] = expires;
+		permission_size_++;
+		return;
+	}
+
+	if (!spill_)
+	{
+		spill_ = std::make_unique<spill>();
+	}
+	spill_->permissions.emplace(key, expires);
+}
+
+bool peer_table::bind_channel (uint16_t number, const endpoint &peer, time_point expires)
+{
+	// binding is refreshed only if both number and peer match existing
+	// binding (including expired but not yet removed one)
+	auto key = to_key(peer.address);
+	auto by_number = find_inline_number(number);
+	auto by_peer = find_inline_channel(key, peer.port);
+	if (by_number < channel_size_ || by_peer < channel_size_)
+	{
+		if (by_number != by_peer)
+		{
+			return false;
+		}
+		channel_expires_[by_number] = expires;
+		return true;
+	}
+
+	if (spill_)
+	{
+		auto it = spill_->channels.find(number);
+		auto has_peer = spill_->numbers.contains({key, peer.port});
+		if (it != spill_->channels.end() || has_peer)
+		{
+			if (it == spill_->channels.end() || !has_peer || !(it->second.peer == peer))
+			{
+				return false;
+			}
+			it->second.expires = expires;
+			return true;
+		}
+	}
+
+	if (channel_size_ < inline_capacity)
+	{
+		channel_number_[channel_size_] = number;
+		channel_port_[channel_size_] = peer.port;
+		channel_key_[channel_size_] = key;
+		channel_expires_[channel_size_] = expires;
+		channel_peer_[channel_size_] = peer;
+		channel_size_++;
+		return true;
+	}
+
+	if (!spill_)
+	{
+		spill_ = std::make_unique<spill>();
+	}
+	spill_->channels.emplace(number, spill::channel{peer, key, expires});
+	spill_->numbers.emplace(spill::peer_key{key, peer.port}, number);
+	return true;
+}
+
+bool peer_table::spill_has_permission (const key_type &key, time_point now) const noexcept
+{
+	auto it = spill_->permissions.find(key);
+	return it != spill_->permissions.end() && it->second > now;
+}
+
+uint16_t peer_table::spill_find_channel (const key_type &key, uint16_t port, time_point now) const noexcept
+{
+	if (auto it = spill_->numbers.find({key, port});  it != spill_->numbers.end())
+	{
+		if (spill_->channels.find(it->second)->second.expires > now)
+		{
+			return it->second;
+		}
+	}
+	return 0;
+}
+
+const endpoint *peer_table::spill_find_peer (uint16_t number, time_point now) const noexcept
+{
+	if (auto it = spill_->channels.find(number);  it != spill_->channels.end())
+	{
+		if (it->second.expires > now)
+		{
+			return &it->second.peer;
+		}
+	}
+	return nullptr;
+}
+
+size_t peer_table::expire (time_point now) noexcept
+{
+	size_t count = 0;
+
+	// swap-remove: order of inline entries is not significant
+	for (size_t i = 0;  i < permission_size_;  /**/)
+	{
+		if (permission_expires_[i] <= now)
+		{
+			permission_size_--;
+			permission_key_[i] = permission_key_[permission_size_];
+			permission_expires_[i] = permission_expires_[permission_size_];
+			count++;
+		}
+		else
+		{
+			++i;
+		}
+	}
+
+	for (size_t i = 0;  i < channel_size_;  /**/)
+	{
+		if (channel_expires_[i] <= now)
+		{
+			channel_size_--;
+			channel_number_[i] = channel_number_[channel_size_];
+			channel_port_[i] = channel_port_[channel_size_];
+			channel_key_[i] = channel_key_[channel_size_];
+			channel_expires_[i] = channel_expires_[channel_size_];
+			channel_peer_[i] = channel_peer_[channel_size_];
+			count++;
+		}
+		else
+		{
+			++i;
+		}
+	}
+
+	if (spill_)
+	{
+		count += std::erase_if(spill_->permissions, [now](const auto &it)
+		{
+			return it.second <= now;
+		});
+
+		for (auto it = spill_->channels.begin();  it != spill_->channels.end();  /**/)
+		{
+			if (it->second.expires <= now)
+			{
+				spill_->numbers.erase({it->second.key, it->second.peer.port});
+				it = spill_->channels.erase(it);
+				count++;
+			}
+			else
+			{
+				++it;
+			}
+		}
+
+		if (spill_->empty())
+		{
+			spill_.reset();
+		}
+	}
+
+	return count;
+}
+
+peer_table::time_point peer_table::next_expiry () const noexcept
+{
+	auto result = time_point::max();
+	for (auto i = 0u;  i < permission_size_;  ++i)
+	{
+		result = (std::min)(result, permission_expires_[i]);
+	}
+	for (auto i = 0u;  i < channel_size_;  ++i)
+	{
+		result = (std::min)(result, channel_expires_[i]);
+	}
+	if (spill_)
+	{
+		for (auto &[_, expires]: spill_->permissions)
+		{
+			result = (std::min)(result, expires);
+		}
+		for (auto &[_, channel]: spill_->channels)
+		{
+			result = (std::min)(result, channel.expires);
+		}
+	}
+	return result;
+}
+
+void peer_table::clear () noexcept
+{
+	permission_size_ = channel_size_ = 0;
+	spill_.reset();
+}
+
+} // namespace turner
@@ -0,0 +1,222 @@
+#include <turner/peer_table>
+#include <turner/test>
+#include <algorithm>
+#include <map>
+#include <random>
+
+namespace {
+
+using namespace std::chrono_literals;
+using turner::peer_table;
+using turner::endpoint;
+
+pal::net::ip::address v4 (uint8_t last)
+{
+	return pal::net::ip::address_v4{{192, 0, 2, last}};
+}
+
+pal::net::ip::address v6 (uint8_t last)
+{
+	return pal::net::ip::address_v6{{0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, last}};
+}
+
+TEST_CASE("peer_table")
+{
+	peer_table table;
+	peer_table::time_point now{};
+	auto expires = now + 300s;
+
+	CHECK(table.permission_count() == 0);
+	CHECK(table.channel_count() == 0);
+	CHECK(table.next_expiry() == peer_table::time_point::max());
+
+	// number of peers: inline only and spilled
+	auto peer_count = GENERATE(values<size_t>({1, peer_table::inline_capacity, 3 * peer_table::inline_capacity}));
+
+	SECTION("permission") //{{{1
+	{
+		for (auto i = 0u;  i < peer_count;  ++i)
+		{
+			table.add_permission(v4(i), expires);
+			table.add_permission(v6(i), expires);
+		}
+		CHECK(table.permission_count() == 2 * peer_count);
+
+		for (auto i = 0u;  i < peer_count;  ++i)
+		{
+			CHECK(table.has_permission(v4(i), now));
+			CHECK(table.has_permission(v6(i), now));
+			CHECK_FALSE(table.has_permission(v4(i), expires));
+		}
+		CHECK_FALSE(table.has_permission(v4(200), now));
+		CHECK_FALSE(table.has_permission(v6(200), now));
+	}
+
+	SECTION("permission refresh") //{{{1
+	{
+		for (auto i = 0u;  i < peer_count;  ++i)
+		{
+			table.add_permission(v4(i), expires);
+		}
+		table.add_permission(v4(0), expires + 300s);
+		table.add_permission(v4(static_cast<uint8_t>(peer_count - 1)), expires + 300s);
+		CHECK(table.permission_count() == peer_count);
+
+		CHECK(table.has_permission(v4(0), expires));
+		CHECK(table.has_permission(v4(static_cast<uint8_t>(peer_count - 1)), expires));
+		CHECK(table.next_expiry() == (peer_count > 2 ? expires : expires + 300s));
+	}
+
+	SECTION("channel") //{{{1
+	{
+		for (auto i = 0u;  i < peer_count;  ++i)
+		{
+			CHECK(table.bind_channel(0x4000 + i, {v4(i), 3478}, expires));
+		}
+		CHECK(table.channel_count() == peer_count);
+
+		for (auto i = 0u;  i < peer_count;  ++i)
+		{
+			endpoint peer{v4(i), 3478};
+			CHECK(table.find_channel(peer, now) == 0x4000 + i);
+			CHECK(table.find_channel(peer, expires) == 0);
+
+			auto p = table.find_peer(0x4000 + i, now);
+			REQUIRE(p != nullptr);
+			CHECK(*p == peer);
+			CHECK(table.find_peer(0x4000 + i, expires) == nullptr);
+		}
+
+		// different port, different family, unbound number
+		CHECK(table.find_channel({v4(0), 3479}, now) == 0);
+		CHECK(table.find_channel({v6(0), 3478}, now) == 0);
+		CHECK(table.find_peer(0x7fff, now) == nullptr);
+
+		// channels do not install permissions
+		CHECK(table.permission_count() == 0);
+	}
+
+	SECTION("channel refresh and conflict") //{{{1
+	{
+		for (auto i = 0u;  i < peer_count;  ++i)
+		{
+			CHECK(table.bind_channel(0x4000 + i, {v4(i), 3478}, expires));
+		}
+		auto last = static_cast<uint16_t>(peer_count - 1);
+
+		// refresh
+		CHECK(table.bind_channel(0x4000 + last, {v4(last), 3478}, expires + 300s));
+		CHECK(table.find_channel({v4(last), 3478}, expires) == 0x4000 + last);
+		CHECK(table.channel_count() == peer_count);
+
+		// number bound to other peer
+		CHECK_FALSE(table.bind_channel(0x4000 + last, {v4(200), 3478}, expires));
+
+		// peer bound to other number
+		CHECK_FALSE(table.bind_channel(0x7000, {v4(last), 3478}, expires));
+
+		// expired but not removed binding still blocks
+		CHECK_FALSE(table.bind_channel(0x4000, {v4(200), 3478}, expires));
+		CHECK(table.channel_count() == peer_count);
+	}
+
+	SECTION("expire") //{{{1
+	{
+		for (auto i = 0u;  i < peer_count;  ++i)
+		{
+			auto t = now + 1s * (i + 1);
+			table.add_permission(v4(i), t);
+			CHECK(table.bind_channel(0x4000 + i, {v6(i), 1}, t));
+		}
+		CHECK(table.next_expiry() == now + 1s);
+
+		for (auto i = 0u;  i < peer_count;  ++i)
+		{
+			auto t = now + 1s * (i + 1);
+			CHECK(table.expire(t) == 2);
+			CHECK(table.permission_count() == peer_count - i - 1);
+			CHECK(table.channel_count() == peer_count - i - 1);
+			CHECK_FALSE(table.has_permission(v4(i), now));
+			CHECK(table.find_peer(0x4000 + i, now) == nullptr);
+			if (i + 1 < peer_count)
+			{
+				CHECK(table.next_expiry() == t + 1s);
+				CHECK(table.has_permission(v4(i + 1), now));
+				CHECK(table.find_channel({v6(i + 1), 1}, now) == 0x4000 + i + 1);
+			}
+		}
+		CHECK(table.next_expiry() == peer_table::time_point::max());
+
+		// removed number can be bound to another peer
+		CHECK(table.bind_channel(0x4000, {v4(200), 1}, expires));
+	}
+
+	SECTION("clear") //{{{1
+	{
+		for (auto i = 0u;  i < peer_count;  ++i)
+		{
+			table.add_permission(v4(i), expires);
+			CHECK(table.bind_channel(0x4000 + i, {v4(i), 1}, expires));
+		}
+		table.clear();
+		CHECK(table.permission_count() == 0);
+		CHECK(table.channel_count() == 0);
+		CHECK_FALSE(table.has_permission(v4(0), now));
+		CHECK(table.find_peer(0x4000, now) == nullptr);
+	}
+
+	//}}}1
+}
+
+TEST_CASE("peer_table: random")
+{
+	// compare against reference with peers moving between inline and
+	// spilled storage
+	peer_table table;
+	std::map<uint16_t, std::pair<uint8_t, int>> channels;
+	std::map<uint8_t, int> permissions;
+	std::mt19937 rng{1};
+	peer_table::time_point epoch{};
+
+	for (auto t = 0;  t < 2000;  ++t)
+	{
+		auto now = epoch + 1s * t;
+		auto peer = static_cast<uint8_t>(rng() % 32);
+		auto number = static_cast<uint16_t>(0x4000 + rng() % 32);
+		auto lifetime = static_cast<int>(1 + rng() % 20);
+
+		table.add_permission(v4(peer), now + 1s * lifetime);
+		permissions[peer] = t + lifetime;
+
+		// reference: both number and peer must be unbound or bound together
+		auto it = channels.find(number);
+		auto peer_bound = std::ranges::any_of(channels, [&](auto &c) { return c.second.first == peer; });
+		bool expected = it == channels.end() ? !peer_bound : it->second.first == peer;
+		REQUIRE(table.bind_channel(number, {v4(peer), 1}, now + 1s * lifetime) == expected);
+		if (expected)
+		{
+			channels[number] = {peer, t + lifetime};
+		}
+
+		if (t % 7 == 0)
+		{
+			size_t expected_count = std::erase_if(permissions, [t](auto &p) { return p.second <= t; })
+				+ std::erase_if(channels, [t](auto &c) { return c.second.second <= t; });
+			REQUIRE(table.expire(now) == expected_count);
+		}
+
+		REQUIRE(table.permission_count() == permissions.size());
+		for (auto &[p, e]: permissions)
+		{
+			REQUIRE(table.has_permission(v4(p), now) == (e > t));
+		}
+		for (auto &[n, c]: channels)
+		{
+			REQUIRE(table.find_channel({v4(c.first), 1}, now) == (c.second > t ? n : 0));
+			auto found = table.find_peer(n, now);
+			REQUIRE((found != nullptr) == (c.second > t));
+		}
+	}
+}
+
+} // namespace
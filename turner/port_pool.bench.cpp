@@ -0,0 +1,72 @@
+#include <turner/port_pool>
+#include <turner/bench>
+#include <vector>
+
+namespace {
+
+using namespace std::chrono_literals;
+using turner::port_pool;
+
+// pool with state.range(0)% of ports in use, allocate + release
+void allocate_release (benchmark::State &state)
+{
+	port_pool pool;
+	auto in_use = pool.available() * state.range(0) / 100;
+	for (auto i = 0u;  i < in_use;  ++i)
+	{
+		benchmark::DoNotOptimize(pool.allocate());
+	}
+
+	for (auto _: state)
+	{
+		auto port = pool.allocate();
+		benchmark::DoNotOptimize(port);
+		pool.release(*port);
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(allocate_release)->Arg(0)->Arg(50)->Arg(99);
+
+void local_cache_allocate_release (benchmark::State &state)
+{
+	port_pool pool;
+	port_pool::local_cache cache{pool};
+	std::vector<uint16_t> ports;
+
+	for (auto _: state)
+	{
+		// allocate/release in bursts to cross cache refill/flush
+		if (ports.size() < 100)
+		{
+			ports.push_back(*cache.allocate());
+		}
+		else
+		{
+			for (auto port: ports)
+			{
+				cache.release(port);
+			}
+			ports.clear();
+		}
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(local_cache_allocate_release);
+
+void allocate_pair_claim (benchmark::State &state)
+{
+	port_pool pool;
+	port_pool::time_point now{};
+
+	for (auto _: state)
+	{
+		auto r = pool.allocate_pair(now + 30s);
+		auto odd = pool.claim(r->second, now);
+		pool.release(r->first);
+		pool.release(*odd);
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(allocate_pair_claim);
+
+} // namespace
@@ -0,0 +1,309 @@
+#include <turner/port_pool>
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+namespace turner {
+
+port_pool::port_pool (uint16_t first, uint16_t last)
+	: first_{first}
+	, last_{(std::max)(first, last)}
+	, word_count_{(last_ - first_ + 1 + 63) / 64u}
+	, summary_count_{(word_count_ + 63) / 64}
+	, words_{new uint64_t[word_count_]{}}
+	, summary_{new uint64_t[summary_count_]{}}
+	, available_{0}
+	, even_mask_{first_ % 2 ? 0xaaaa'aaaa'aaaa'aaaa : 0x5555'5555'5555'5555}
+	, reservation_index_{new uint32_t[size_t{last_} - first_ + 1]{}}
+{
+	for (auto i = 0u;  i <= size_t{last_} - first_;  ++i)
+	{
+		put(i);
+	}
+}
+
+template <typename Select>
+std::optional<size_t> port_pool::find_word (Select select) const noexcept
+{
+	// scan summary words starting from cursor_ (bits below it in first
+	// pass), wrapping around to cursor_ summary word again
+	auto s = cursor_ / 64;
+	auto bits = summary_[s] & (~uint64_t{} << (cursor_ % 64));
+	for (auto n = 0u;  /**/;  ++n)
+	{
+		while (bits)
+		{
+			auto w = s * 64 + std::countr_zero(bits);
+			if (select(words_[w]))
+			{
+				return w;
+			}
+			bits &= bits - 1;
+		}
+		if (n == summary_count_)
+		{
+			return std::nullopt;
+		}
+		s = (s + 1) % summary_count_;
+		bits = summary_[s];
+	}
+}
+
+void port_pool::take (size_t index) noexcept
+{
+	auto w = index / 64;
+	words_[w] &= ~(uint64_t{1} << (index % 64));
+	if (words_[w] == 0)
+	{
+		summary_[w / 64] &= ~(uint64_t{1} << (w % 64));
+	}
+	cursor_ = w;
+	available_--;
+}
+
+bool port_pool::put (size_t index) noexcept
+{
+	auto w = index / 64;
+	auto bit = uint64_t{1} << (index % 64);
+	if (words_[w] & bit)
+	{
+		// already free
+		return false;
+	}
+	words_[w] |= bit;
+	summary_[w / 64] |= uint64_t{1} << (w % 64);
+	available_++;
+	return true;
+}
+
+void port_pool::erase_reservation (size_t position) noexcept
+{
+	reservation_index_[reservations_[position].port - first_] = 0;
+	if (position != reservations_.size() - 1)
+	{
+		reservations_[position] = reservations_.back();
+		reservation_index_[reservations_[position].port - first_] = static_cast<uint32_t>(position + 1);
+	}
+	reservations_.pop_back();
+}
+
+size_t port_pool::available () const noexcept
+{
+	std::lock_guard lock{mutex_};
+	return available_;
+}
+
+port_pool::statistics port_pool::stats () const noexcept
+{
+	return
+	{
+		.allocated = allocated_.load(std::memory_order_relaxed),
+		.released = released_.load(std::memory_order_relaxed),
+		.exhausted = exhausted_.load(std::memory_order_relaxed),
+		.reserved = reserved_.load(std::memory_order_relaxed),
+		.claimed = claimed_.load(std::memory_order_relaxed),
+		.expired = expired_.load(std::memory_order_relaxed),
+	};
+}
+
+size_t port_pool::take_batch (uint16_t *ports, size_t count) noexcept
+{
+	size_t taken = 0;
+	while (taken < count)
+	{
+		auto w = find_word([](uint64_t word) { return word; });
+		if (!w)
+		{
+			break;
+		}
+		for (auto bits = words_[*w];  bits && taken < count;  bits &= bits - 1)
+		{
+			auto index = *w * 64 + std::countr_zero(bits);
+			take(index);
+			ports[taken++] = static_cast<uint16_t>(first_ + index);
+		}
+	}
+	allocated_.fetch_add(taken, std::memory_order_relaxed);
+	return taken;
+}
+
+std::optional<uint16_t> port_pool::allocate () noexcept
+{
+	uint16_t port;
+	std::lock_guard lock{mutex_};
+	if (take_batch(&port, 1))
+	{
+		return port;
+	}
+	exhausted_.fetch_add(1, std::memory_order_relaxed);
+	return std::nullopt;
+}
+
+std::optional<uint16_t> port_pool::allocate_even () noexcept
+{
+	std::lock_guard lock{mutex_};
+	auto select = [this](uint64_t word) { return word & even_mask_; };
+	if (auto w = find_word(select))
+	{
+		auto index = *w * 64 + std::countr_zero(select(words_[*w]));
+		take(index);
+		allocated_.fetch_add(1, std::memory_order_relaxed);
+		return static_cast<uint16_t>(first_ + index);
+	}
+	exhausted_.fetch_add(1, std::memory_order_relaxed);
+	return std::nullopt;
+}
+
+port_pool::token_type port_pool::make_token (uint16_t port) noexcept
+{
+	// port (to locate reservation) + 48 bits of keyed PRF: issued tokens
+	// do not reveal others
+	auto random = token_random_.next();
+
+	token_type token;
+	token[0] = static_cast<std::byte>(port >> 8);
+	token[1] = static_cast<std::byte>(port);
+	std::memcpy(token.data() + 2, &random, token.size() - 2);
+	return token;
+}
+
+std::optional<std::pair<uint16_t, port_pool::token_type>> port_pool::allocate_pair (time_point expires) noexcept
+{
+	std::lock_guard lock{mutex_};
+
+	// even port bit with next (odd) port bit also set; if first_ is odd,
+	// pair crossing word boundary is not found (at most 1 of 64 pairs)
+	auto select = [this](uint64_t word) { return word & (word >> 1) & even_mask_; };
+	if (auto w = find_word(select))
+	{
+		auto index = *w * 64 + std::countr_zero(select(words_[*w]));
+		take(index);
+		take(index + 1);
+		allocated_.fetch_add(1, std::memory_order_relaxed);
+		reserved_.fetch_add(1, std::memory_order_relaxed);
+
+		auto port = static_cast<uint16_t>(first_ + index);
+		auto token = make_token(port + 1);
+		reservations_.push_back({token, static_cast<uint16_t>(port + 1), expires});
+		reservation_index_[index + 1] = static_cast<uint32_t>(reservations_.size());
+		return std::make_pair(port, token);
+	}
+	exhausted_.fetch_add(1, std::memory_order_relaxed);
+	return std::nullopt;
+}
+
+std::optional<uint16_t> port_pool::claim (const token_type &token, time_point now) noexcept
+{
+	auto port = static_cast<uint16_t>(
+		(static_cast<uint16_t>(token[0]) << 8) | static_cast<uint16_t>(token[1])
+	);
+
+	if (port < first_ || port > last_)
+	{
+		return std::nullopt;
+	}
+
+	std::lock_guard lock{mutex_};
+	auto position = reservation_index_[port - first_];
+	if (position == 0 || reservations_[position - 1].token != token)
+	{
+		return std::nullopt;
+	}
+	else if (reservations_[position - 1].expires <= now)
+	{
+		// released by expire()
+		return std::nullopt;
+	}
+	erase_reservation(position - 1);
+	allocated_.fetch_add(1, std::memory_order_relaxed);
+	claimed_.fetch_add(1, std::memory_order_relaxed);
+	return port;
+}
+
+bool port_pool::put_port (uint16_t port) noexcept
+{
+	if (port < first_ || port > last_)
+	{
+		return false;
+	}
+
+	// reserved port is released by claimer or expire()
+	auto index = port - first_;
+	return !reservation_index_[index] && put(index);
+}
+
+void port_pool::release (uint16_t port) noexcept
+{
+	std::lock_guard lock{mutex_};
+	if (put_port(port))
+	{
+		released_.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+size_t port_pool::expire (time_point now) noexcept
+{
+	std::lock_guard lock{mutex_};
+	size_t count = 0, released = 0;
+	for (auto i = 0u;  i < reservations_.size();  /**/)
+	{
+		if (reservations_[i].expires > now)
+		{
+			++i;
+			continue;
+		}
+		released += put(reservations_[i].port - first_);
+		erase_reservation(i);
+		count++;
+	}
+	released_.fetch_add(released, std::memory_order_relaxed);
+	expired_.fetch_add(count, std::memory_order_relaxed);
+	return count;
+}
+
+port_pool::local_cache::local_cache (port_pool &pool, size_t batch_size)
+	: pool_{pool}
+	, batch_size_{(std::max)(batch_size, size_t{1})}
+	, capacity_{2 * batch_size_}
+	, ports_{new uint16_t[capacity_]}
+{ }
+
+port_pool::local_cache::~local_cache () noexcept
+{
+	flush(size_);
+}
+
+bool port_pool::local_cache::refill () noexcept
+{
+	// called only when empty
+	head_ = 0;
+	{
+		std::lock_guard lock{pool_.mutex_};
+		size_ = pool_.take_batch(ports_.get(), batch_size_);
+	}
+	if (size_ == 0)
+	{
+		pool_.exhausted_.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+	return true;
+}
+
+void port_pool::local_cache::flush (size_t count) noexcept
+{
+	// return oldest ports
+	count = (std::min)(count, size_);
+	size_t released = 0;
+	{
+		std::lock_guard lock{pool_.mutex_};
+		for (auto i = 0u;  i < count;  ++i)
+		{
+			released += pool_.put_port(ports_[position(i)]);
+		}
+	}
+	head_ = position(count);
+	size_ -= count;
+	pool_.released_.fetch_add(released, std::memory_order_relaxed);
+}
+
+} // namespace turner
@@ -0,0 +1,453 @@
+#include <turner/port_pool>
+#include <turner/test>
+#include <cstring>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace std::chrono_literals;
+using turner::port_pool;
+
+TEST_CASE("port_pool")
+{
+	port_pool::time_point now{};
+
+	SECTION("default range") //{{{1
+	{
+		port_pool pool;
+		CHECK(pool.first() == port_pool::default_first);
+		CHECK(pool.last() == port_pool::default_last);
+		CHECK(pool.available() == 16384);
+	}
+
+	SECTION("allocate") //{{{1
+	{
+		struct param
+		{
+			uint16_t first, last;
+		};
+		auto [first, last] = GENERATE(values<param>({
+			{ 1000, 1000 },
+			{ 1000, 1063 },
+			{ 1000, 1064 },
+			{ 1001, 1200 },
+			{ 49152, 65535 },
+		}));
+		port_pool pool{first, last};
+		size_t size = last - first + 1;
+		CHECK(pool.available() == size);
+
+		// all ports are allocated exactly once
+		std::set<uint16_t> ports;
+		while (auto port = pool.allocate())
+		{
+			CHECK(*port >= first);
+			CHECK(*port <= last);
+			CHECK(ports.insert(*port).second);
+		}
+		CHECK(ports.size() == size);
+		CHECK(pool.available() == 0);
+		CHECK(pool.stats().allocated == size);
+		CHECK(pool.stats().exhausted == 1);
+
+		// released port is allocated again
+		pool.release(*ports.begin());
+		CHECK(pool.available() == 1);
+		CHECK(pool.allocate() == *ports.begin());
+		CHECK_FALSE(pool.allocate());
+		CHECK(pool.stats().exhausted == 2);
+
+		// release all
+		for (auto port: ports)
+		{
+			pool.release(port);
+		}
+		CHECK(pool.available() == size);
+		CHECK(pool.stats().released == size + 1);
+	}
+
+	SECTION("release invalid") //{{{1
+	{
+		port_pool pool{1000, 1099};
+
+		// out of range
+		pool.release(999);
+		pool.release(1100);
+		CHECK(pool.available() == 100);
+
+		// not allocated
+		pool.release(1000);
+		CHECK(pool.available() == 100);
+		CHECK(pool.stats().released == 0);
+	}
+
+	SECTION("invalid range") //{{{1
+	{
+		port_pool pool{1000, 999};
+		CHECK(pool.first() == 1000);
+		CHECK(pool.last() == 1000);
+		CHECK(pool.available() == 1);
+	}
+
+	SECTION("allocate_even") //{{{1
+	{
+		auto first = GENERATE(values<uint16_t>({1000, 1001}));
+		uint16_t last = first + 199;
+		port_pool pool{first, last};
+
+		std::set<uint16_t> ports;
+		while (auto port = pool.allocate_even())
+		{
+			CHECK(*port % 2 == 0);
+			CHECK(ports.insert(*port).second);
+		}
+		CHECK(ports.size() == 100);
+		CHECK(pool.stats().exhausted == 1);
+
+		// odd ports are still available
+		CHECK(pool.available() == size_t(last - first + 1 - 100));
+		auto port = pool.allocate();
+		REQUIRE(port);
+		CHECK(*port % 2 == 1);
+	}
+
+	SECTION("allocate_pair") //{{{1
+	{
+		port_pool pool{1000, 1009};
+
+		auto r1 = pool.allocate_pair(now + 30s);
+		REQUIRE(r1);
+		CHECK(r1->first % 2 == 0);
+		CHECK(pool.available() == 8);
+
+		auto r2 = pool.allocate_pair(now + 30s);
+		REQUIRE(r2);
+		CHECK(r2->first != r1->first);
+		CHECK(r2->second != r1->second);
+		CHECK(pool.available() == 6);
+
+		auto stats = pool.stats();
+		CHECK(stats.allocated == 2);
+		CHECK(stats.reserved == 2);
+
+		// claim reserved odd port
+		CHECK(pool.claim(r1->second, now + 10s) == r1->first + 1);
+		CHECK(pool.stats().claimed == 1);
+		CHECK(pool.stats().allocated == 3);
+
+		// claim only once
+		CHECK_FALSE(pool.claim(r1->second, now + 10s));
+
+		// unknown token
+		auto token = r2->second;
+		token[7] ^= std::byte{1};
+		CHECK_FALSE(pool.claim(token, now + 10s));
+
+		// expired
+		CHECK_FALSE(pool.claim(r2->second, now + 30s));
+		CHECK(pool.available() == 6);
+		CHECK(pool.expire(now + 30s) == 1);
+		CHECK(pool.available() == 7);
+		CHECK_FALSE(pool.claim(r2->second, now + 10s));
+		CHECK(pool.stats().expired == 1);
+	}
+
+	SECTION("allocate_pair release reserved") //{{{1
+	{
+		port_pool pool{1000, 1009};
+		auto r = pool.allocate_pair(now + 30s);
+		REQUIRE(r);
+		CHECK(pool.available() == 8);
+
+		// reserved port is not released by owner of even port
+		pool.release(r->first + 1);
+		CHECK(pool.available() == 8);
+		CHECK(pool.stats().released == 0);
+
+		// but by expire(), once
+		CHECK(pool.expire(now + 30s) == 1);
+		CHECK(pool.available() == 9);
+		CHECK(pool.stats().released == 1);
+		pool.release(r->first + 1);
+		CHECK(pool.available() == 9);
+		CHECK(pool.stats().released == 1);
+	}
+
+	SECTION("allocate_pair many") //{{{1
+	{
+		port_pool pool{1000, 1999};
+
+		std::vector<std::pair<uint16_t, port_pool::token_type>> reservations;
+		for (auto i = 0;  i < 500;  ++i)
+		{
+			auto r = pool.allocate_pair(now + std::chrono::seconds{i % 2 ? 10 : 30});
+			REQUIRE(r);
+			reservations.push_back(*r);
+		}
+		CHECK(pool.available() == 0);
+
+		// claim every 3rd, expire every 2nd
+		for (auto i = 0u;  i < reservations.size();  i += 3)
+		{
+			CHECK(pool.claim(reservations[i].second, now) == reservations[i].first + 1);
+		}
+		CHECK(pool.expire(now + 10s) == 250 - 250 / 3);
+		for (auto i = 0u;  i < reservations.size();  ++i)
+		{
+			auto claimed = pool.claim(reservations[i].second, now);
+			if (i % 3 == 0 || i % 2 == 1)
+			{
+				CHECK_FALSE(claimed);
+			}
+			else
+			{
+				CHECK(claimed == reservations[i].first + 1);
+			}
+		}
+		CHECK(pool.expire(now + 30s) == 0);
+
+		// token for port outside of range
+		auto token = reservations[0].second;
+		token[0] = token[1] = std::byte{0xff};
+		CHECK_FALSE(pool.claim(token, now));
+	}
+
+	SECTION("allocate_pair not expired") //{{{1
+	{
+		port_pool pool{1000, 1009};
+		auto r = pool.allocate_pair(now + 30s);
+		REQUIRE(r);
+		CHECK(pool.expire(now + 10s) == 0);
+		CHECK(pool.claim(r->second, now + 20s) == r->first + 1);
+		CHECK(pool.expire(now + 40s) == 0);
+	}
+
+	SECTION("allocate_pair fragmented") //{{{1
+	{
+		port_pool pool{1000, 1099};
+
+		// allocate all, release even ports: there is even port, but no pair
+		while (pool.allocate())
+		{ }
+		for (auto port = 1000;  port < 1100;  port += 2)
+		{
+			pool.release(port);
+		}
+		CHECK(pool.available() == 50);
+		CHECK_FALSE(pool.allocate_pair(now + 30s));
+		CHECK(pool.stats().exhausted == 2);
+
+		// release one odd port
+		pool.release(1051);
+		auto r = pool.allocate_pair(now + 30s);
+		REQUIRE(r);
+		CHECK(r->first == 1050);
+		CHECK(pool.claim(r->second, now) == 1051);
+	}
+
+	SECTION("allocate_pair token is not splitmix64 stream") //{{{1
+	{
+		// splitmix64 is invertible: client that knows 48 bits of its token
+		// tries all 2^16 remaining bits, recovers generator state for each
+		// and checks whether it predicts next client's token
+		constexpr uint64_t gamma = 0x9e3779b97f4a7c15;
+		constexpr uint64_t c1 = 0xbf58476d1ce4e5b9, c2 = 0x94d049bb133111eb;
+		constexpr uint64_t mask = (uint64_t{1} << 48) - 1;
+
+		auto mix = [](uint64_t h, uint64_t v)
+		{
+			h = (h ^ v) * gamma;
+			return h ^ (h >> 29);
+		};
+
+		auto unmix = [](uint64_t h, uint64_t v)
+		{
+			uint64_t inverse = gamma;
+			for (auto i = 0;  i < 5;  ++i)
+			{
+				inverse *= 2 - gamma * inverse;
+			}
+			h ^= (h >> 29) ^ (h >> 58);
+			return (h * inverse) ^ v;
+		};
+
+		auto linked = [&](uint64_t first, uint64_t second)
+		{
+			size_t count = 0;
+			for (uint64_t high = 0;  high <= 0xffff;  ++high)
+			{
+				auto state = unmix(unmix(first | (high << 48), c2), c1);
+				count += (mix(mix(state + gamma, c1), c2) & mask) == second;
+			}
+			return count;
+		};
+
+		auto random_bits = [](const port_pool::token_type &token)
+		{
+			uint64_t v = 0;
+			std::memcpy(&v, token.data() + 2, token.size() - 2);
+			return v;
+		};
+
+		// attack works against splitmix64
+		uint64_t state = 12345;
+		auto next = [&]
+		{
+			state += gamma;
+			return mix(mix(state, c1), c2) & mask;
+		};
+		auto s1 = next(), s2 = next();
+		CHECK(linked(s1, s2) == 1);
+
+		// but not against pool tokens
+		port_pool pool{1000, 1009};
+		auto r1 = pool.allocate_pair(now + 30s);
+		auto r2 = pool.allocate_pair(now + 30s);
+		REQUIRE(r1);
+		REQUIRE(r2);
+		CHECK(linked(random_bits(r1->second), random_bits(r2->second)) == 0);
+	}
+
+	SECTION("local_cache") //{{{1
+	{
+		port_pool pool{1000, 1099};
+		{
+			port_pool::local_cache cache{pool, 8};
+			CHECK(cache.size() == 0);
+
+			auto port = cache.allocate();
+			REQUIRE(port);
+			CHECK(cache.size() == 7);
+			CHECK(pool.available() == 92);
+
+			// released into cache
+			cache.release(*port);
+			CHECK(cache.size() == 8);
+			CHECK(pool.available() == 92);
+
+			// exhaust
+			std::set<uint16_t> ports;
+			while (auto p = cache.allocate())
+			{
+				CHECK(ports.insert(*p).second);
+			}
+			CHECK(ports.size() == 100);
+			CHECK(pool.available() == 0);
+			CHECK(pool.stats().exhausted == 1);
+
+			// release all: flushed to pool in batches
+			for (auto p: ports)
+			{
+				cache.release(p);
+				CHECK(cache.size() <= 16);
+			}
+			CHECK(pool.available() + cache.size() == 100);
+		}
+
+		// returned to pool on destruction
+		CHECK(pool.available() == 100);
+	}
+
+	SECTION("local_cache reuse order") //{{{1
+	{
+		port_pool pool{1000, 1099};
+		port_pool::local_cache cache{pool, 8};
+
+		// released port is reused after all ports cached before it
+		auto port = cache.allocate();
+		REQUIRE(port);
+		cache.release(*port);
+		for (auto i = 0;  i < 7;  ++i)
+		{
+			auto p = cache.allocate();
+			REQUIRE(p);
+			CHECK(*p != *port);
+		}
+		CHECK(cache.allocate() == port);
+
+		// full cache returns oldest ports to pool
+		std::vector<uint16_t> ports;
+		for (auto i = 0;  i < 16;  ++i)
+		{
+			auto p = cache.allocate();
+			REQUIRE(p);
+			ports.push_back(*p);
+		}
+		for (auto p: ports)
+		{
+			cache.release(p);
+		}
+		CHECK(cache.size() == 16);
+		cache.release(*port);
+		CHECK(cache.size() == 9);
+		for (auto i = 8u;  i < ports.size();  ++i)
+		{
+			CHECK(cache.allocate() == ports[i]);
+		}
+		CHECK(cache.allocate() == port);
+	}
+
+	SECTION("local_cache release invalid") //{{{1
+	{
+		port_pool pool{1000, 1099};
+		{
+			port_pool::local_cache cache{pool, 1};
+			auto port = cache.allocate();
+			REQUIRE(port);
+
+			// duplicate, out of range and not allocated
+			cache.release(*port);
+			cache.release(*port);
+			cache.release(999);
+			cache.release(1100);
+		}
+		CHECK(pool.available() == 100);
+		CHECK(pool.stats().released == 1);
+	}
+
+	SECTION("local_cache threads") //{{{1
+	{
+		port_pool pool{1000, 4999};
+		constexpr auto thread_count = 4;
+		std::vector<std::vector<uint16_t>> allocated(thread_count);
+		{
+			std::vector<std::jthread> threads;
+			for (auto t = 0;  t < thread_count;  ++t)
+			{
+				threads.emplace_back([&pool, &ports = allocated[t]]
+				{
+					port_pool::local_cache cache{pool};
+					for (auto i = 0;  i < 10000;  ++i)
+					{
+						if (auto port = cache.allocate())
+						{
+							ports.push_back(*port);
+						}
+						if (i % 3 == 0 && !ports.empty())
+						{
+							cache.release(ports.back());
+							ports.pop_back();
+						}
+					}
+				});
+			}
+		}
+
+		// no port allocated twice
+		std::set<uint16_t> ports;
+		for (auto &v: allocated)
+		{
+			for (auto port: v)
+			{
+				CHECK(ports.insert(port).second);
+			}
+		}
+		CHECK(pool.available() + ports.size() == 4000);
+	}
+
+	//}}}1
+}
+
+} // namespace
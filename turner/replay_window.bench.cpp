@@ -0,0 +1,91 @@
+#include <turner/replay_window>
+#include <turner/bench>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+using turner::replay_window;
+
+std::vector<replay_window::connection_id_type> make_ids (size_t count)
+{
+	std::mt19937_64 rng{1};
+	std::vector<replay_window::connection_id_type> ids(count);
+	for (auto &id: ids)
+	{
+		for (auto &b: id)
+		{
+			b = static_cast<uint8_t>(rng());
+		}
+	}
+	return ids;
+}
+
+// in-order sequence numbers of state.range(0) connections, checked in
+// random connection order
+void check (benchmark::State &state)
+{
+	auto count = static_cast<size_t>(state.range(0));
+	auto ids = make_ids(count);
+	replay_window table{count};
+	for (auto &id: ids)
+	{
+		table.insert(id, 0);
+	}
+
+	std::vector<uint32_t> order(4096);
+	std::mt19937 rng{2};
+	for (auto &i: order)
+	{
+		i = static_cast<uint32_t>(rng() % count);
+	}
+
+	uint32_t sequence_number = 0;
+	size_t i = 0;
+	for (auto _: state)
+	{
+		auto &id = ids[order[i++ % order.size()]];
+		benchmark::DoNotOptimize(table.check(id, ++sequence_number));
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(check)->Arg(1024)->Arg(256 * 1024);
+
+// same as check, batch of max_batch_size at a time
+void check_batch (benchmark::State &state)
+{
+	auto count = static_cast<size_t>(state.range(0));
+	auto ids = make_ids(count);
+	replay_window table{count};
+	for (auto &id: ids)
+	{
+		table.insert(id, 0);
+	}
+
+	std::vector<replay_window::sequence> sequences(4096);
+	std::mt19937 rng{2};
+	for (auto &s: sequences)
+	{
+		s.connection_id = ids[rng() % count];
+	}
+
+	std::array<replay_window::verdict, replay_window::max_batch_size> result;
+	uint32_t sequence_number = 0;
+	size_t i = 0;
+	for (auto _: state)
+	{
+		auto batch = std::span{sequences}.subspan(i, result.size());
+		for (auto &s: batch)
+		{
+			s.sequence_number = ++sequence_number;
+		}
+		table.check(batch, result);
+		benchmark::DoNotOptimize(result.data());
+		i = (i + result.size()) % sequences.size();
+	}
+	state.SetItemsProcessed(state.iterations() * result.size());
+}
+BENCHMARK(check_batch)->Arg(1024)->Arg(256 * 1024);
+
+} // namespace
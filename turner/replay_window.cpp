@@ -0,0 +1,165 @@
+#include <turner/replay_window>
+#include <algorithm>
+
+namespace turner {
+
+using __hash_table::tag_of;
+
+uint64_t replay_window::hash (const connection_id_type &connection_id) noexcept
+{
+	uint64_t words[3]{};
+	std::memcpy(words, connection_id.data(), connection_id.size());
+	return __hash_table::hash(words);
+}
+
+replay_window::replay_window (size_t capacity, size_t shard_count)
+	: shards_{new shard[(std::max)(shard_count, size_t{1})]}
+	, shard_count_{(std::max)(shard_count, size_t{1})}
+{
+	auto shard_capacity = static_cast<uint32_t>((std::max)((capacity + shard_count_ - 1) / shard_count_, size_t{1}));
+	for (auto s = shards_.get();  s != shards_.get() + shard_count_;  ++s)
+	{
+		s->entries.reset(new entry[shard_capacity]);
+		s->index = __hash_table::index{shard_capacity};
+		s->free = __hash_table::free_list{shard_capacity};
+		s->capacity = shard_capacity;
+	}
+}
+
+size_t replay_window::size () const noexcept
+{
+	size_t result = 0;
+	for (auto s = shards_.get();  s != shards_.get() + shard_count_;  ++s)
+	{
+		result += s->size;
+	}
+	return result;
+}
+
+bool replay_window::insert (const connection_id_type &connection_id, uint32_t sequence_number) noexcept
+{
+	auto h = hash(connection_id);
+	auto &s = shards_[shard_of(h)];
+
+	auto tag = tag_of(h);
+	auto e = s.find(connection_id, tag);
+	if (e->tag || s.size == s.capacity)
+	{
+		return false;
+	}
+
+	auto entry_index = s.free.pop();
+	s.size++;
+
+	s.entries[entry_index] = {
+		.connection_id = connection_id,
+		.highest = sequence_number,
+		.bitmap = 1,
+	};
+
+	e->tag = tag;
+	e->slot = entry_index;
+	return true;
+}
+
+bool replay_window::erase (const connection_id_type &connection_id) noexcept
+{
+	auto h = hash(connection_id);
+	auto &s = shards_[shard_of(h)];
+
+	auto e = s.find(connection_id, tag_of(h));
+	if (!e->tag)
+	{
+		return false;
+	}
+
+	s.free.push(e->slot);
+	s.size--;
+	s.index.erase(e);
+	return true;
+}
+
+bool replay_window::contains (const connection_id_type &connection_id) const noexcept
+{
+	auto h = hash(connection_id);
+	return shards_[shard_of(h)].find(connection_id, tag_of(h))->tag != 0;
+}
+
+replay_window::verdict replay_window::update (entry &e, uint32_t sequence_number) noexcept
+{
+	// serial number arithmetic: positive distance is ahead of highest
+	auto distance = static_cast<int32_t>(sequence_number - e.highest);
+	if (distance > 0)
+	{
+		// slide window forward
+		e.bitmap = distance < static_cast<int32_t>(window_size) ? (e.bitmap << distance) | 1 : 1;
+		e.highest = sequence_number;
+		return verdict::accepted;
+	}
+
+	auto offset = uint32_t{0} - static_cast<uint32_t>(distance);
+	if (offset >= window_size)
+	{
+		return verdict::too_old;
+	}
+
+	auto bit = uint64_t{1} << offset;
+	if (e.bitmap & bit)
+	{
+		return verdict::replayed;
+	}
+	e.bitmap |= bit;
+	return verdict::accepted;
+}
+
+replay_window::verdict replay_window::check (const connection_id_type &connection_id, uint32_t sequence_number) noexcept
+{
+	auto h = hash(connection_id);
+	auto &s = shards_[shard_of(h)];
+	if (auto e = s.find(connection_id, tag_of(h));  e->tag)
+	{
+		return update(s.entries[e->slot], sequence_number);
+	}
+	return verdict::unknown_connection;
+}
+
+void replay_window::check (const std::span<const sequence> &sequences, const std::span<verdict> &result) noexcept
+{
+	auto count = (std::min)(sequences.size(), result.size());
+	for (size_t first = 0;  first < count;  first += max_batch_size)
+	{
+		auto batch_size = (std::min)(max_batch_size, count - first);
+
+		uint64_t h[max_batch_size];
+		shard *s[max_batch_size];
+
+		// 1) hash connection IDs
+		for (auto i = 0u;  i < batch_size;  ++i)
+		{
+			h[i] = hash(sequences[first + i].connection_id);
+			s[i] = &shards_[shard_of(h[i])];
+		}
+
+		// 2) prefetch home index entries and their windows
+		__hash_table::prefetch_batch(h, batch_size,
+			[&](size_t i) -> auto & { return s[i]->index; },
+			[&](size_t i, uint32_t slot) { __hash_table::prefetch(&s[i]->entries[slot]); }
+		);
+
+		// 3) probe and update
+		for (auto i = 0u;  i < batch_size;  ++i)
+		{
+			auto &sequence = sequences[first + i];
+			if (auto e = s[i]->find(sequence.connection_id, tag_of(h[i]));  e->tag)
+			{
+				result[first + i] = update(s[i]->entries[e->slot], sequence.sequence_number);
+			}
+			else
+			{
+				result[first + i] = verdict::unknown_connection;
+			}
+		}
+	}
+}
+
+} // namespace turner
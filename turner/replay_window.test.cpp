@@ -0,0 +1,200 @@
+#include <turner/replay_window>
+#include <turner/test>
+#include <map>
+#include <random>
+#include <set>
+#include <vector>
+
+namespace {
+
+using turner::replay_window;
+using verdict = replay_window::verdict;
+
+replay_window::connection_id_type make_id (uint32_t index)
+{
+	// differ only in last bytes: exercises compare of 4B tail
+	replay_window::connection_id_type id{};
+	id.fill(0xa5);
+	std::memcpy(id.data() + 16, &index, sizeof(index));
+	return id;
+}
+
+TEST_CASE("replay_window")
+{
+	auto shard_count = GENERATE(values<size_t>({1, 4}));
+	replay_window table{64, shard_count};
+	CHECK(table.shard_count() == shard_count);
+	CHECK(table.shard_capacity() == 64 / shard_count);
+	CHECK(table.size() == 0);
+
+	auto id = make_id(1);
+
+	SECTION("insert") //{{{1
+	{
+		CHECK(table.insert(id, 100));
+		CHECK(table.size() == 1);
+		CHECK(table.size(table.shard_of(id)) == 1);
+		CHECK(table.contains(id));
+		CHECK_FALSE(table.contains(make_id(2)));
+
+		// existing
+		CHECK_FALSE(table.insert(id, 200));
+		CHECK(table.size() == 1);
+		CHECK(table.check(id, 100) == verdict::replayed);
+	}
+
+	SECTION("erase") //{{{1
+	{
+		CHECK_FALSE(table.erase(id));
+		REQUIRE(table.insert(id, 100));
+		CHECK(table.erase(id));
+		CHECK(table.size() == 0);
+		CHECK_FALSE(table.contains(id));
+		CHECK(table.check(id, 101) == verdict::unknown_connection);
+
+		// reinserted starts new window
+		REQUIRE(table.insert(id, 1));
+		CHECK(table.check(id, 2) == verdict::accepted);
+	}
+
+	SECTION("full") //{{{1
+	{
+		size_t inserted = 0;
+		for (auto i = 0u;  i < 1000;  ++i)
+		{
+			inserted += table.insert(make_id(i), 0);
+		}
+		CHECK(inserted == table.size());
+		CHECK(inserted <= 64);
+		for (auto i = 0u;  i < shard_count;  ++i)
+		{
+			CHECK(table.size(i) == table.shard_capacity());
+		}
+	}
+
+	SECTION("check") //{{{1
+	{
+		REQUIRE(table.insert(id, 100));
+
+		// in order
+		CHECK(table.check(id, 101) == verdict::accepted);
+		CHECK(table.check(id, 101) == verdict::replayed);
+		CHECK(table.check(id, 100) == verdict::replayed);
+
+		// jump ahead, then fill gap
+		CHECK(table.check(id, 110) == verdict::accepted);
+		for (auto n = 102u;  n < 110;  ++n)
+		{
+			CHECK(table.check(id, n) == verdict::accepted);
+			CHECK(table.check(id, n) == verdict::replayed);
+		}
+
+		// window edge
+		CHECK(table.check(id, 110 - replay_window::window_size + 1) == verdict::accepted);
+		CHECK(table.check(id, 110 - replay_window::window_size + 1) == verdict::replayed);
+		CHECK(table.check(id, 110 - replay_window::window_size) == verdict::too_old);
+
+		// jump past window forgets everything below
+		CHECK(table.check(id, 110 + replay_window::window_size) == verdict::accepted);
+		CHECK(table.check(id, 111) == verdict::accepted);
+		CHECK(table.check(id, 110) == verdict::too_old);
+
+		// other connection unaffected
+		CHECK(table.check(make_id(2), 111) == verdict::unknown_connection);
+	}
+
+	SECTION("check: wraparound") //{{{1
+	{
+		REQUIRE(table.insert(id, 0xffff'fffe));
+		CHECK(table.check(id, 0xffff'ffff) == verdict::accepted);
+		CHECK(table.check(id, 0) == verdict::accepted);
+		CHECK(table.check(id, 1) == verdict::accepted);
+		CHECK(table.check(id, 0xffff'ffff) == verdict::replayed);
+		CHECK(table.check(id, 0xffff'fffd) == verdict::accepted);
+
+		// half range behind is old, not ahead
+		CHECK(table.check(id, 0x8000'0001) == verdict::too_old);
+	}
+
+	SECTION("batch check") //{{{1
+	{
+		for (auto i = 0u;  i < 8;  ++i)
+		{
+			REQUIRE(table.insert(make_id(i), 0));
+		}
+
+		// more than max_batch_size, with repeated connections
+		std::vector<replay_window::sequence> sequences;
+		for (auto i = 0u;  i < 40;  ++i)
+		{
+			sequences.push_back({make_id(i % 10), i / 10 + 1});
+		}
+		sequences.push_back({make_id(0), 1});
+
+		std::vector<verdict> result(sequences.size());
+		table.check(sequences, result);
+		for (auto i = 0u;  i < 40;  ++i)
+		{
+			CHECK(result[i] == (i % 10 < 8 ? verdict::accepted : verdict::unknown_connection));
+		}
+		CHECK(result.back() == verdict::replayed);
+	}
+
+	//}}}1
+}
+
+TEST_CASE("replay_window/reference")
+{
+	// random insert/erase/check against naive model: exercises index
+	// backward shift deletion and window arithmetic
+	replay_window table{256, 2};
+	std::map<uint32_t, std::set<uint32_t>> expected;
+	std::mt19937 rng{1};
+
+	auto expected_verdict = [](std::set<uint32_t> &seen, uint32_t n)
+	{
+		auto highest = *seen.rbegin();
+		if (n > highest)
+		{
+			seen.insert(n);
+			return verdict::accepted;
+		}
+		else if (highest - n >= replay_window::window_size)
+		{
+			return verdict::too_old;
+		}
+		return seen.insert(n).second ? verdict::accepted : verdict::replayed;
+	};
+
+	for (auto i = 0u;  i < 200000;  ++i)
+	{
+		auto index = static_cast<uint32_t>(rng() % 192);
+		auto id = make_id(index);
+		auto it = expected.find(index);
+		auto op = rng() % 16;
+
+		if (it == expected.end())
+		{
+			REQUIRE(table.check(id, 1) == verdict::unknown_connection);
+			if (table.insert(id, 1000))
+			{
+				expected[index] = {1000};
+			}
+		}
+		else if (op == 0)
+		{
+			REQUIRE(table.erase(id));
+			expected.erase(it);
+		}
+		else
+		{
+			// mostly near highest, sometimes far ahead
+			auto highest = *it->second.rbegin();
+			auto n = op == 1 ? highest + 100 : highest + 8 - static_cast<uint32_t>(rng() % 80);
+			REQUIRE(table.check(id, n) == expected_verdict(it->second, n));
+		}
+		REQUIRE(table.size() == expected.size());
+	}
+}
+
+} // namespace
@@ -0,0 +1,122 @@
+#include <turner/response_cache>
+#include <turner/bench>
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+using namespace std::chrono_literals;
+using turner::response_cache;
+using turner::endpoint;
+
+using transaction_id_type = std::array<uint8_t, 12>;
+
+constexpr size_t entry_count = 100'000;
+
+struct request
+{
+	transaction_id_type transaction_id;
+	endpoint client;
+};
+
+// Allocate success response size
+const std::array<std::byte, 100> response{};
+
+// cache full of responses, requests of cached responses
+struct fixture
+{
+	response_cache cache{entry_count, 40s};
+	std::vector<request> requests{};
+	response_cache::time_point now{};
+
+	fixture ()
+	{
+		std::mt19937 rng{1};
+		for (auto i = 0u;  i < entry_count;  ++i)
+		{
+			request r;
+			for (auto &b: r.transaction_id)
+			{
+				b = static_cast<uint8_t>(rng());
+			}
+			auto a = rng();
+			r.client = {
+				pal::net::ip::address_v4{{
+					static_cast<uint8_t>(a >> 24),
+					static_cast<uint8_t>(a >> 16),
+					static_cast<uint8_t>(a >> 8),
+					static_cast<uint8_t>(a),
+				}},
+				static_cast<uint16_t>(a >> 7),
+			};
+			cache.insert(r.transaction_id, r.client, response, now);
+			requests.push_back(r);
+		}
+		std::shuffle(requests.begin(), requests.end(), rng);
+	}
+
+	static fixture &instance ()
+	{
+		static fixture f;
+		return f;
+	}
+};
+
+void find_hit (benchmark::State &state)
+{
+	auto &f = fixture::instance();
+	size_t i = 0;
+	for (auto _: state)
+	{
+		auto &r = f.requests[i];
+		benchmark::DoNotOptimize(f.cache.find(r.transaction_id, r.client, f.now));
+		if (++i == f.requests.size())
+		{
+			i = 0;
+		}
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(find_hit);
+
+void find_miss (benchmark::State &state)
+{
+	auto &f = fixture::instance();
+	size_t i = 0;
+	for (auto _: state)
+	{
+		// same client, other transaction
+		auto r = f.requests[i];
+		r.transaction_id[0] ^= 0xff;
+		benchmark::DoNotOptimize(f.cache.find(r.transaction_id, r.client, f.now));
+		if (++i == f.requests.size())
+		{
+			i = 0;
+		}
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(find_miss);
+
+void insert (benchmark::State &state)
+{
+	auto &f = fixture::instance();
+	size_t i = 0;
+	for (auto _: state)
+	{
+		// full cache: each insert evicts oldest
+		auto &r = f.requests[i];
+		benchmark::DoNotOptimize(f.cache.insert(r.transaction_id, r.client, response, f.now));
+		if (++i == f.requests.size())
+		{
+			i = 0;
+		}
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(insert);
+
+} // namespace
@@ -0,0 +1,171 @@
+#include <turner/response_cache>
+#include <algorithm>
+#include <cstring>
+
+namespace turner {
+
+using __hash_table::tag_of;
+
+response_cache::key_type::key_type (const std::span<const uint8_t> &transaction_id, const endpoint &client) noexcept
+{
+	// layout: transaction ID (16B, zero padded), client address (16B),
+	// client port, transaction ID size, address family
+	auto p = reinterpret_cast<std::byte *>(words.data());
+	std::memcpy(p, transaction_id.data(), transaction_id.size());
+	if (client.address.is_v4())
+	{
+		std::memcpy(p + 16, client.address.v4().to_bytes().data(), 4);
+	}
+	else
+	{
+		std::memcpy(p + 16, client.address.v6().to_bytes().data(), 16);
+	}
+
+	uint8_t tail[4] =
+	{
+		static_cast<uint8_t>(client.port >> 8),
+		static_cast<uint8_t>(client.port),
+		static_cast<uint8_t>(transaction_id.size()),
+		static_cast<uint8_t>(client.address.is_v4()),
+	};
+	std::memcpy(p + 32, tail, sizeof(tail));
+}
+
+uint64_t response_cache::hash (const key_type &key) noexcept
+{
+	return __hash_table::hash(key.words);
+}
+
+response_cache::response_cache (size_t capacity, duration ttl, size_t max_response_size_bytes)
+	: capacity_{(std::max)(capacity, size_t{1})}
+	, ttl_{ttl}
+	, max_response_size_bytes_{max_response_size_bytes}
+	, slots_{new slot[capacity_]{}}
+	, arena_{new std::byte[capacity_ * max_response_size_bytes_]}
+	, index_{capacity_}
+{ }
+
+__hash_table::entry *response_cache::find_entry (const key_type &key, uint32_t tag) const noexcept
+{
+	return index_.find(tag, [&](uint32_t slot)
+	{
+		return slots_[slot].key == key;
+	});
+}
+
+std::span<const std::byte> response_cache::find (
+	const std::span<const uint8_t> &transaction_id,
+	const endpoint &client,
+	time_point now) const noexcept
+{
+	if (transaction_id.size() > max_transaction_id_size_bytes)
+	{
+		return {};
+	}
+
+	key_type key{transaction_id, client};
+	if (auto e = find_entry(key, tag_of(hash(key)));  e->tag)
+	{
+		auto &s = slots_[e->slot];
+		if (s.expires > now)
+		{
+			return {arena_.get() + e->slot * max_response_size_bytes_, s.size_bytes};
+		}
+	}
+	return {};
+}
+
+void response_cache::release (size_t slot_index) noexcept
+{
+	auto &s = slots_[slot_index];
+
+	index_.erase(index_.find_slot(tag_of(s.hash), static_cast<uint32_t>(slot_index)));
+
+	s.used = false;
+	size_--;
+}
+
+bool response_cache::insert (
+	const std::span<const uint8_t> &transaction_id,
+	const endpoint &client,
+	const std::span<const std::byte> &response,
+	time_point now) noexcept
+{
+	if (response.size_bytes() > max_response_size_bytes_
+		|| transaction_id.size() > max_transaction_id_size_bytes)
+	{
+		return false;
+	}
+
+	key_type key{transaction_id, client};
+	auto h = hash(key);
+	if (auto e = find_entry(key, tag_of(h));  e->tag)
+	{
+		// replaced entry slot stays in ring until head reaches it
+		release(e->slot);
+	}
+
+	if (used_ == capacity_)
+	{
+		// evict oldest
+		if (slots_[head_].used)
+		{
+			release(head_);
+		}
+		head_ = (head_ + 1) % capacity_;
+		used_--;
+	}
+
+	auto slot_index = (head_ + used_) % capacity_;
+	used_++;
+	size_++;
+
+	auto &s = slots_[slot_index];
+	s.key = key;
+	s.hash = h;
+	s.expires = now + ttl_;
+	s.size_bytes = static_cast<uint32_t>(response.size_bytes());
+	s.used = true;
+	std::memcpy(arena_.get() + slot_index * max_response_size_bytes_, response.data(), response.size_bytes());
+
+	// release() above may have shifted entries: probe again
+	auto e = find_entry(key, tag_of(h));
+	e->tag = tag_of(h);
+	e->slot = static_cast<uint32_t>(slot_index);
+	return true;
+}
+
+size_t response_cache::expire (time_point now) noexcept
+{
+	// entries expire in insertion order: pop from ring head until first
+	// non-expired entry
+	size_t count = 0;
+	while (used_)
+	{
+		auto &s = slots_[head_];
+		if (s.used)
+		{
+			if (s.expires > now)
+			{
+				break;
+			}
+			release(head_);
+			count++;
+		}
+		head_ = (head_ + 1) % capacity_;
+		used_--;
+	}
+	return count;
+}
+
+void response_cache::clear () noexcept
+{
+	for (auto s = slots_.get();  s != slots_.get() + capacity_;  ++s)
+	{
+		s->used = false;
+	}
+	index_.clear();
+	head_ = used_ = size_ = 0;
+}
+
+} // namespace turner
@@ -0,0 +1,227 @@
+#include <turner/response_cache>
+#include <turner/test>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <random>
+#include <string>
+
+namespace {
+
+using namespace std::chrono_literals;
+using turner::response_cache;
+using turner::endpoint;
+
+using stun_id = std::array<uint8_t, 12>;
+using msturn_id = std::array<uint8_t, 16>;
+
+stun_id make_id (uint32_t value)
+{
+	stun_id id{};
+	std::memcpy(id.data(), &value, sizeof(value));
+	return id;
+}
+
+std::span<const std::byte> as_bytes (std::string_view v)
+{
+	return std::as_bytes(std::span{v.data(), v.size()});
+}
+
+std::string_view as_string (const std::span<const std::byte> &v)
+{
+	return {reinterpret_cast<const char *>(v.data()), v.size()};
+}
+
+TEST_CASE("response_cache")
+{
+	response_cache cache{4, 10s, 16};
+	CHECK(cache.capacity() == 4);
+	CHECK(cache.size() == 0);
+	CHECK(cache.ttl() == 10s);
+	CHECK(cache.max_response_size_bytes() == 16);
+
+	response_cache::time_point now{};
+	const endpoint client{pal::net::ip::address_v4{{192, 0, 2, 1}}, 3478};
+	const auto id = make_id(1);
+
+	SECTION("find") //{{{1
+	{
+		CHECK(cache.find(id, client, now).empty());
+		CHECK(cache.insert(id, client, as_bytes("response"), now));
+		CHECK(cache.size() == 1);
+		CHECK(as_string(cache.find(id, client, now)) == "response");
+
+		// different transaction ID, address, port or address family
+		CHECK(cache.find(make_id(2), client, now).empty());
+		CHECK(cache.find(id, {pal::net::ip::address_v4{{192, 0, 2, 2}}, 3478}, now).empty());
+		CHECK(cache.find(id, {client.address, 3479}, now).empty());
+		CHECK(cache.find(id, {pal::net::ip::address_v6{}, 3478}, now).empty());
+	}
+
+	SECTION("transaction ID size") //{{{1
+	{
+		// MS-TURN 16B transaction ID, prefix equal to STUN one
+		msturn_id long_id{};
+		std::copy(id.begin(), id.end(), long_id.begin());
+		CHECK(cache.insert(id, client, as_bytes("stun"), now));
+		CHECK(cache.insert(long_id, client, as_bytes("msturn"), now));
+		CHECK(as_string(cache.find(id, client, now)) == "stun");
+		CHECK(as_string(cache.find(long_id, client, now)) == "msturn");
+
+		std::array<uint8_t, 17> too_long{};
+		CHECK_FALSE(cache.insert(too_long, client, as_bytes("x"), now));
+		CHECK(cache.find(too_long, client, now).empty());
+	}
+
+	SECTION("response too large") //{{{1
+	{
+		CHECK(cache.insert(id, client, as_bytes("0123456789abcdef"), now));
+		CHECK_FALSE(cache.insert(make_id(2), client, as_bytes("0123456789abcdefg"), now));
+		CHECK(cache.size() == 1);
+	}
+
+	SECTION("replace") //{{{1
+	{
+		CHECK(cache.insert(id, client, as_bytes("first"), now));
+		CHECK(cache.insert(id, client, as_bytes("second"), now + 5s));
+		CHECK(cache.size() == 1);
+		CHECK(as_string(cache.find(id, client, now + 12s)) == "second");
+		CHECK(cache.expire(now + 12s) == 0);
+		CHECK(cache.expire(now + 15s) == 1);
+		CHECK(cache.size() == 0);
+	}
+
+	SECTION("ttl") //{{{1
+	{
+		CHECK(cache.insert(make_id(1), client, as_bytes("1"), now));
+		CHECK(cache.insert(make_id(2), client, as_bytes("2"), now + 1s));
+		CHECK(cache.insert(make_id(3), client, as_bytes("3"), now + 2s));
+
+		// expired but not removed entry is not found
+		CHECK(cache.find(make_id(1), client, now + 10s).empty());
+		CHECK(cache.size() == 3);
+
+		CHECK(cache.expire(now + 11s) == 2);
+		CHECK(cache.size() == 1);
+		CHECK(as_string(cache.find(make_id(3), client, now + 11s)) == "3");
+		CHECK(cache.expire(now + 1h) == 1);
+		CHECK(cache.size() == 0);
+	}
+
+	SECTION("evict oldest") //{{{1
+	{
+		for (auto i = 1u;  i <= 6;  ++i)
+		{
+			CHECK(cache.insert(make_id(i), client, as_bytes(std::to_string(i)), now));
+		}
+		CHECK(cache.size() == 4);
+		CHECK(cache.find(make_id(1), client, now).empty());
+		CHECK(cache.find(make_id(2), client, now).empty());
+		for (auto i = 3u;  i <= 6;  ++i)
+		{
+			CHECK(as_string(cache.find(make_id(i), client, now)) == std::to_string(i));
+		}
+	}
+
+	SECTION("clear") //{{{1
+	{
+		CHECK(cache.insert(id, client, as_bytes("response"), now));
+		cache.clear();
+		CHECK(cache.size() == 0);
+		CHECK(cache.find(id, client, now).empty());
+		CHECK(cache.insert(id, client, as_bytes("response"), now));
+		CHECK(cache.size() == 1);
+	}
+
+	//}}}1
+}
+
+TEST_CASE("response_cache: random")
+{
+	// compare against reference: ring of inserted keys in insertion order,
+	// replaced entries keep their ring position until popped
+	constexpr size_t capacity = 64;
+	response_cache cache{capacity, 50s};
+
+	using key_type = std::pair<uint32_t, uint16_t>;
+	struct value_type
+	{
+		int expires;
+		uint32_t value;
+		int order;
+	};
+	std::map<key_type, value_type> reference;
+	std::deque<std::pair<key_type, int>> ring;
+
+	std::mt19937 rng{1};
+	const auto address = pal::net::ip::address_v4{{192, 0, 2, 1}};
+	response_cache::time_point epoch{};
+
+	auto is_live = [&](const std::pair<key_type, int> &it)
+	{
+		auto r = reference.find(it.first);
+		return r != reference.end() && r->second.order == it.second;
+	};
+
+	for (auto t = 0, order = 0;  t < 5000;  ++t)
+	{
+		auto time = t / 10;
+		auto now = epoch + 1s * time;
+		auto id = static_cast<uint32_t>(rng() % 128);
+		auto port = static_cast<uint16_t>(rng() % 2);
+		auto value = static_cast<uint32_t>(rng());
+
+		if (rng() % 3)
+		{
+			REQUIRE(cache.insert(make_id(id), {address, port}, std::as_bytes(std::span{&value, 1}), now));
+			if (ring.size() == capacity)
+			{
+				if (is_live(ring.front()))
+				{
+					reference.erase(ring.front().first);
+				}
+				ring.pop_front();
+			}
+			reference[{id, port}] = {time + 50, value, order};
+			ring.push_back({{id, port}, order});
+			order++;
+		}
+		else
+		{
+			size_t count = 0;
+			while (!ring.empty())
+			{
+				if (is_live(ring.front()))
+				{
+					if (reference[ring.front().first].expires > time)
+					{
+						break;
+					}
+					reference.erase(ring.front().first);
+					count++;
+				}
+				ring.pop_front();
+			}
+			REQUIRE(cache.expire(now) == count);
+		}
+
+		REQUIRE(cache.size() == reference.size());
+		for (auto &[key, v]: reference)
+		{
+			auto response = cache.find(make_id(key.first), {address, key.second}, now);
+			if (v.expires > time)
+			{
+				REQUIRE(response.size_bytes() == sizeof(uint32_t));
+				uint32_t cached;
+				std::memcpy(&cached, response.data(), sizeof(cached));
+				REQUIRE(cached == v.value);
+			}
+			else
+			{
+				REQUIRE(response.empty());
+			}
+		}
+	}
+}
+
+} // namespace
@@ -0,0 +1,176 @@
+#include <turner/server>
+#include <turner/bench>
+#include <array>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace {
+
+using namespace std::chrono_literals;
+using turner::turn;
+using turner::endpoint;
+using turner::five_tuple;
+
+constexpr size_t batch_size = 32;
+constexpr size_t payload_size_bytes = 160;
+constexpr uint16_t channel = 0x4000;
+
+const endpoint listen{pal::net::ip::address_v4{{192, 0, 2, 100}}, 3478};
+const endpoint client{pal::net::ip::address_v4{{198, 51, 100, 1}}, 40000};
+const endpoint peer{pal::net::ip::address_v4{{203, 0, 113, 1}}, 50000};
+const five_tuple client_tuple{client, listen, turner::transport_protocol::udp};
+
+// server with single allocation, peer bound to channel (optionally)
+struct fixture: turner::server_hooks
+{
+	turner::port_pool pool{50000, 50099};
+	turner::credential_cache credentials{16};
+	std::array<std::byte, 32> secret{};
+	std::unique_ptr<turner::server> server{};
+	endpoint relayed{};
+	turn::transaction_id_type transaction_id{};
+
+	std::array<std::array<std::byte, 2048>, batch_size> rx{};
+	std::array<std::array<std::byte, turner::server::max_response_size_bytes>, batch_size> tx{};
+	std::array<turner::inbound_datagram, batch_size> in{};
+	std::array<turner::outbound_datagram, batch_size> out{};
+
+	fixture (bool bind_channel)
+	{
+		turner::server::options options;
+		options.realm = "example.com";
+		options.nonce_secret = secret;
+		options.relay_address_v4 = listen.address;
+		options.first_port = pool.first();
+		options.last_port = pool.last();
+		server = std::make_unique<turner::server>(options, *this, credentials);
+
+		auto nonce = std::string{*request(turn::allocate, [](auto &) { }).read(turn::nonce)};
+		auto key = turner::long_term_key::make(turner::password_algorithm::md5, "user", options.realm, "pass");
+		auto sign = [&](auto &writer)
+		{
+			writer
+				.write(turn::username, "user")
+				.write(turn::realm, options.realm)
+				.write(turn::nonce, nonce)
+				.add_integrity(turn::message_integrity, key.sha1)
+			;
+		};
+
+		auto allocated = request(turn::allocate, [&](auto &writer)
+		{
+			writer.write(turn::requested_transport, turner::transport_protocol::udp);
+			sign(writer);
+		});
+		auto address = allocated.read(turn::xor_relayed_address).value();
+		relayed = {address.address, address.port};
+
+		request(turn::create_permission, [&](auto &writer)
+		{
+			writer.write(turn::xor_peer_address, {peer.address, peer.port});
+			sign(writer);
+		});
+		if (bind_channel)
+		{
+			request(turn::channel_bind, [&](auto &writer)
+			{
+				writer
+					.write(turn::channel_number, channel)
+					.write(turn::xor_peer_address, {peer.address, peer.port})
+				;
+				sign(writer);
+			});
+		}
+	}
+
+	template <typename Message, typename Write>
+	turn::message_reader request (Message message, Write write)
+	{
+		// each request is new transaction
+		transaction_id[0]++;
+		turn::message_writer writer{rx[0], message, transaction_id};
+		write(writer);
+		in[0] = {rx[0], 0, writer.finish().value().size(), client_tuple};
+		out[0].buffer = tx[0];
+		server->process(std::span{in}.first(1), std::span{out}.first(1));
+		return turn::read_message(out[0].data).value();
+	}
+
+	std::optional<std::string_view> get_password (std::string_view, std::string_view) final
+	{
+		return "pass";
+	}
+
+	std::optional<relay_port> allocate_port (const port_request &) final
+	{
+		return relay_port{*pool.allocate()};
+	}
+
+	void release_port (const endpoint &e) noexcept final
+	{
+		pool.release(e.port);
+	}
+};
+
+// batch of peer datagrams framed as ChannelData or Data indication to client
+void peer_to_client (benchmark::State &state, bool bind_channel)
+{
+	fixture f{bind_channel};
+	for (auto i = 0u;  i < batch_size;  ++i)
+	{
+		f.in[i] = {f.rx[i], turn::data_indication_headroom_bytes, payload_size_bytes, {peer, f.relayed}};
+		f.out[i].buffer = f.tx[i];
+	}
+
+	for (auto _: state)
+	{
+		benchmark::DoNotOptimize(f.server->process(f.in, f.out));
+	}
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * batch_size));
+	state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * batch_size * payload_size_bytes));
+}
+BENCHMARK_CAPTURE(peer_to_client, channel_data, true);
+BENCHMARK_CAPTURE(peer_to_client, data_indication, false);
+
+// batch of client ChannelData relayed to peer
+void client_to_peer (benchmark::State &state)
+{
+	fixture f{true};
+	for (auto i = 0u;  i < batch_size;  ++i)
+	{
+		auto message = turn::wrap_channel_data(f.rx[i], 4, payload_size_bytes, channel).value();
+		f.in[i] = {f.rx[i], 0, message.size(), client_tuple};
+		f.out[i].buffer = f.tx[i];
+	}
+
+	for (auto _: state)
+	{
+		benchmark::DoNotOptimize(f.server->process(f.in, f.out));
+	}
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * batch_size));
+	state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * batch_size * payload_size_bytes));
+}
+BENCHMARK(client_to_peer);
+
+// batch of Binding requests
+void binding (benchmark::State &state)
+{
+	fixture f{false};
+	auto message = turner_bench::make_message<turn>(turn::binding, [](auto &) { });
+	for (auto i = 0u;  i < batch_size;  ++i)
+	{
+		std::memcpy(f.rx[i].data(), message.data(), message.size());
+		f.in[i] = {f.rx[i], 0, message.size(), client_tuple};
+		f.out[i].buffer = f.tx[i];
+	}
+
+	for (auto _: state)
+	{
+		benchmark::DoNotOptimize(f.server->process(f.in, f.out));
+	}
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * batch_size));
+}
+BENCHMARK(binding);
+
+} // namespace
@@ -0,0 +1,739 @@
+#include <turner/server>
+#include <turner/demux>
+#include <turner/__hash_table>
+#include <algorithm>
+#include <cstring>
+#include <random>
+
+namespace turner {
+
+namespace {
+
+using __hash_table::mix;
+
+uint64_t hash (uint64_t h, std::string_view s) noexcept
+{
+	for (/**/;  s.size() >= sizeof(uint64_t);  s.remove_prefix(sizeof(uint64_t)))
+	{
+		uint64_t v;
+		std::memcpy(&v, s.data(), sizeof(v));
+		h = mix(h, v);
+	}
+	uint64_t v = 0;
+	std::memcpy(&v, s.data(), s.size());
+	return mix(h, v ^ (uint64_t{s.size()} << 56));
+}
+
+constexpr std::string_view reason (protocol_errc ec) noexcept
+{
+	switch (ec)
+	{
+		#define __turner_errc_impl(value, symbol, message) case turner::protocol_errc::symbol: return message;
+		__turner_protocol_errc(__turner_errc_impl)
+		#undef __turner_errc_impl
+	}
+	return {};
+}
+
+// comprehension required attributes understood by server, others are
+// rejected with 420 (Unknown Attribute)
+constexpr auto known_attributes = attributes<
+	turn::username,
+	turn::message_integrity,
+	turn::message_integrity_sha256,
+	turn::realm,
+	turn::nonce,
+	turn::xor_mapped_address,
+	turn::channel_number,
+	turn::lifetime,
+	turn::xor_peer_address,
+	turn::data,
+	turn::requested_address_family,
+	turn::even_port,
+	turn::requested_transport,
+	turn::reservation_token
+>;
+
+// CreatePermission may carry multiple XOR-PEER-ADDRESS attributes
+constexpr size_t max_permission_peers = 16;
+
+} // namespace
+
+// allocation expiration timer: timers_ schedules sessions only, expire()
+// callback casts timer back to its session
+struct server::session: turner::timer
+{
+	allocation_table::handle handle{};
+	uint64_t credentials = 0;
+};
+
+struct server::request_context
+{
+	const inbound_datagram &in;
+	const indexed_message_reader<turn> &reader;
+	outbound_datagram &out;
+	time_point now;
+
+	// set after successful authentication: responses are authenticated
+	// with same key and algorithm as request
+	std::optional<long_term_key> key{};
+	bool sha256 = false;
+	uint64_t credentials = 0;
+
+	// allocation for 5-tuple (if any)
+	allocation *current_allocation = nullptr;
+	server::session *current_session = nullptr;
+};
+
+server::server (const options &options, server_hooks &hooks, credential_cache &credentials)
+	: options_{options}
+	, hooks_{hooks}
+	, credentials_{credentials}
+	, nonce_{options_.nonce_secret, options_.nonce_lifetime}
+	, allocations_{options_.capacity}
+	, responses_{options_.response_cache_capacity, std::chrono::seconds{40}, max_response_size_bytes}
+	, timers_{std::chrono::seconds{1}, clock_type{&hooks_}}
+	, port_count_{size_t{(std::max)(options_.first_port, options_.last_port)} - options_.first_port + 1}
+	, sessions_{new session[2 * port_count_]}
+{
+	// secret is not kept
+	options_.nonce_secret = {};
+
+	std::random_device device;
+	for (auto &b: next_transaction_id_)
+	{
+		b = static_cast<uint8_t>(device());
+	}
+}
+
+server::~server () noexcept
+{
+	for (auto s = sessions_.get();  s != sessions_.get() + 2 * port_count_;  ++s)
+	{
+		release(*s);
+	}
+}
+
+server::session *server::session_slot (const endpoint &relayed) noexcept
+{
+	if (relayed.port < options_.first_port || relayed.port > options_.last_port)
+	{
+		return nullptr;
+	}
+	return &sessions_[relayed.port - options_.first_port + (relayed.address.is_v4() ? 0 : port_count_)];
+}
+
+server::session *server::find_session (const endpoint &relayed) noexcept
+{
+	if (auto s = session_slot(relayed))
+	{
+		if (auto a = allocations_.get(s->handle);  a && a->relayed == relayed)
+		{
+			return s;
+		}
+	}
+	return nullptr;
+}
+
+void server::release (session &s) noexcept
+{
+	if (auto a = allocations_.get(s.handle))
+	{
+		hooks_.release_port(a->relayed);
+		allocations_.erase(s.handle);
+	}
+	timers_.cancel(s);
+	s.handle = {};
+}
+
+size_t server::expire (time_point now) noexcept
+{
+	responses_.expire(now);
+	return timers_.advance(now, [this](timer &t)
+	{
+		release(static_cast<session &>(t));
+		stats_.expired++;
+	});
+}
+
+size_t server::process (const std::span<const inbound_datagram> &in, const std::span<outbound_datagram> &out)
+{
+	auto now = hooks_.now();
+	expire(now);
+
+	size_t count = 0;
+	for (size_t i = 0, size = (std::min)(in.size(), out.size());  i < size;  ++i)
+	{
+		if (process(in[i], out[count], now))
+		{
+			count++;
+		}
+	}
+	return count;
+}
+
+bool server::process (const inbound_datagram &in, outbound_datagram &out, time_point now)
+{
+	if (auto s = find_session(in.tuple.server))
+	{
+		return relay_to_client(*s, in, out, now);
+	}
+
+	auto packet = demux(in.data());
+	if (!packet)
+	{
+		stats_.dropped++;
+		return false;
+	}
+
+	if (auto channel_data = std::get_if<turn::channel_data_reader>(&*packet))
+	{
+		return channel_data_to_peer(in, *channel_data, out, now);
+	}
+	else if (auto message = std::get_if<turn::message_reader>(&*packet))
+	{
+		if (message->expect(turn::send_indication))
+		{
+			return send_indication_to_peer(in, *message, out, now);
+		}
+		return handle_request(in, *message, out, now);
+	}
+
+	// MS-TURN (not supported, see class doc), DTLS, RTP etc.
+	stats_.dropped++;
+	return false;
+}
+
+//
+// Relaying
+//
+
+bool server::relay_to_client (const session &s, const inbound_datagram &in, outbound_datagram &out, time_point now) noexcept
+{
+	auto a = allocations_.get(s.handle);
+	const auto &peer = in.tuple.client;
+	if (!a->peers.has_permission(peer.address, now))
+	{
+		stats_.dropped++;
+		return false;
+	}
+
+	pal::result<std::span<const std::byte>> message;
+	if (auto channel = a->peers.find_channel(peer, now))
+	{
+		message = turn::wrap_channel_data(
+			in.buffer,
+			in.offset,
+			in.size_bytes,
+			channel,
+			a->five_tuple.transport != transport_protocol::udp
+		);
+	}
+	else
+	{
+		// transaction ID of indication is not used for matching, counter
+		// from random start is sufficient
+		for (auto &b: next_transaction_id_)
+		{
+			if (++b != 0)
+			{
+				break;
+			}
+		}
+		message = turn::wrap_data_indication(
+			in.buffer,
+			in.offset,
+			in.size_bytes,
+			{peer.address, peer.port},
+			next_transaction_id_
+		);
+	}
+
+	if (!message)
+	{
+		// insufficient headroom/tailroom
+		stats_.dropped++;
+		return false;
+	}
+
+	out.data = *message;
+	out.tuple = a->five_tuple;
+	stats_.to_client++;
+	return true;
+}
+
+bool server::channel_data_to_peer (
+	const inbound_datagram &in,
+	const turn::channel_data_reader &reader,
+	outbound_datagram &out,
+	time_point now) noexcept
+{
+	if (auto a = allocations_.get(allocations_.find(in.tuple)))
+	{
+		auto peer = a->peers.find_peer(reader.channel_number(), now);
+		if (peer && a->peers.has_permission(peer->address, now))
+		{
+			out.data = reader.data();
+			out.tuple = {*peer, a->relayed, transport_protocol::udp};
+			stats_.to_peer++;
+			return true;
+		}
+	}
+	stats_.dropped++;
+	return false;
+}
+
+bool server::send_indication_to_peer (
+	const inbound_datagram &in,
+	const turn::message_reader &reader,
+	outbound_datagram &out,
+	time_point now) noexcept
+{
+	if (auto a = allocations_.get(allocations_.find(in.tuple)))
+	{
+		auto peer = reader.read(turn::xor_peer_address);
+		auto payload = reader.read(turn::data);
+		if (peer && payload && a->peers.has_permission(peer->address, now))
+		{
+			out.data = *payload;
+			out.tuple = {{peer->address, peer->port}, a->relayed, transport_protocol::udp};
+			stats_.to_peer++;
+			return true;
+		}
+	}
+	stats_.dropped++;
+	return false;
+}
+
+//
+// Requests
+//
+
+bool server::handle_request (
+	const inbound_datagram &in,
+	const turn::message_reader &message,
+	outbound_datagram &out,
+	time_point now)
+{
+	if (message.expect(turn::binding))
+	{
+		stats_.requests++;
+		turn::message_writer writer{out.buffer, turn::binding.success, message.transaction_id()};
+		writer.write(turn::xor_mapped_address, {in.tuple.client.address, in.tuple.client.port});
+		if (message.read(turn::fingerprint))
+		{
+			writer.add_fingerprint();
+		}
+		if (auto response = writer.finish())
+		{
+			out.data = *response;
+			out.tuple = in.tuple;
+			return true;
+		}
+		return false;
+	}
+
+	// retransmission: respond with same response without processing
+	auto transaction_id = std::span<const uint8_t>{message.transaction_id()};
+	if (auto cached = responses_.find(transaction_id, in.tuple.client, now);  !cached.empty())
+	{
+		if (cached.size_bytes() > out.buffer.size_bytes())
+		{
+			return false;
+		}
+		std::memcpy(out.buffer.data(), cached.data(), cached.size_bytes());
+		out.data = out.buffer.first(cached.size_bytes());
+		out.tuple = in.tuple;
+		stats_.retransmissions++;
+		return true;
+	}
+
+	auto reader = message.indexed();
+	request_context context{in, reader, out, now};
+	out.data = {};
+
+	if (reader.expect(turn::allocate))
+	{
+		if (authenticate(context, turn::allocate))
+		{
+			allocate(context);
+		}
+	}
+	else if (reader.expect(turn::refresh))
+	{
+		if (authenticate(context, turn::refresh))
+		{
+			refresh(context);
+		}
+	}
+	else if (reader.expect(turn::create_permission))
+	{
+		if (authenticate(context, turn::create_permission))
+		{
+			create_permission(context);
+		}
+	}
+	else if (reader.expect(turn::channel_bind))
+	{
+		if (authenticate(context, turn::channel_bind))
+		{
+			channel_bind(context);
+		}
+	}
+	else
+	{
+		// unknown request or unexpected indication/response
+		stats_.dropped++;
+		return false;
+	}
+	stats_.requests++;
+
+	// response (success or error) is composed into out.buffer
+	if (!out.data.empty())
+	{
+		responses_.insert(transaction_id, in.tuple.client, out.data, now);
+		return true;
+	}
+	return false;
+}
+
+bool server::respond (request_context &context, turn::message_writer &writer) noexcept
+{
+	if (context.key)
+	{
+		if (context.sha256)
+		{
+			writer.add_integrity(turn::message_integrity_sha256, context.key->sha256);
+		}
+		else
+		{
+			writer.add_integrity(turn::message_integrity, context.key->sha1);
+		}
+	}
+	if (context.reader.read(turn::fingerprint))
+	{
+		writer.add_fingerprint();
+	}
+
+	if (auto response = writer.finish())
+	{
+		context.out.data = *response;
+		context.out.tuple = context.in.tuple;
+		return true;
+	}
+	context.out.data = {};
+	return false;
+}
+
+template <typename Request>
+bool server::respond_error (request_context &context, Request request, protocol_errc code, const std::span<const uint16_t> &unknown)
+{
+	stats_.errors++;
+
+	turn::message_writer writer{context.out.buffer, request.error, context.reader.transaction_id()};
+	writer.write(turn::error_code, {code, reason(code)});
+
+	if (code == protocol_errc::unauthorized || code == protocol_errc::stale_nonce)
+	{
+		stateless_nonce::value_type nonce;
+		writer.write(turn::realm, options_.realm);
+		writer.write(turn::nonce, nonce_.make(nonce, context.in.tuple.client.address, hooks_.wall_now()));
+	}
+	else if (code == protocol_errc::unknown_attribute)
+	{
+		attribute_list_value_type::native_value_type list{unknown.size(), {}};
+		std::copy_n(unknown.begin(), (std::min)(unknown.size(), list.list.size()), list.list.begin());
+		writer.write(turn::unknown_attributes, list);
+	}
+
+	// request is not processed further
+	respond(context, writer);
+	return false;
+}
+
+template <typename Request>
+bool server::authenticate (request_context &context, Request request)
+{
+	const auto &reader = context.reader;
+
+	std::array<uint16_t, 4> unknown;
+	if (auto count = reader.not_read(std::span{unknown}, known_attributes.any_comprehension_required()))
+	{
+		return respond_error(context, request, protocol_errc::unknown_attribute, std::span{unknown}.first((std::min)(count, unknown.size())));
+	}
+
+	// long-term credentials
+	auto sha256 = reader.read(turn::message_integrity_sha256).has_value();
+	if (!sha256 && !reader.read(turn::message_integrity))
+	{
+		return respond_error(context, request, protocol_errc::unauthorized);
+	}
+
+	auto [username, realm, nonce] = reader.read(attributes<turn::username, turn::realm, turn::nonce>);
+	if (!username || !realm || !nonce)
+	{
+		return respond_error(context, request, protocol_errc::bad_request);
+	}
+	else if (nonce_.validate(*nonce, context.in.tuple.client.address, hooks_.wall_now()))
+	{
+		return respond_error(context, request, protocol_errc::stale_nonce);
+	}
+	else if (*realm != options_.realm)
+	{
+		return respond_error(context, request, protocol_errc::unauthorized);
+	}
+
+	auto key = credentials_.find_or_insert(*username, *realm, [this](std::string_view u, std::string_view r)
+	{
+		return hooks_.get_password(u, r);
+	});
+	if (!key)
+	{
+		return respond_error(context, request, protocol_errc::unauthorized);
+	}
+
+	auto error = sha256
+		? reader.verify_integrity(turn::message_integrity_sha256, key->sha256)
+		: reader.verify_integrity(turn::message_integrity, key->sha1)
+	;
+	if (error)
+	{
+		return respond_error(context, request, protocol_errc::unauthorized);
+	}
+
+	context.key = *key;
+	context.sha256 = sha256;
+	context.credentials = hash(hash(0, *username), *realm);
+
+	// allocation for 5-tuple must be created with same credentials
+	context.current_allocation = allocations_.get(allocations_.find(context.in.tuple));
+	if (context.current_allocation)
+	{
+		context.current_session = find_session(context.current_allocation->relayed);
+		if (context.current_session->credentials != context.credentials)
+		{
+			return respond_error(context, request, protocol_errc::wrong_credentials);
+		}
+	}
+
+	return true;
+}
+
+std::chrono::seconds server::lifetime (const request_context &context) const noexcept
+{
+	auto requested = context.reader.read(turn::lifetime).value_or(options_.default_lifetime);
+	if (requested == std::chrono::seconds::zero())
+	{
+		return requested;
+	}
+	return std::clamp(requested, options_.default_lifetime, options_.max_lifetime);
+}
+
+bool server::allocate (request_context &context)
+{
+	const auto &reader = context.reader;
+	const auto &tuple = context.in.tuple;
+	auto request = turn::allocate;
+
+	if (context.current_allocation)
+	{
+		// retransmissions are answered from response cache
+		return respond_error(context, request, protocol_errc::allocation_mismatch);
+	}
+
+	auto transport = reader.read(turn::requested_transport);
+	if (!transport)
+	{
+		return respond_error(context, request, protocol_errc::bad_request);
+	}
+	else if (*transport != transport_protocol::udp)
+	{
+		return respond_error(context, request, protocol_errc::unsupported_transport_protocol);
+	}
+
+	auto [family, even_port, token] = reader.read(attributes<
+		turn::requested_address_family,
+		turn::even_port,
+		turn::reservation_token
+	>);
+	auto present = [](const auto &attribute)
+	{
+		return attribute || attribute.error() != errc::attribute_not_found;
+	};
+	if ((present(family) && !family)
+		|| (present(even_port) && !even_port)
+		|| (present(token) && !token)
+		|| (token && (even_port || family)))
+	{
+		return respond_error(context, request, protocol_errc::bad_request);
+	}
+
+	auto relay_family = family.value_or(address_family::v4);
+	const auto &relay_address = relay_family == address_family::v4
+		? options_.relay_address_v4
+		: options_.relay_address_v6
+	;
+	if (!relay_address)
+	{
+		return respond_error(context, request, protocol_errc::unsupported_address_family);
+	}
+
+	auto [handle, inserted] = allocations_.try_emplace(tuple);
+	if (!inserted)
+	{
+		return respond_error(context, request, protocol_errc::insufficient_capacity);
+	}
+
+	server_hooks::port_request port_request
+	{
+		.tuple = tuple,
+		.family = relay_family,
+		.even_port = even_port.has_value(),
+		.reserve_next = even_port.value_or(false),
+		.reservation_token = std::nullopt,
+	};
+	if (token)
+	{
+		port_request.reservation_token.emplace();
+		std::copy(token->begin(), token->end(), port_request.reservation_token->begin());
+	}
+
+	auto port = hooks_.allocate_port(port_request);
+	if (!port)
+	{
+		allocations_.erase(handle);
+		return respond_error(context, request, protocol_errc::insufficient_capacity);
+	}
+
+	endpoint relayed{*relay_address, port->port};
+	auto a = allocations_.get(handle);
+	a->relayed = relayed;
+	auto s = session_slot(relayed);
+	if (!s || allocations_.get(s->handle))
+	{
+		// port out of range or already in use: host error
+		hooks_.release_port(relayed);
+		allocations_.erase(handle);
+		return respond_error(context, request, protocol_errc::server_error);
+	}
+
+	auto allocation_lifetime = (std::max)(lifetime(context), options_.default_lifetime);
+	a->expires = context.now + allocation_lifetime;
+	s->handle = handle;
+	s->credentials = context.credentials;
+	timers_.start(*s, a->expires);
+	stats_.allocations++;
+
+	turn::message_writer writer{context.out.buffer, request.success, reader.transaction_id()};
+	writer
+		.write(turn::xor_relayed_address, {relayed.address, relayed.port})
+		.write(turn::lifetime, allocation_lifetime)
+		.write(turn::xor_mapped_address, {tuple.client.address, tuple.client.port})
+	;
+	if (port->reservation_token)
+	{
+		writer.write(turn::reservation_token, std::span<const std::byte, 8>{*port->reservation_token});
+	}
+	return respond(context, writer);
+}
+
+bool server::refresh (request_context &context)
+{
+	auto request = turn::refresh;
+	if (!context.current_allocation)
+	{
+		return respond_error(context, request, protocol_errc::allocation_mismatch);
+	}
+
+	auto a = context.current_allocation;
+	auto s = context.current_session;
+	auto allocation_lifetime = lifetime(context);
+	if (allocation_lifetime == std::chrono::seconds::zero())
+	{
+		release(*s);
+	}
+	else
+	{
+		a->expires = context.now + allocation_lifetime;
+		a->peers.expire(context.now);
+		timers_.start(*s, a->expires);
+	}
+
+	turn::message_writer writer{context.out.buffer, request.success, context.reader.transaction_id()};
+	writer.write(turn::lifetime, allocation_lifetime);
+	return respond(context, writer);
+}
+
+bool server::create_permission (request_context &context)
+{
+	auto request = turn::create_permission;
+	if (!context.current_allocation)
+	{
+		return respond_error(context, request, protocol_errc::allocation_mismatch);
+	}
+
+	auto a = context.current_allocation;
+	std::array<pal::net::ip::address, max_permission_peers> peers;
+	size_t peer_count = 0;
+	auto error = protocol_errc::bad_request;
+	auto valid = true;
+	context.reader.visit(attributes<turn::xor_peer_address>, [&](auto, const auto &peer)
+	{
+		if (!peer || peer_count == peers.size())
+		{
+			valid = false;
+		}
+		else if (peer->address.is_v4() != a->relayed.address.is_v4())
+		{
+			error = protocol_errc::peer_address_family_mismatch;
+			valid = false;
+		}
+		else
+		{
+			peers[peer_count++] = peer->address;
+		}
+	});
+	if (!valid || peer_count == 0)
+	{
+		return respond_error(context, request, error);
+	}
+
+	// all or nothing: permissions are installed only if all peers are valid
+	for (auto i = 0u;  i < peer_count;  ++i)
+	{
+		a->peers.add_permission(peers[i], context.now + options_.permission_lifetime);
+	}
+
+	turn::message_writer writer{context.out.buffer, request.success, context.reader.transaction_id()};
+	return respond(context, writer);
+}
+
+bool server::channel_bind (request_context &context)
+{
+	auto request = turn::channel_bind;
+	if (!context.current_allocation)
+	{
+		return respond_error(context, request, protocol_errc::allocation_mismatch);
+	}
+
+	auto a = context.current_allocation;
+	auto [number, peer] = context.reader.read(attributes<turn::channel_number, turn::xor_peer_address>);
+	if (!number || !peer)
+	{
+		return respond_error(context, request, protocol_errc::bad_request);
+	}
+	else if (peer->address.is_v4() != a->relayed.address.is_v4())
+	{
+		return respond_error(context, request, protocol_errc::peer_address_family_mismatch);
+	}
+	else if (!a->peers.bind_channel(*number, {peer->address, peer->port}, context.now + options_.channel_lifetime))
+	{
+		return respond_error(context, request, protocol_errc::bad_request);
+	}
+	a->peers.add_permission(peer->address, context.now + options_.permission_lifetime);
+
+	turn::message_writer writer{context.out.buffer, request.success, context.reader.transaction_id()};
+	return respond(context, writer);
+}
+
+} // namespace turner
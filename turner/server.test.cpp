@@ -0,0 +1,727 @@
+#include <turner/server>
+#include <turner/msturn>
+#include <turner/test>
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace std::chrono_literals;
+using namespace turner_test;
+using turner::turn;
+using turner::msturn;
+using turner::endpoint;
+using turner::five_tuple;
+using turner::protocol_errc;
+
+constexpr std::string_view realm = "example.com";
+constexpr std::string_view username = "user";
+constexpr std::string_view password = "pass";
+const auto secret = "secret"_b;
+
+const pal::net::ip::address relay_address = pal::net::ip::address_v4{{192, 0, 2, 100}};
+const endpoint listen{pal::net::ip::address_v4{{192, 0, 2, 100}}, 3478};
+const endpoint client{pal::net::ip::address_v4{{198, 51, 100, 1}}, 40000};
+const endpoint peer{pal::net::ip::address_v4{{203, 0, 113, 1}}, 50000};
+const five_tuple client_tuple{client, listen, turner::transport_protocol::udp};
+
+turner::server::options make_options ()
+{
+	turner::server::options options;
+	options.realm = realm;
+	options.nonce_secret = secret;
+	options.relay_address_v4 = relay_address;
+	options.first_port = 50000;
+	options.last_port = 50099;
+	options.capacity = 4;
+	options.response_cache_capacity = 16;
+	return options;
+}
+
+struct fixture: turner::server_hooks
+{
+	time_point steady{};
+	turner::stateless_nonce::time_point wall{1'700'000'000s};
+	turner::port_pool pool{50000, 50099};
+	std::vector<endpoint> released{};
+	bool fail_port = false;
+
+	turner::credential_cache credentials{16};
+	turner::server server{make_options(), *this, credentials};
+
+	turn::transaction_id_type transaction_id{};
+	std::array<std::byte, 2048> rx{}, tx{};
+	std::string nonce{};
+
+	time_point now () noexcept final
+	{
+		return steady;
+	}
+
+	turner::stateless_nonce::time_point wall_now () noexcept final
+	{
+		return wall;
+	}
+
+	std::optional<std::string_view> get_password (std::string_view u, std::string_view r) final
+	{
+		if (u == username && r == realm)
+		{
+			return password;
+		}
+		return std::nullopt;
+	}
+
+	std::optional<relay_port> allocate_port (const port_request &request) final
+	{
+		if (fail_port)
+		{
+			return std::nullopt;
+		}
+		else if (request.reservation_token)
+		{
+			if (auto port = pool.claim(*request.reservation_token, steady))
+			{
+				return relay_port{*port};
+			}
+		}
+		else if (request.reserve_next)
+		{
+			if (auto pair = pool.allocate_pair(steady + 30s))
+			{
+				return relay_port{pair->first, pair->second};
+			}
+		}
+		else if (request.even_port)
+		{
+			if (auto port = pool.allocate_even())
+			{
+				return relay_port{*port};
+			}
+		}
+		else if (auto port = pool.allocate())
+		{
+			return relay_port{*port};
+		}
+		return std::nullopt;
+	}
+
+	void release_port (const endpoint &relayed) noexcept final
+	{
+		pool.release(relayed.port);
+		released.push_back(relayed);
+	}
+
+	// new request
+	template <typename Message>
+	turn::message_writer request (Message message)
+	{
+		transaction_id[0]++;
+		return {tx, message, transaction_id};
+	}
+
+	// add long-term credentials to request
+	std::span<const std::byte> sign (turn::message_writer &writer, bool sha256 = false)
+	{
+		auto key = turner::long_term_key::make(turner::password_algorithm::md5, username, realm, password);
+		writer
+			.write(turn::username, username)
+			.write(turn::realm, realm)
+			.write(turn::nonce, nonce)
+		;
+		if (sha256)
+		{
+			writer.add_integrity(turn::message_integrity_sha256, key.sha256);
+		}
+		else
+		{
+			writer.add_integrity(turn::message_integrity, key.sha1);
+		}
+		return *writer.finish();
+	}
+
+	// process single datagram received on tuple
+	std::optional<turner::outbound_datagram> receive (const std::span<const std::byte> &data, const five_tuple &tuple = client_tuple)
+	{
+		constexpr size_t offset = turn::data_indication_headroom_bytes;
+		std::vector<std::byte> copy{data.begin(), data.end()};
+		std::memcpy(rx.data() + offset, copy.data(), copy.size());
+
+		const turner::inbound_datagram in{rx, offset, copy.size(), tuple};
+		std::array<std::byte, turner::server::max_response_size_bytes> buffer;
+		turner::outbound_datagram out{buffer};
+		if (server.process(std::span{&in, 1}, std::span{&out, 1}) == 1)
+		{
+			if (out.data.data() == buffer.data())
+			{
+				// response: keep after return
+				std::memcpy(tx.data(), buffer.data(), out.data.size());
+				out.data = std::span{tx}.first(out.data.size());
+				out.buffer = {};
+			}
+			return out;
+		}
+		return std::nullopt;
+	}
+
+	// process request, returning response reader
+	turn::message_reader response (const std::span<const std::byte> &data)
+	{
+		auto out = receive(data);
+		REQUIRE(out);
+		CHECK(out->tuple.client == client);
+		CHECK(out->tuple.server == listen);
+		auto reader = turn::read_message(out->data);
+		REQUIRE(reader);
+		return *reader;
+	}
+
+	// unauthenticated request for NONCE
+	void challenge ()
+	{
+		auto writer = request(turn::allocate);
+		auto reader = response(*writer.finish());
+		REQUIRE(reader.expect(turn::allocate.error));
+		nonce = *reader.read(turn::nonce);
+	}
+
+	// allocate, returning relayed address
+	endpoint allocate ()
+	{
+		challenge();
+		auto writer = request(turn::allocate);
+		auto reader = response(sign(writer.write(turn::requested_transport, turner::transport_protocol::udp)));
+		REQUIRE(reader.expect(turn::allocate.success));
+		auto relayed = reader.read(turn::xor_relayed_address);
+		REQUIRE(relayed);
+		return {relayed->address, relayed->port};
+	}
+};
+
+protocol_errc error_of (const turn::message_reader &reader)
+{
+	auto error = reader.read(turn::error_code);
+	REQUIRE(error);
+	return error->code;
+}
+
+TEST_CASE("server")
+{
+	fixture f;
+
+	SECTION("binding") //{{{1
+	{
+		auto writer = f.request(turn::binding);
+		auto reader = f.response(*writer.add_fingerprint().finish());
+		CHECK(reader.expect(turn::binding.success));
+		CHECK(reader.transaction_id() == f.transaction_id);
+		CHECK(reader.read(turn::fingerprint));
+
+		auto mapped = reader.read(turn::xor_mapped_address);
+		REQUIRE(mapped);
+		CHECK(mapped->address == client.address);
+		CHECK(mapped->port == client.port);
+	}
+
+	SECTION("allocate") //{{{1
+	{
+		auto relayed = f.allocate();
+		CHECK(relayed.address == relay_address);
+		CHECK(relayed.port >= 50000);
+		CHECK(relayed.port <= 50099);
+		CHECK(f.server.allocation_count() == 1);
+		CHECK(f.server.stats().allocations == 1);
+
+		auto a = f.server.find(client_tuple);
+		REQUIRE(a);
+		CHECK(a->relayed == relayed);
+		CHECK(a->expires == f.steady + 600s);
+	}
+
+	SECTION("retransmission") //{{{1
+	{
+		f.challenge();
+		auto writer = f.request(turn::allocate);
+		auto request = f.sign(writer.write(turn::requested_transport, turner::transport_protocol::udp));
+		std::vector<std::byte> message{request.begin(), request.end()};
+
+		auto reader = f.response(message);
+		REQUIRE(reader.expect(turn::allocate.success));
+		std::vector<std::byte> response{reader.as_bytes().begin(), reader.as_bytes().end()};
+
+		// same response without new allocation
+		auto requests = f.server.stats().requests;
+		reader = f.response(message);
+		CHECK(std::ranges::equal(reader.as_bytes(), response));
+		CHECK(f.server.allocation_count() == 1);
+		CHECK(f.server.stats().requests == requests);
+		CHECK(f.server.stats().retransmissions == 1);
+
+		// new transaction: allocation exists
+		writer = f.request(turn::allocate);
+		reader = f.response(f.sign(writer.write(turn::requested_transport, turner::transport_protocol::udp)));
+		CHECK(error_of(reader) == protocol_errc::allocation_mismatch);
+	}
+
+	SECTION("allocate integrity") //{{{1
+	{
+		auto sha256 = GENERATE(values({false, true}));
+		f.allocate();
+
+		auto writer = f.request(turn::refresh);
+		auto reader = f.response(f.sign(writer, sha256));
+		REQUIRE(reader.expect(turn::refresh.success));
+
+		auto key = turner::long_term_key::make(turner::password_algorithm::md5, username, realm, password);
+		if (sha256)
+		{
+			CHECK_FALSE(reader.verify_integrity(turn::message_integrity_sha256, key.sha256));
+			CHECK_FALSE(reader.read(turn::message_integrity));
+		}
+		else
+		{
+			CHECK_FALSE(reader.verify_integrity(turn::message_integrity, key.sha1));
+			CHECK_FALSE(reader.read(turn::message_integrity_sha256));
+		}
+	}
+
+	SECTION("allocate errors") //{{{1
+	{
+		auto writer = f.request(turn::allocate);
+		auto challenge = f.response(*writer.write(turn::requested_transport, turner::transport_protocol::udp).finish());
+		CHECK(error_of(challenge) == protocol_errc::unauthorized);
+		CHECK(challenge.read(turn::realm) == realm);
+		CHECK_FALSE(challenge.read(turn::message_integrity));
+		f.nonce = *challenge.read(turn::nonce);
+
+		SECTION("stale nonce")
+		{
+			f.wall += 11min;
+			auto reader = f.response(f.sign(writer = f.request(turn::allocate).write(turn::requested_transport, turner::transport_protocol::udp)));
+			CHECK(error_of(reader) == protocol_errc::stale_nonce);
+			CHECK(reader.read(turn::nonce));
+		}
+
+		SECTION("invalid nonce")
+		{
+			f.nonce[0] ^= 1;
+			auto reader = f.response(f.sign(writer = f.request(turn::allocate).write(turn::requested_transport, turner::transport_protocol::udp)));
+			CHECK(error_of(reader) == protocol_errc::stale_nonce);
+		}
+
+		SECTION("wrong password")
+		{
+			writer = f.request(turn::allocate);
+			auto key = turner::long_term_key::make(turner::password_algorithm::md5, username, realm, "wrong");
+			writer
+				.write(turn::requested_transport, turner::transport_protocol::udp)
+				.write(turn::username, username)
+				.write(turn::realm, realm)
+				.write(turn::nonce, f.nonce)
+				.add_integrity(turn::message_integrity, key.sha1)
+			;
+			auto reader = f.response(*writer.finish());
+			CHECK(error_of(reader) == protocol_errc::unauthorized);
+			CHECK_FALSE(reader.read(turn::message_integrity));
+		}
+
+		SECTION("unknown user")
+		{
+			writer = f.request(turn::allocate);
+			auto key = turner::long_term_key::make(turner::password_algorithm::md5, "other", realm, password);
+			writer
+				.write(turn::requested_transport, turner::transport_protocol::udp)
+				.write(turn::username, "other")
+				.write(turn::realm, realm)
+				.write(turn::nonce, f.nonce)
+				.add_integrity(turn::message_integrity, key.sha1)
+			;
+			CHECK(error_of(f.response(*writer.finish())) == protocol_errc::unauthorized);
+		}
+
+		SECTION("missing username")
+		{
+			writer = f.request(turn::allocate);
+			auto key = turner::long_term_key::make(turner::password_algorithm::md5, username, realm, password);
+			writer
+				.write(turn::requested_transport, turner::transport_protocol::udp)
+				.write(turn::realm, realm)
+				.write(turn::nonce, f.nonce)
+				.add_integrity(turn::message_integrity, key.sha1)
+			;
+			CHECK(error_of(f.response(*writer.finish())) == protocol_errc::bad_request);
+		}
+
+		SECTION("missing requested transport")
+		{
+			auto reader = f.response(f.sign(writer = f.request(turn::allocate)));
+			CHECK(error_of(reader) == protocol_errc::bad_request);
+
+			// authenticated error response
+			auto key = turner::long_term_key::make(turner::password_algorithm::md5, username, realm, password);
+			CHECK_FALSE(reader.verify_integrity(turn::message_integrity, key.sha1));
+		}
+
+		SECTION("unsupported transport")
+		{
+			auto reader = f.response(f.sign(writer = f.request(turn::allocate).write(turn::requested_transport, turner::transport_protocol::tcp)));
+			CHECK(error_of(reader) == protocol_errc::unsupported_transport_protocol);
+		}
+
+		SECTION("unsupported address family")
+		{
+			writer = f.request(turn::allocate);
+			writer
+				.write(turn::requested_transport, turner::transport_protocol::udp)
+				.write(turn::requested_address_family, turner::address_family::v6)
+			;
+			CHECK(error_of(f.response(f.sign(writer))) == protocol_errc::unsupported_address_family);
+		}
+
+		SECTION("unknown attribute")
+		{
+			writer = f.request(turn::allocate);
+			writer
+				.write(turn::requested_transport, turner::transport_protocol::udp)
+				.write(turn::dont_fragment, true)
+			;
+			auto reader = f.response(f.sign(writer));
+			CHECK(error_of(reader) == protocol_errc::unknown_attribute);
+			auto unknown = reader.read(turn::unknown_attributes);
+			REQUIRE(unknown);
+			CHECK(unknown->size == 1);
+			CHECK(unknown->list[0] == turn::dont_fragment.type);
+		}
+
+		SECTION("reservation token with even port")
+		{
+			writer = f.request(turn::allocate);
+			std::array<std::byte, 8> token{};
+			writer
+				.write(turn::requested_transport, turner::transport_protocol::udp)
+				.write(turn::even_port, false)
+				.write(turn::reservation_token, token)
+			;
+			CHECK(error_of(f.response(f.sign(writer))) == protocol_errc::bad_request);
+		}
+
+		SECTION("no port")
+		{
+			f.fail_port = true;
+			auto reader = f.response(f.sign(writer = f.request(turn::allocate).write(turn::requested_transport, turner::transport_protocol::udp)));
+			CHECK(error_of(reader) == protocol_errc::insufficient_capacity);
+			CHECK(f.server.allocation_count() == 0);
+		}
+
+		CHECK(f.server.allocation_count() == 0);
+		CHECK(f.server.stats().errors >= 2);
+	}
+
+	SECTION("allocate capacity") //{{{1
+	{
+		f.allocate();
+		for (uint16_t port = 1;  port < 4;  ++port)
+		{
+			auto writer = f.request(turn::allocate);
+			writer.write(turn::requested_transport, turner::transport_protocol::udp);
+			auto out = f.receive(f.sign(writer), {{client.address, static_cast<uint16_t>(client.port + port)}, listen});
+			REQUIRE(out);
+			CHECK(turn::read_message(out->data)->expect(turn::allocate.success));
+		}
+		CHECK(f.server.allocation_count() == 4);
+
+		auto writer = f.request(turn::allocate);
+		writer.write(turn::requested_transport, turner::transport_protocol::udp);
+		auto out = f.receive(f.sign(writer), {{client.address, 1}, listen});
+		REQUIRE(out);
+		CHECK(error_of(*turn::read_message(out->data)) == protocol_errc::insufficient_capacity);
+	}
+
+	SECTION("even port") //{{{1
+	{
+		f.challenge();
+		auto writer = f.request(turn::allocate);
+		writer
+			.write(turn::requested_transport, turner::transport_protocol::udp)
+			.write(turn::even_port, true)
+		;
+		auto reader = f.response(f.sign(writer));
+		REQUIRE(reader.expect(turn::allocate.success));
+		auto relayed = reader.read(turn::xor_relayed_address);
+		REQUIRE(relayed);
+		CHECK(relayed->port % 2 == 0);
+		auto token = reader.read(turn::reservation_token);
+		REQUIRE(token);
+
+		// 2nd client claims reserved port
+		writer = f.request(turn::allocate);
+		writer
+			.write(turn::requested_transport, turner::transport_protocol::udp)
+			.write(turn::reservation_token, *token)
+		;
+		auto out = f.receive(f.sign(writer), {{client.address, 1}, listen});
+		REQUIRE(out);
+		reader = *turn::read_message(out->data);
+		REQUIRE(reader.expect(turn::allocate.success));
+		CHECK(reader.read(turn::xor_relayed_address)->port == relayed->port + 1);
+	}
+
+	SECTION("wrong credentials") //{{{1
+	{
+		f.allocate();
+		f.credentials.insert("other", realm, password);
+
+		auto writer = f.request(turn::refresh);
+		auto key = turner::long_term_key::make(turner::password_algorithm::md5, "other", realm, password);
+		writer
+			.write(turn::username, "other")
+			.write(turn::realm, realm)
+			.write(turn::nonce, f.nonce)
+			.add_integrity(turn::message_integrity, key.sha1)
+		;
+		CHECK(error_of(f.response(*writer.finish())) == protocol_errc::wrong_credentials);
+	}
+
+	SECTION("refresh") //{{{1
+	{
+		auto relayed = f.allocate();
+
+		SECTION("lifetime")
+		{
+			auto lifetime = GENERATE(values({1s, 600s, 1200s, 7200s}));
+			auto writer = f.request(turn::refresh);
+			writer.write(turn::lifetime, lifetime);
+			auto reader = f.response(f.sign(writer));
+			REQUIRE(reader.expect(turn::refresh.success));
+			auto expected = std::clamp<std::chrono::seconds>(lifetime, 600s, 3600s);
+			CHECK(reader.read(turn::lifetime) == expected);
+			CHECK(f.server.find(client_tuple)->expires == f.steady + expected);
+		}
+
+		SECTION("delete")
+		{
+			auto writer = f.request(turn::refresh);
+			writer.write(turn::lifetime, 0s);
+			auto reader = f.response(f.sign(writer));
+			REQUIRE(reader.expect(turn::refresh.success));
+			CHECK(reader.read(turn::lifetime) == 0s);
+			CHECK(f.server.allocation_count() == 0);
+			REQUIRE(f.released.size() == 1);
+			CHECK(f.released[0] == relayed);
+
+			// no allocation
+			writer = f.request(turn::refresh);
+			CHECK(error_of(f.response(f.sign(writer))) == protocol_errc::allocation_mismatch);
+		}
+
+		SECTION("expire")
+		{
+			f.steady += 599s;
+			f.server.expire(f.steady);
+			CHECK(f.server.allocation_count() == 1);
+
+			// refreshed: expires 600s from now
+			auto writer = f.request(turn::refresh);
+			CHECK(f.response(f.sign(writer)).expect(turn::refresh.success));
+			f.steady += 599s;
+			f.server.expire(f.steady);
+			CHECK(f.server.allocation_count() == 1);
+
+			// expired during batch processing
+			f.steady += 2s;
+			writer = f.request(turn::binding);
+			f.response(*writer.finish());
+			CHECK(f.server.allocation_count() == 0);
+			CHECK(f.server.stats().expired == 1);
+			REQUIRE(f.released.size() == 1);
+			CHECK(f.released[0] == relayed);
+		}
+	}
+
+	SECTION("relay") //{{{1
+	{
+		auto relayed = f.allocate();
+		const five_tuple peer_tuple{peer, relayed, turner::transport_protocol::udp};
+		const auto payload = "payload"_b;
+
+		// no permission
+		CHECK_FALSE(f.receive(payload, peer_tuple));
+
+		SECTION("data indication")
+		{
+			auto writer = f.request(turn::create_permission);
+			writer.write(turn::xor_peer_address, {peer.address, 1});
+			REQUIRE(f.response(f.sign(writer)).expect(turn::create_permission.success));
+			CHECK(f.server.find(client_tuple)->peers.permission_count() == 1);
+
+			// peer to client: framed in receive buffer
+			auto out = f.receive(payload, peer_tuple);
+			REQUIRE(out);
+			CHECK(out->tuple.client == client);
+			CHECK(out->tuple.server == listen);
+			CHECK(out->data.data() >= f.rx.data());
+			CHECK(out->data.data() < f.rx.data() + f.rx.size());
+			auto indication = turn::read_message(out->data);
+			REQUIRE(indication);
+			CHECK(indication->expect(turn::data_indication));
+			CHECK(indication->read(turn::xor_peer_address)->port == peer.port);
+			auto data = indication->read(turn::data);
+			REQUIRE(data);
+			CHECK(std::equal(data->begin(), data->end(), payload.begin(), payload.end()));
+
+			// client to peer
+			std::array<uint8_t, 12> id{};
+			turn::message_writer send{f.tx, turn::send_indication, id};
+			send.write(turn::xor_peer_address, {peer.address, peer.port});
+			std::memcpy(send.append(turn::data.type, payload.size()).data(), payload.data(), payload.size());
+			out = f.receive(*send.finish());
+			REQUIRE(out);
+			CHECK(out->tuple.client == peer);
+			CHECK(out->tuple.server == relayed);
+			CHECK(std::equal(out->data.begin(), out->data.end(), payload.begin(), payload.end()));
+			CHECK(f.server.stats().to_peer == 1);
+			CHECK(f.server.stats().to_client == 1);
+
+			// permission expires
+			f.steady += 301s;
+			CHECK_FALSE(f.receive(payload, peer_tuple));
+			CHECK_FALSE(f.receive(*send.finish()));
+		}
+
+		SECTION("channel data")
+		{
+			auto writer = f.request(turn::channel_bind);
+			writer
+				.write(turn::channel_number, 0x4001)
+				.write(turn::xor_peer_address, {peer.address, peer.port})
+			;
+			REQUIRE(f.response(f.sign(writer)).expect(turn::channel_bind.success));
+
+			// peer to client
+			auto out = f.receive(payload, peer_tuple);
+			REQUIRE(out);
+			CHECK(out->tuple.client == client);
+			auto channel_data = turn::read_channel_data(out->data);
+			REQUIRE(channel_data);
+			CHECK(channel_data->channel_number() == 0x4001);
+			auto data = channel_data->data();
+			CHECK(std::equal(data.begin(), data.end(), payload.begin(), payload.end()));
+
+			// client to peer
+			std::array<std::byte, 64> message;
+			auto framed = turn::wrap_channel_data(message, 4, payload.size(), 0x4001);
+			std::memcpy(message.data() + 4, payload.data(), payload.size());
+			out = f.receive(*framed);
+			REQUIRE(out);
+			CHECK(out->tuple.client == peer);
+			CHECK(out->tuple.server == relayed);
+			CHECK(std::equal(out->data.begin(), out->data.end(), payload.begin(), payload.end()));
+
+			// unbound channel
+			framed = turn::wrap_channel_data(message, 4, payload.size(), 0x4002);
+			CHECK_FALSE(f.receive(*framed));
+
+			// other peer to bound channel: rejected
+			writer = f.request(turn::channel_bind);
+			writer
+				.write(turn::channel_number, 0x4001)
+				.write(turn::xor_peer_address, {peer.address, 1})
+			;
+			CHECK(error_of(f.response(f.sign(writer))) == protocol_errc::bad_request);
+		}
+
+		SECTION("peer address family mismatch")
+		{
+			auto writer = f.request(turn::create_permission);
+			writer.write(turn::xor_peer_address, {pal::net::ip::address_v6::loopback(), 1});
+			CHECK(error_of(f.response(f.sign(writer))) == protocol_errc::peer_address_family_mismatch);
+
+			writer = f.request(turn::create_permission);
+			CHECK(error_of(f.response(f.sign(writer))) == protocol_errc::bad_request);
+		}
+
+		CHECK(f.server.stats().dropped >= 1);
+	}
+
+	SECTION("msturn") //{{{1
+	{
+		// not supported: dropped even with TURN allocation and permission
+		// for same client and peer
+		f.allocate();
+		auto writer = f.request(turn::create_permission);
+		writer.write(turn::xor_peer_address, {peer.address, 1});
+		REQUIRE(f.response(f.sign(writer)).expect(turn::create_permission.success));
+		auto stats = f.server.stats();
+
+		std::array<std::byte, 256> buffer;
+		const msturn::transaction_id_type id{1};
+		const msturn::connection_id_type connection_id{1};
+
+		msturn::message_writer allocate{buffer, msturn::allocate, id};
+		CHECK_FALSE(f.receive(*allocate.finish()));
+
+		msturn::message_writer send{buffer, msturn::send_request, id};
+		send
+			.write(msturn::destination_address, peer)
+			.write(msturn::data, "payload"_b)
+			.write(msturn::ms_sequence_number, {connection_id, 1})
+		;
+		CHECK_FALSE(f.receive(*send.finish()));
+
+		msturn::message_writer set_active_destination{buffer, msturn::set_active_destination, id};
+		set_active_destination
+			.write(msturn::destination_address, peer)
+			.write(msturn::ms_sequence_number, {connection_id, 2})
+		;
+		CHECK_FALSE(f.receive(*set_active_destination.finish()));
+
+		CHECK(f.server.allocation_count() == 1);
+		CHECK(f.server.stats().dropped == stats.dropped + 3);
+		CHECK(f.server.stats().requests == stats.requests);
+		CHECK(f.server.stats().errors == stats.errors);
+		CHECK(f.server.stats().to_peer == 0);
+	}
+
+	SECTION("batch") //{{{1
+	{
+		constexpr size_t batch_size = 8;
+		std::array<std::array<std::byte, 128>, batch_size> rx;
+		std::array<std::array<std::byte, 128>, batch_size> tx;
+		std::array<turner::inbound_datagram, batch_size> in;
+		std::array<turner::outbound_datagram, batch_size> out;
+
+		for (auto i = 0u;  i < batch_size;  ++i)
+		{
+			// odd: Binding request, even: garbage
+			auto message = std::span{rx[i]}.subspan(64);
+			size_t size = 4;
+			if (i % 2)
+			{
+				turn::transaction_id_type id{static_cast<uint8_t>(i)};
+				turn::message_writer writer{message, turn::binding, id};
+				size = writer.as_bytes().size();
+			}
+			in[i] = {rx[i], 64, size, {{client.address, static_cast<uint16_t>(i)}, listen}};
+			out[i].buffer = tx[i];
+		}
+
+		CHECK(f.server.process(in, out) == batch_size / 2);
+		for (auto i = 0u;  i < batch_size / 2;  ++i)
+		{
+			auto reader = turn::read_message(out[i].data);
+			REQUIRE(reader);
+			CHECK(reader->expect(turn::binding.success));
+			CHECK(reader->transaction_id()[0] == 2 * i + 1);
+			CHECK(out[i].tuple.client.port == 2 * i + 1);
+		}
+		CHECK(f.server.stats().dropped == batch_size / 2);
+	}
+
+	//}}}1
+}
+
+} // namespace
@@ -0,0 +1,60 @@
+#include <turner/stream_framer>
+#include <turner/turn>
+#include <turner/bench>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+using turner::stream_framer;
+using turner::turn;
+
+// stream of padded ChannelData messages with state.range(0)B payload, read
+// in state.range(1)B chunks
+void channel_data (benchmark::State &state)
+{
+	auto payload_size = static_cast<size_t>(state.range(0));
+	auto chunk_size = static_cast<size_t>(state.range(1));
+
+	std::vector<std::byte> message(4 + payload_size + 3);
+	message.resize(turn::wrap_channel_data(message, 4, payload_size, 0x4000, true).value().size());
+	std::vector<std::byte> stream;
+	while (stream.size() < 64 * 1024)
+	{
+		stream.insert(stream.end(), message.begin(), message.end());
+	}
+
+	stream_framer framer;
+	size_t messages = 0, offset = 0;
+	for (auto _: state)
+	{
+		auto buffer = framer.prepare();
+		auto n = (std::min)({buffer.size(), chunk_size, stream.size() - offset});
+		std::memcpy(buffer.data(), stream.data() + offset, n);
+		framer.commit(n);
+		offset = (offset + n) % stream.size();
+
+		while (true)
+		{
+			auto framed = framer.next();
+			if (framed->empty())
+			{
+				break;
+			}
+			benchmark::DoNotOptimize(framed->data());
+			messages++;
+		}
+	}
+	state.SetItemsProcessed(static_cast<int64_t>(messages));
+	state.SetBytesProcessed(static_cast<int64_t>(messages * message.size()));
+	state.counters["linearized"] = static_cast<double>(framer.linearized()) / static_cast<double>(messages ? messages : 1);
+}
+BENCHMARK(channel_data)
+	->Args({200, 1448})
+	->Args({200, 16384})
+	->Args({1200, 1448})
+	->Args({1200, 16384})
+;
+
+} // namespace
@@ -0,0 +1,94 @@
+#include <turner/stream_framer>
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+namespace turner {
+
+namespace {
+
+constexpr size_t stun_header_size_bytes = 20;
+constexpr size_t channel_data_header_size_bytes = 4;
+constexpr size_t pad_size_bytes = 4;
+
+} // namespace
+
+stream_framer::stream_framer (size_t capacity)
+	: mask_{std::bit_ceil((std::max)(capacity, min_capacity)) - 1}
+	, ring_{new std::byte[2 * (mask_ + 1)]}
+{ }
+
+size_t stream_framer::write (std::span<const std::byte> data) noexcept
+{
+	size_t copied = 0;
+	for (auto buffer = prepare();  !data.empty() && !buffer.empty();  buffer = prepare())
+	{
+		auto n = (std::min)(buffer.size(), data.size());
+		std::memcpy(buffer.data(), data.data(), n);
+		commit(n);
+		data = data.subspan(n);
+		copied += n;
+	}
+	return copied;
+}
+
+pal::result<std::span<const std::byte>> stream_framer::next () noexcept
+{
+	auto available = size();
+	if (available < channel_data_header_size_bytes)
+	{
+		return std::span<const std::byte>{};
+	}
+
+	// first 4 bytes: type/channel + length, possibly wrapped
+	auto offset = head_ & mask_;
+	auto byte_at = [&](size_t i)
+	{
+		return static_cast<uint8_t>(ring_[(offset + i) & mask_]);
+	};
+	auto first = byte_at(0);
+	auto length = size_t{byte_at(2)} << 8 | byte_at(3);
+
+	size_t size_bytes;
+	if (first < 0x40)
+	{
+		if (length % pad_size_bytes != 0)
+		{
+			return make_unexpected(errc::unexpected_message_length);
+		}
+		size_bytes = stun_header_size_bytes + length;
+	}
+	else if (first < 0x80)
+	{
+		size_bytes = channel_data_header_size_bytes + ((length + pad_size_bytes - 1) & ~(pad_size_bytes - 1));
+	}
+	else
+	{
+		return make_unexpected(errc::unexpected_message_type);
+	}
+
+	if (size_bytes > capacity())
+	{
+		return make_unexpected(errc::unexpected_message_length);
+	}
+	else if (available < size_bytes)
+	{
+		return std::span<const std::byte>{};
+	}
+
+	head_ += size_bytes;
+	if (offset + size_bytes <= capacity())
+	{
+		return std::span<const std::byte>{ring_.get() + offset, size_bytes};
+	}
+
+	// straddles ring end: copy both parts into linear buffer after ring
+	auto linear = ring_.get() + capacity();
+	auto head_part = capacity() - offset;
+	std::memcpy(linear, ring_.get() + offset, head_part);
+	std::memcpy(linear + head_part, ring_.get(), size_bytes - head_part);
+	linearized_++;
+	return std::span<const std::byte>{linear, size_bytes};
+}
+
+} // namespace turner
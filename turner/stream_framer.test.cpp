@@ -0,0 +1,206 @@
+#include <turner/stream_framer>
+#include <turner/turn>
+#include <turner/test>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+using turner::stream_framer;
+using turner::turn;
+
+using message_list = std::vector<std::vector<std::byte>>;
+
+std::vector<std::byte> stun_message (size_t index, size_t data_size_bytes)
+{
+	std::array<std::byte, 2048> buffer;
+	turn::transaction_id_type id{static_cast<uint8_t>(index)};
+	turn::message_writer writer{buffer, turn::send_indication, id};
+	std::vector<std::byte> data(data_size_bytes, std::byte(index));
+	writer.write(turn::data, data);
+	auto message = writer.finish().value();
+	return {message.begin(), message.end()};
+}
+
+// ChannelData padded to 4B boundary (stream transport)
+std::vector<std::byte> channel_data (size_t index, size_t data_size_bytes)
+{
+	std::vector<std::byte> buffer(4 + data_size_bytes + 3, std::byte(index));
+	auto message = turn::wrap_channel_data(buffer, 4, data_size_bytes, 0x4000 + index % 0x1000, true).value();
+	return {message.begin(), message.end()};
+}
+
+// mix of both, with sizes not multiple of 4
+message_list make_messages (size_t count)
+{
+	message_list result;
+	for (auto i = 0u;  i < count;  ++i)
+	{
+		auto size = (i * 37) % 700;
+		result.push_back(i % 3 ? channel_data(i, size) : stun_message(i, size));
+	}
+	return result;
+}
+
+std::vector<std::byte> concat (const message_list &messages)
+{
+	std::vector<std::byte> result;
+	for (auto &message: messages)
+	{
+		result.insert(result.end(), message.begin(), message.end());
+	}
+	return result;
+}
+
+// feed stream in \a chunk_size reads, collecting framed messages
+message_list frame (stream_framer &framer, std::span<const std::byte> stream, size_t chunk_size)
+{
+	message_list result;
+	while (!stream.empty())
+	{
+		auto buffer = framer.prepare();
+		REQUIRE_FALSE(buffer.empty());
+		auto n = (std::min)({buffer.size(), chunk_size, stream.size()});
+		std::memcpy(buffer.data(), stream.data(), n);
+		framer.commit(n);
+		stream = stream.subspan(n);
+
+		while (true)
+		{
+			auto message = framer.next();
+			REQUIRE(message);
+			if (message->empty())
+			{
+				break;
+			}
+			result.emplace_back(message->begin(), message->end());
+		}
+	}
+	return result;
+}
+
+TEST_CASE("stream_framer")
+{
+	SECTION("capacity") //{{{1
+	{
+		CHECK(stream_framer{}.capacity() == stream_framer::default_capacity);
+		CHECK(stream_framer{1}.capacity() == stream_framer::min_capacity);
+		CHECK(stream_framer{5000}.capacity() == 8192);
+		CHECK(stream_framer{65536}.capacity() == 65536);
+	}
+
+	SECTION("split reads") //{{{1
+	{
+		auto chunk_size = GENERATE(values<size_t>({1, 3, 4, 19, 20, 21, 100, 1500, 100000}));
+		stream_framer framer{stream_framer::min_capacity};
+		auto messages = make_messages(200);
+		auto stream = concat(messages);
+		REQUIRE(stream.size() > 10 * framer.capacity());
+
+		auto framed = frame(framer, stream, chunk_size);
+		CHECK(framed == messages);
+		CHECK(framer.empty());
+
+		// some messages straddled ring end
+		CHECK(framer.linearized() > 0);
+		CHECK(framer.linearized() < messages.size());
+
+		// each is valid message
+		for (auto &message: framed)
+		{
+			if (static_cast<uint8_t>(message[0]) < 0x40)
+			{
+				CHECK(turn::read_message(message));
+			}
+			else
+			{
+				CHECK(turn::read_channel_data(message));
+			}
+		}
+	}
+
+	SECTION("zero-copy") //{{{1
+	{
+		stream_framer framer;
+		auto message = stun_message(1, 10);
+		CHECK(framer.write(message) == message.size());
+		CHECK(framer.size() == message.size());
+
+		auto buffer_begin = framer.prepare().data() - message.size();
+		auto framed = framer.next();
+		REQUIRE(framed);
+		CHECK(framed->data() == buffer_begin);
+		CHECK(std::ranges::equal(*framed, message));
+		CHECK(framer.empty());
+		CHECK(framer.linearized() == 0);
+	}
+
+	SECTION("incomplete") //{{{1
+	{
+		stream_framer framer;
+		auto message = channel_data(1, 5);
+		REQUIRE(message.size() == 12);
+
+		for (auto i = 0u;  i < message.size() - 1;  ++i)
+		{
+			framer.write(std::span{message}.subspan(i, 1));
+			auto framed = framer.next();
+			REQUIRE(framed);
+			CHECK(framed->empty());
+		}
+		framer.write(std::span{message}.last(1));
+		auto framed = framer.next();
+		REQUIRE(framed);
+		CHECK(std::ranges::equal(*framed, message));
+	}
+
+	SECTION("full") //{{{1
+	{
+		stream_framer framer{stream_framer::min_capacity};
+		std::vector<std::byte> data(framer.capacity() + 1);
+		CHECK(framer.write(data) == framer.capacity());
+		CHECK(framer.prepare().empty());
+		CHECK(framer.write(data) == 0);
+	}
+
+	SECTION("largest message") //{{{1
+	{
+		stream_framer framer{stream_framer::min_capacity};
+		auto message = channel_data(1, framer.capacity() - 4);
+		CHECK(framer.write(message) == message.size());
+		auto framed = framer.next();
+		REQUIRE(framed);
+		CHECK(framed->size() == framer.capacity());
+	}
+
+	SECTION("invalid") //{{{1
+	{
+		struct param
+		{
+			std::vector<std::byte> data;
+			turner::errc error;
+		};
+		auto [data, error] = GENERATE(values<param>({
+			// first byte 128..255
+			{ {std::byte{0x80}, {}, {}, {}}, turner::errc::unexpected_message_type },
+			{ {std::byte{0xff}, {}, {}, {}}, turner::errc::unexpected_message_type },
+
+			// STUN length not multiple of 4
+			{ {std::byte{0x00}, std::byte{0x01}, std::byte{0x00}, std::byte{0x05}}, turner::errc::unexpected_message_length },
+
+			// larger than capacity
+			{ {std::byte{0x00}, std::byte{0x01}, std::byte{0xff}, std::byte{0xfc}}, turner::errc::unexpected_message_length },
+			{ {std::byte{0x40}, std::byte{0x00}, std::byte{0xff}, std::byte{0xff}}, turner::errc::unexpected_message_length },
+		}));
+		stream_framer framer{stream_framer::min_capacity};
+		framer.write(data);
+		auto framed = framer.next();
+		REQUIRE_FALSE(framed);
+		CHECK(framed.error() == error);
+	}
+
+	//}}}1
+}
+
+} // namespace
@@ -0,0 +1,71 @@
+#include <turner/stun>
+#include <turner/bench>
+#include <benchmark/benchmark.h>
+#include <array>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+namespace {
+
+using turner::stun;
+using turner_bench::set_messages_processed;
+using turner_bench::transaction_id;
+
+const stun::xor_endpoint_value_type::native_value_type mapped_endpoint
+{
+	pal::net::ip::address_v4{{192, 0, 2, 1}},
+	32853,
+};
+
+// Binding success responses with FINGERPRINT, each in separate
+// MTU-sized buffer as received by recvmmsg()
+struct datagrams
+{
+	std::vector<std::array<std::byte, 1500>> buffers;
+	std::vector<std::span<const std::byte>> spans;
+
+	datagrams (size_t count)
+		: buffers(count)
+	{
+		for (auto &buffer: buffers)
+		{
+			stun::message_writer writer{std::span{buffer}, stun::binding.success, transaction_id<stun>()};
+			writer.write(stun::xor_mapped_address, mapped_endpoint);
+			writer.write(stun::software, std::string_view{"turner benchmark"});
+			writer.add_fingerprint();
+			spans.push_back(*writer.finish());
+		}
+	}
+};
+
+void read_message (benchmark::State &state)
+{
+	datagrams batch{static_cast<size_t>(state.range(0))};
+	for (auto _: state)
+	{
+		for (auto &span: batch.spans)
+		{
+			benchmark::DoNotOptimize(stun::read_message(span));
+		}
+	}
+	set_messages_processed(state, batch.spans[0].size_bytes(), batch.spans.size());
+}
+
+void validate_messages (benchmark::State &state)
+{
+	datagrams batch{static_cast<size_t>(state.range(0))};
+	std::vector<std::error_code> errors(batch.spans.size());
+	for (auto _: state)
+	{
+		stun::validate_messages(batch.spans, errors);
+		benchmark::DoNotOptimize(errors.data());
+		benchmark::ClobberMemory();
+	}
+	set_messages_processed(state, batch.spans[0].size_bytes(), batch.spans.size());
+}
+
+BENCHMARK(read_message)->Arg(1)->Arg(8)->Arg(32)->Arg(64);
+BENCHMARK(validate_messages)->Arg(1)->Arg(8)->Arg(32)->Arg(64);
+
+} // namespace
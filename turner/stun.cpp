@@ -1,7 +1,11 @@
 #include <turner/stun>
+#include <turner/__crc32>
+#include <turner/__hash_table>
 #include <turner/__view>
 #include <turner/error>
 #include <pal/byte_order>
+#include <algorithm>
+#include <cstring>
 
 namespace turner {
 
@@ -10,58 +14,62 @@ namespace {
 using message_view = __view::message<stun>;
 using attribute_view = __view::attribute<stun>;
 
-template <uint32_t Polynomial>
-struct crc32_lookup
+// Iterate attributes:
+// - validate lengths
+// - check optional fingerprint attribute is last
+// - if present, return it via \a fingerprint_attr for caller to verify
+errc walk_attributes (const message_view &message, const attribute_view *&fingerprint_attr) noexcept
 {
-	uint32_t table[4][256];
+	fingerprint_attr = nullptr;
 
-	constexpr crc32_lookup () noexcept
+	auto it = message.begin(), end = message.end();
+	while (it != end)
 	{
-		for (uint32_t i = 0;  i <= 0xff;  ++i)
-		{
-			uint32_t crc = i;
-			for (int j = 0;  j < 8;  ++j)
-			{
-				crc = (crc >> 1) ^ ((crc & 1) * Polynomial);
-			}
-			table[0][i] = crc;
-		}
+		auto &attr = *it;
+		it = it->next();
 
-		for (uint32_t i = 0;  i <= 0xff;  ++i)
+		if (it > end)
 		{
-			table[1][i] = (table[0][i] >> 8) ^ table[0][(uint8_t)table[0][i]];
-			table[2][i] = (table[1][i] >> 8) ^ table[0][(uint8_t)table[1][i]];
-			table[3][i] = (table[2][i] >> 8) ^ table[0][(uint8_t)table[2][i]];
+			return errc::unexpected_attribute_length;
 		}
-	}
-};
 
-uint32_t crc32 (const uint32_t *first, const uint32_t *last) noexcept
-{
-	// Intel 32bit CRC using Slice-by-4 method
-	// See ThirdPartySources.txt for copyright notices
+		if (attr.type() == stun::fingerprint.type)
+		{
+			if (it != end)
+			{
+				return errc::fingerprint_not_last;
+			}
 
-	static constexpr crc32_lookup<0xedb88320> lookup{};
+			if (attr.value().size_bytes() != sizeof(uint32_t))
+			{
+				return errc::unexpected_attribute_length;
+			}
 
-	uint32_t crc = ~0U;
-	while (first != last)
-	{
-		crc ^= *first++;
-		crc =
-			lookup.table[3][(uint8_t)(crc      )] ^
-			lookup.table[2][(uint8_t)(crc >>  8)] ^
-			lookup.table[1][(uint8_t)(crc >> 16)] ^
-			lookup.table[0][(uint8_t)(crc >> 24)]
-		;
+			fingerprint_attr = &attr;
+		}
 	}
 
-	// STUN messages are padded to 4B boundary, can skip final 0..3
+	return errc::__0;
+}
+
+inline uint32_t claimed_crc (const attribute_view &fingerprint_attr) noexcept
+{
+	return pal::ntoh(*reinterpret_cast<const uint32_t *>(fingerprint_attr.value().data()));
+}
 
-	return ~crc;
+// message prefix covered by FINGERPRINT
+inline std::span<const std::byte> crc_span (
+	const std::span<const std::byte> &span,
+	const attribute_view &fingerprint_attr) noexcept
+{
+	return span.first(reinterpret_cast<const std::byte *>(&fingerprint_attr) - span.data());
 }
 
+constexpr uint32_t fingerprint_xor = 0x5354554e;
+
 } // namespace
 
+template <validation_policy Policy>
 pal::result<stun::message_reader> stun::read_message (const std::span<const std::byte> &span) noexcept
 {
 	constexpr auto min_span_size_bytes = header_size_bytes;
@@ -88,49 +96,186 @@ pal::result<stun::message_reader> stun::read_message (const std::span<const std:
 		return make_unexpected(errc::unexpected_message_type);
 	}
 
-	// Iterate attributes:
-	// - validate lengths
-	// - check optional fingerprint attribute is last
-	// - if present, check it matches expected fingerprint
+	if constexpr (Policy == validation_policy::header_only)
+	{
+		return message_reader{span};
+	}
+	else if constexpr (Policy == validation_policy::structural)
+	{
+		const attribute_view *fingerprint_attr;
+		if (auto ec = walk_attributes(message, fingerprint_attr);  ec != errc::__0)
+		{
+			return make_unexpected(ec);
+		}
+		return message_reader{span};
+	}
+	else
+	{
+		return read_message_attributes(span);
+	}
+}
 
-	auto it = message.begin(), end = message.end();
-	while (it != end)
+template pal::result<stun::message_reader> stun::read_message<validation_policy::full> (const std::span<const std::byte> &) noexcept;
+template pal::result<stun::message_reader> stun::read_message<validation_policy::structural> (const std::span<const std::byte> &) noexcept;
+template pal::result<stun::message_reader> stun::read_message<validation_policy::header_only> (const std::span<const std::byte> &) noexcept;
+
+pal::result<stun::message_reader> stun::read_message_attributes (const std::span<const std::byte> &span) noexcept
+{
+	const attribute_view *fingerprint_attr;
+	if (auto ec = walk_attributes(*reinterpret_cast<const message_view *>(span.data()), fingerprint_attr);  ec != errc::__0)
 	{
-		auto &attr = *it;
-		it = it->next();
+		return make_unexpected(ec);
+	}
 
-		if (it > end)
+	if (fingerprint_attr)
+	{
+		auto expected_crc = fingerprint_xor ^ __crc32::crc32(crc_span(span, *fingerprint_attr));
+		if (expected_crc != claimed_crc(*fingerprint_attr))
 		{
-			return make_unexpected(errc::unexpected_attribute_length);
+			return make_unexpected(errc::fingerprint_mismatch);
 		}
+	}
+
+	return message_reader{span};
+}
+
+namespace {
 
-		if (attr.type() == fingerprint.type)
+// Distance (in datagrams) to prefetch headers ahead of current one
+constexpr size_t prefetch_distance = 4;
+
+using __hash_table::prefetch;
+
+// Header fields of single message in host byte order
+struct header
+{
+	uint32_t type_and_length;
+	uint32_t cookie;
+};
+
+void validate_batch (
+	const std::span<const std::byte> *spans,
+	std::error_code *errors,
+	size_t count) noexcept
+{
+	constexpr uint32_t cookie = uint32_t{stun::magic_cookie[0]} << 24
+		| uint32_t{stun::magic_cookie[1]} << 16
+		| uint32_t{stun::magic_cookie[2]} << 8
+		| uint32_t{stun::magic_cookie[3]};
+
+	header headers[stun::max_batch_size];
+	size_t sizes[stun::max_batch_size];
+	errc status[stun::max_batch_size];
+
+	// 1) gather headers into arrays, prefetching next datagrams
+	for (auto i = 0u;  i < count;  ++i)
+	{
+		if (i + prefetch_distance < count)
 		{
-			if (it != end)
-			{
-				return make_unexpected(errc::fingerprint_not_last);
-			}
+			prefetch(spans[i + prefetch_distance].data());
+		}
 
-			auto value = attr.value();
-			if (value.size_bytes() != sizeof(uint32_t))
-			{
-				return make_unexpected(errc::unexpected_attribute_length);
-			}
+		sizes[i] = spans[i].size_bytes();
+		headers[i] = {};
+		if (sizes[i] >= stun::header_size_bytes)
+		{
+			std::memcpy(&headers[i], spans[i].data(), sizeof(headers[i]));
+			headers[i].type_and_length = pal::ntoh(headers[i].type_and_length);
+			headers[i].cookie = pal::ntoh(headers[i].cookie);
+		}
+	}
+
+	// 2) header checks over arrays only, no branches (vectorizable); order
+	// of checks (i.e. reported error) is same as in read_message()
+	for (auto i = 0u;  i < count;  ++i)
+	{
+		auto size = sizes[i];
+		auto type = headers[i].type_and_length >> 16;
+		auto length = headers[i].type_and_length & 0xffff;
 
-			auto claimed_crc = pal::ntoh(*reinterpret_cast<const uint32_t *>(value.data()));
-			auto expected_crc = 0x5354554e ^ crc32(
-				reinterpret_cast<const uint32_t *>(span.data()),
-				reinterpret_cast<const uint32_t *>(&attr)
-			);
+		auto bad_size = (size < stun::header_size_bytes) | (size % stun::pad_size_bytes != 0);
+		auto bad_cookie = headers[i].cookie != cookie;
+		auto bad_length = length + stun::header_size_bytes != size;
+		auto bad_type = (type & 0b1100'0000'0000'0000) != 0;
 
-			if (expected_crc != claimed_crc)
-			{
-				return make_unexpected(errc::fingerprint_mismatch);
-			}
+		status[i] = bad_size ? errc::unexpected_message_length
+			: bad_cookie ? errc::invalid_magic_cookie
+			: bad_length ? errc::unexpected_message_length
+			: bad_type ? errc::unexpected_message_type
+			: errc::__0
+		;
+	}
+
+	// 3) walk attributes of structurally valid messages, collecting
+	// FINGERPRINTs to verify
+	std::span<const std::byte> crc_spans[stun::max_batch_size];
+	uint32_t claimed[stun::max_batch_size];
+	uint8_t crc_index[stun::max_batch_size];
+	size_t crc_count = 0;
+
+	for (auto i = 0u;  i < count;  ++i)
+	{
+		if (status[i] != errc::__0)
+		{
+			continue;
+		}
+
+		const attribute_view *fingerprint_attr;
+		status[i] = walk_attributes(*reinterpret_cast<const message_view *>(spans[i].data()), fingerprint_attr);
+		if (status[i] == errc::__0 && fingerprint_attr)
+		{
+			crc_spans[crc_count] = crc_span(spans[i], *fingerprint_attr);
+			claimed[crc_count] = claimed_crc(*fingerprint_attr);
+			crc_index[crc_count] = static_cast<uint8_t>(i);
+			crc_count++;
 		}
 	}
 
-	return message_reader{span};
+	// 4) CRCs interleaved across messages
+	uint32_t expected[stun::max_batch_size];
+	__crc32::crc32(crc_spans, expected, crc_count);
+	for (auto i = 0u;  i < crc_count;  ++i)
+	{
+		if ((expected[i] ^ fingerprint_xor) != claimed[i])
+		{
+			status[crc_index[i]] = errc::fingerprint_mismatch;
+		}
+	}
+
+	const std::error_code success{};
+	const auto &category = error_category();
+	for (auto i = 0u;  i < count;  ++i)
+	{
+		errors[i] = status[i] == errc::__0
+			? success
+			: std::error_code{static_cast<int>(status[i]), category}
+		;
+	}
+}
+
+} // namespace
+
+void stun::validate_messages (
+	const std::span<const std::span<const std::byte>> &spans,
+	const std::span<std::error_code> &errors) noexcept
+{
+	auto count = (std::min)(spans.size(), errors.size());
+	if (count == 1)
+	{
+		// nothing to interleave, skip batch setup
+		auto reader = read_message(spans[0]);
+		errors[0] = reader ? std::error_code{} : reader.error();
+		return;
+	}
+
+	for (size_t first = 0;  first < count;  first += max_batch_size)
+	{
+		validate_batch(
+			spans.data() + first,
+			errors.data() + first,
+			(std::min)(max_batch_size, count - first)
+		);
+	}
 }
 
 } // namespace turner
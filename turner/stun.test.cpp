@@ -1,6 +1,10 @@
 #include <turner/stun>
 #include <turner/test>
 #include <turner/error>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <vector>
 
 namespace {
 
@@ -55,6 +59,10 @@ TEST_CASE("stun")
 			auto r = stun::read_message(std::as_bytes(std::span{data}));
 			REQUIRE(!r);
 			CHECK(r.error() == turner::errc::fingerprint_not_last);
+
+			r = stun::read_message<turner::validation_policy::structural>(std::as_bytes(std::span{data}));
+			REQUIRE(!r);
+			CHECK(r.error() == turner::errc::fingerprint_not_last);
 		}
 
 		SECTION("fingerprint mismatch")
@@ -73,6 +81,11 @@ TEST_CASE("stun")
 			auto r = stun::read_message(std::as_bytes(std::span{data}));
 			REQUIRE(!r);
 			CHECK(r.error() == turner::errc::fingerprint_mismatch);
+
+			// CRC is not calculated
+			using turner::validation_policy;
+			CHECK(stun::read_message<validation_policy::structural>(std::as_bytes(std::span{data})));
+			CHECK(stun::read_message<validation_policy::header_only>(std::as_bytes(std::span{data})));
 		}
 
 		SECTION("fingerprint unexpected length")
@@ -93,6 +106,80 @@ TEST_CASE("stun")
 			CHECK(r.error() == turner::errc::unexpected_attribute_length);
 		}
 	}
+
+	SECTION("read_messages")
+	{
+		// more than max_batch_size messages: valid ones with and without
+		// FINGERPRINT of different sizes, each followed by broken copy
+		constexpr size_t count = stun::max_batch_size + 10;
+		std::vector<std::array<std::byte, 256>> buffers(count);
+		std::vector<std::span<const std::byte>> spans;
+
+		constexpr stun::transaction_id_type transaction_id{};
+		const std::string software(200, 'x');
+		for (auto i = 0u;  i < count;  i += 2)
+		{
+			stun::message_writer writer{std::span{buffers[i]}, stun::binding, transaction_id};
+			writer.write(stun::software, std::string_view{software}.substr(0, i * 3 % 200));
+			if (i % 4 == 0)
+			{
+				writer.add_fingerprint();
+			}
+			auto message = *writer.finish();
+			spans.push_back(message);
+
+			auto &broken = buffers[i + 1];
+			std::memcpy(broken.data(), message.data(), message.size_bytes());
+			switch (i % 12)
+			{
+				case 0:  // FINGERPRINT value
+					broken[message.size_bytes() - 1] ^= std::byte{1};
+					break;
+				case 2:  // Magic Cookie
+					broken[stun::cookie_offset] ^= std::byte{1};
+					break;
+				case 4:  // message type
+					broken[0] |= std::byte{0x80};
+					break;
+				case 6:  // message length
+					broken[3] ^= std::byte{4};
+					break;
+				case 8:  // FINGERPRINT covered data
+					broken[stun::header_size_bytes + 4] ^= std::byte{1};
+					break;
+				case 10: // attribute length
+					broken[stun::header_size_bytes + 3] ^= std::byte{0x40};
+					break;
+			}
+			spans.push_back(std::span{broken}.first(i % 12 == 6 ? message.size_bytes() - 1 : message.size_bytes()));
+		}
+		spans.push_back(std::span{buffers[0]}.first(8));
+
+		std::vector<std::error_code> errors(spans.size());
+		stun::validate_messages(spans, errors);
+
+		std::vector<pal::result<stun::message_reader>> readers;
+		stun::read_messages(spans, std::back_inserter(readers));
+		REQUIRE(readers.size() == spans.size());
+
+		for (auto i = 0u;  i < spans.size();  ++i)
+		{
+			CAPTURE(i);
+			auto expected = stun::read_message(spans[i]);
+			if (expected)
+			{
+				CHECK_FALSE(errors[i]);
+				REQUIRE(readers[i]);
+				CHECK(readers[i]->as_bytes().data() == spans[i].data());
+			}
+			else
+			{
+				CHECK(errors[i] == expected.error());
+				REQUIRE_FALSE(readers[i]);
+				CHECK(readers[i].error() == expected.error());
+			}
+		}
+	}
 }
 
 } // namespace
@@ -0,0 +1,100 @@
+#include <turner/timer_wheel>
+#include <turner/bench>
+#include <memory>
+#include <random>
+
+namespace {
+
+using namespace std::chrono_literals;
+
+// manually advanced clock for deterministic runs
+struct bench_clock
+{
+	using duration = std::chrono::milliseconds;
+	using rep = duration::rep;
+	using period = duration::period;
+	using time_point = std::chrono::time_point<bench_clock>;
+	static constexpr bool is_steady = true;
+
+	time_point *time;
+
+	time_point now () const noexcept
+	{
+		return *time;
+	}
+};
+
+using wheel_type = turner::timer_wheel<bench_clock>;
+
+constexpr size_t timer_count = 1'000'000;
+
+// permissions (300s) with timeouts spread over 1s resolution wheel
+struct fixture
+{
+	bench_clock::time_point now{};
+	wheel_type wheel{1s, bench_clock{&now}};
+	std::unique_ptr<turner::timer[]> timers{new turner::timer[timer_count]};
+
+	fixture ()
+	{
+		for (auto i = 0u;  i < timer_count;  ++i)
+		{
+			wheel.start(timers[i], 300s + std::chrono::seconds{i % 300});
+		}
+	}
+};
+
+void restart (benchmark::State &state)
+{
+	fixture f;
+	size_t i = 0;
+	for (auto _: state)
+	{
+		// CreatePermission refresh
+		f.wheel.start(f.timers[i], 300s);
+		if (++i == timer_count)
+		{
+			i = 0;
+		}
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(restart);
+
+void cancel_start (benchmark::State &state)
+{
+	fixture f;
+	size_t i = 0;
+	for (auto _: state)
+	{
+		f.wheel.cancel(f.timers[i]);
+		f.wheel.start(f.timers[i], 600s);
+		if (++i == timer_count)
+		{
+			i = 0;
+		}
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(cancel_start);
+
+void advance (benchmark::State &state)
+{
+	// expire all timers second by second, restarting each expired timer
+	// i.e. steady state of 1M permissions refreshed on expiry
+	fixture f;
+	size_t expired = 0;
+	for (auto _: state)
+	{
+		f.now += 1s;
+		expired += f.wheel.advance([&](turner::timer &t)
+		{
+			f.wheel.start(t, 300s);
+		});
+	}
+	state.SetItemsProcessed(expired);
+	state.counters["expired/tick"] = static_cast<double>(expired) / state.iterations();
+}
+BENCHMARK(advance);
+
+} // namespace
@@ -0,0 +1,181 @@
+#include <turner/timer_wheel>
+#include <bit>
+
+namespace turner {
+
+void timer_wheel_base::init (timer &head) noexcept
+{
+	head.prev_ = head.next_ = &head;
+}
+
+timer_wheel_base::timer_wheel_base () noexcept
+{
+	for (auto &l: levels_)
+	{
+		for (auto &head: l.slots)
+		{
+			init(head);
+		}
+	}
+	init(expired_);
+}
+
+timer_wheel_base::~timer_wheel_base () noexcept
+{
+	// deactivate remaining timers, they may outlive wheel
+	auto clear = [](timer &head) noexcept
+	{
+		for (auto t = head.next_;  t != &head;  /**/)
+		{
+			auto next = t->next_;
+			t->prev_ = t->next_ = nullptr;
+			t->wheel_ = nullptr;
+			t = next;
+		}
+		head.prev_ = head.next_ = nullptr;
+	};
+
+	for (auto &l: levels_)
+	{
+		for (auto &head: l.slots)
+		{
+			clear(head);
+		}
+	}
+	clear(expired_);
+}
+
+void timer_wheel_base::splice (timer &from, timer &to) noexcept
+{
+	// append all of from to to, leaving from empty
+	if (from.next_ != &from)
+	{
+		from.next_->prev_ = to.prev_;
+		from.prev_->next_ = &to;
+		to.prev_->next_ = from.next_;
+		to.prev_ = from.prev_;
+		init(from);
+	}
+}
+
+void timer_wheel_base::insert (timer &t, uint64_t earliest) noexcept
+{
+	auto expires = t.expires_ > earliest ? t.expires_ : earliest;
+
+	auto delta = expires - now_;
+	if (delta >= max_ticks)
+	{
+		// cascaded (and re-evaluated) when top level completes rotation
+		expires = now_ + max_ticks - 1;
+		delta = max_ticks - 1;
+	}
+
+	// lowest level whose range covers delta
+	size_t l = 0;
+	while (delta >= (uint64_t{1} << (slot_bits * (l + 1))))
+	{
+		l++;
+	}
+
+	auto slot = (expires >> (slot_bits * l)) & (slot_count - 1);
+	auto &head = levels_[l].slots[slot];
+	t.prev_ = head.prev_;
+	t.next_ = &head;
+	head.prev_->next_ = &t;
+	head.prev_ = &t;
+	levels_[l].occupied |= uint64_t{1} << slot;
+}
+
+void timer_wheel_base::schedule (timer &t, uint64_t tick) noexcept
+{
+	if (t.is_active() && t.wheel_ == this)
+	{
+		t.unlink();
+	}
+	else
+	{
+		if (t.is_active())
+		{
+			t.wheel_->cancel(t);
+		}
+		t.wheel_ = this;
+		size_++;
+	}
+	t.expires_ = tick;
+
+	// current tick is already expired, earliest is next
+	insert(t, now_ + 1);
+}
+
+void timer_wheel_base::cascade (size_t level, size_t slot) noexcept
+{
+	auto &l = levels_[level];
+	if (!(l.occupied & (uint64_t{1} << slot)))
+	{
+		return;
+	}
+	l.occupied &= ~(uint64_t{1} << slot);
+
+	// detach list first: reinserted timers may land into same slot
+	timer pending;
+	init(pending);
+	splice(l.slots[slot], pending);
+	while (pending.next_ != &pending)
+	{
+		auto &t = *pending.next_;
+		t.unlink();
+
+		// cascading precedes expiring current tick slot
+		insert(t, now_);
+	}
+	pending.prev_ = pending.next_ = nullptr;
+}
+
+bool timer_wheel_base::step (uint64_t target) noexcept
+{
+	if (now_ >= target)
+	{
+		return false;
+	}
+	else if (size_ == 0)
+	{
+		now_ = target;
+		return false;
+	}
+
+	// skip empty level 0 slots until next occupied slot, level 0 rotation
+	// end (cascading needed) or target
+	constexpr auto mask = slot_count - 1;
+	auto index = now_ & mask;
+	auto ahead = index == mask ? 0 : levels_[0].occupied & (~uint64_t{0} << (index + 1));
+	auto next = ahead
+		? now_ - index + std::countr_zero(ahead)
+		: (now_ | mask) + 1
+	;
+	if (next > target)
+	{
+		now_ = target;
+		return true;
+	}
+	now_ = next;
+
+	// on level rotation end, cascade next levels current slots
+	for (size_t l = 1;  l < level_count;  ++l)
+	{
+		if ((now_ >> (slot_bits * (l - 1))) & mask)
+		{
+			break;
+		}
+		cascade(l, (now_ >> (slot_bits * l)) & mask);
+	}
+
+	index = now_ & mask;
+	if (levels_[0].occupied & (uint64_t{1} << index))
+	{
+		levels_[0].occupied &= ~(uint64_t{1} << index);
+		splice(levels_[0].slots[index], expired_);
+	}
+	return true;
+}
+
+} // namespace turner
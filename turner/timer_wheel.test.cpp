@@ -0,0 +1,286 @@
+#include <turner/timer_wheel>
+#include <turner/test>
+#include <random>
+#include <vector>
+
+namespace {
+
+using namespace std::chrono_literals;
+
+// manually advanced clock
+struct test_clock
+{
+	using duration = std::chrono::milliseconds;
+	using rep = duration::rep;
+	using period = duration::period;
+	using time_point = std::chrono::time_point<test_clock>;
+	static constexpr bool is_steady = true;
+
+	time_point *time;
+
+	time_point now () const noexcept
+	{
+		return *time;
+	}
+};
+
+struct test_timer: turner::timer
+{
+	int id = 0;
+	test_clock::time_point expires{};
+};
+
+TEST_CASE("timer_wheel")
+{
+	test_clock::time_point now{};
+	turner::timer_wheel<test_clock> wheel{100ms, test_clock{&now}};
+	CHECK(wheel.size() == 0);
+	CHECK(wheel.resolution() == 100ms);
+
+	std::vector<int> expired;
+	auto collect = [&](turner::timer &t)
+	{
+		expired.push_back(static_cast<test_timer &>(t).id);
+	};
+
+	SECTION("expire") //{{{1
+	{
+		test_timer a, b, c;
+		a.id = 1, b.id = 2, c.id = 3;
+		wheel.start(a, 250ms);
+		wheel.start(b, 100ms);
+		wheel.start(c, 1s);
+		CHECK(a.is_active());
+		CHECK(wheel.size() == 3);
+
+		now += 100ms;
+		CHECK(wheel.advance(collect) == 1);
+		CHECK(expired == std::vector{2});
+		CHECK_FALSE(b.is_active());
+
+		// never early: 250ms rounds up to 300ms
+		now += 150ms;
+		CHECK(wheel.advance(collect) == 0);
+		now += 50ms;
+		CHECK(wheel.advance(collect) == 1);
+		CHECK(expired == std::vector{2, 1});
+
+		now += 1h;
+		CHECK(wheel.advance(collect) == 1);
+		CHECK(expired == std::vector{2, 1, 3});
+		CHECK(wheel.size() == 0);
+	}
+
+	SECTION("batch") //{{{1
+	{
+		std::array<test_timer, 100> timers;
+		for (auto i = 0u;  i < timers.size();  ++i)
+		{
+			timers[i].id = static_cast<int>(i);
+			wheel.start(timers[i], 10s + 100ms * (i % 5));
+		}
+
+		now += 10s;
+		CHECK(wheel.advance(collect) == 20);
+		now += 1s;
+		CHECK(wheel.advance(collect) == 80);
+
+		// ordered by tick
+		for (auto i = 1u;  i < expired.size();  ++i)
+		{
+			CHECK(expired[i - 1] % 5 <= expired[i] % 5);
+		}
+	}
+
+	SECTION("cancel") //{{{1
+	{
+		test_timer a, b;
+		wheel.start(a, 1s);
+		wheel.start(b, 1s);
+		wheel.cancel(a);
+		CHECK_FALSE(a.is_active());
+		CHECK(wheel.size() == 1);
+
+		// cancel inactive is no-op
+		wheel.cancel(a);
+		CHECK(wheel.size() == 1);
+
+		now += 1s;
+		CHECK(wheel.advance(collect) == 1);
+	}
+
+	SECTION("restart") //{{{1
+	{
+		test_timer a;
+		wheel.start(a, 1s);
+		for (auto i = 0;  i < 10;  ++i)
+		{
+			now += 500ms;
+			CHECK(wheel.advance(collect) == 0);
+			wheel.start(a, 1s);
+		}
+		CHECK(wheel.size() == 1);
+
+		now += 1s;
+		CHECK(wheel.advance(collect) == 1);
+	}
+
+	SECTION("start in callback") //{{{1
+	{
+		test_timer a, b;
+		a.id = 1, b.id = 2;
+		wheel.start(a, 1s);
+		wheel.start(b, 1s);
+
+		size_t count = 0;
+		auto restart = [&](turner::timer &t)
+		{
+			count++;
+			wheel.start(t, 1s);
+
+			// cancel other timer of same batch
+			wheel.cancel(&t == &a ? static_cast<turner::timer &>(b) : a);
+		};
+
+		now += 1s;
+		CHECK(wheel.advance(restart) == 1);
+		CHECK(wheel.size() == 1);
+
+		now += 1s;
+		CHECK(wheel.advance(restart) == 1);
+		CHECK(count == 2);
+	}
+
+	SECTION("destroy active timer") //{{{1
+	{
+		test_timer b;
+		{
+			test_timer a;
+			wheel.start(a, 1s);
+			wheel.start(b, 2s);
+			CHECK(wheel.size() == 2);
+		}
+		CHECK(wheel.size() == 1);
+
+		now += 1s;
+		CHECK(wheel.advance(collect) == 0);
+
+		// empty wheel fast path
+		wheel.cancel(b);
+		CHECK(wheel.size() == 0);
+		now += 10s;
+		CHECK(wheel.advance(collect) == 0);
+		CHECK(wheel.now() == now);
+	}
+
+	SECTION("destroy wheel") //{{{1
+	{
+		test_timer a;
+		{
+			turner::timer_wheel<test_clock> other{100ms, test_clock{&now}};
+			other.start(a, 1s);
+			CHECK(a.is_active());
+		}
+		CHECK_FALSE(a.is_active());
+	}
+
+	SECTION("move between wheels") //{{{1
+	{
+		turner::timer_wheel<test_clock> other{100ms, test_clock{&now}};
+		test_timer a;
+		other.start(a, 1s);
+		wheel.start(a, 1s);
+		CHECK(other.size() == 0);
+		CHECK(wheel.size() == 1);
+	}
+
+	SECTION("cancel on other wheel") //{{{1
+	{
+		turner::timer_wheel<test_clock> other{100ms, test_clock{&now}};
+		test_timer a, b;
+		wheel.start(a, 1s);
+		other.start(b, 1s);
+
+		// cancelled on wheel it is scheduled on
+		wheel.cancel(b);
+		CHECK_FALSE(b.is_active());
+		CHECK(wheel.size() == 1);
+		CHECK(other.size() == 0);
+
+		now += 1s;
+		CHECK(other.advance(collect) == 0);
+		CHECK(wheel.advance(collect) == 1);
+		CHECK(wheel.size() == 0);
+	}
+
+	SECTION("expired start") //{{{1
+	{
+		now += 1s;
+		wheel.advance(collect);
+
+		// expiration in past expires on next tick
+		test_timer a;
+		wheel.start(a, now - 10s);
+		CHECK(wheel.advance(collect) == 0);
+		now += 100ms;
+		CHECK(wheel.advance(collect) == 1);
+	}
+
+	SECTION("long timeout") //{{{1
+	{
+		// over max_ticks
+		test_timer a;
+		auto timeout = 100ms * turner::timer_wheel_base::max_ticks * 3;
+		wheel.start(a, timeout);
+
+		now += timeout - 100ms;
+		CHECK(wheel.advance(collect) == 0);
+		now += 100ms;
+		CHECK(wheel.advance(collect) == 1);
+	}
+
+	SECTION("random") //{{{1
+	{
+		// compare against reference: timers expire on first advance after
+		// their expiration (rounded up to resolution)
+		std::array<test_timer, 1000> timers;
+		std::mt19937 rng{1};
+		std::uniform_int_distribution<int> timeout{0, 600'000};
+
+		for (auto i = 0u;  i < timers.size();  ++i)
+		{
+			timers[i].id = static_cast<int>(i);
+			auto t = std::chrono::milliseconds{timeout(rng)};
+			timers[i].expires = wheel.now() + (t + 99ms) / 100ms * 100ms;
+			wheel.start(timers[i], wheel.now() + t);
+		}
+
+		size_t count = 0;
+		while (count < timers.size())
+		{
+			now += std::chrono::milliseconds{timeout(rng) / 100};
+			auto failures = 0;
+			count += wheel.advance([&](turner::timer &t)
+			{
+				auto &tt = static_cast<test_timer &>(t);
+				// expired on exactly its tick
+				failures += tt.expires != wheel.now();
+			});
+			REQUIRE(failures == 0);
+
+			// remaining timers are not expired
+			for (auto &t: timers)
+			{
+				if (t.is_active() && t.expires <= wheel.now())
+				{
+					failures++;
+				}
+			}
+			REQUIRE(failures == 0);
+		}
+	}
+
+	//}}}1
+}
+
+} // namespace
@@ -0,0 +1,139 @@
+#include <turner/turn>
+#include <turner/message_writer>
+#include <turner/bench>
+#include <benchmark/benchmark.h>
+#include <array>
+#include <cstring>
+
+namespace {
+
+using turner::turn;
+using turner_bench::set_messages_processed;
+using turner_bench::transaction_id;
+
+const turn::xor_endpoint_value_type::native_value_type peer_endpoint
+{
+	pal::net::ip::address_v4{{192, 0, 2, 1}},
+	32853,
+};
+
+constexpr size_t max_payload_size_bytes = 1200;
+std::array<std::byte, max_payload_size_bytes> payload{};
+
+void read_channel_data (benchmark::State &state)
+{
+	auto payload_size = static_cast<uint16_t>(state.range(0));
+	std::array<std::byte, turn::channel_data_header_size_bytes + max_payload_size_bytes> buffer{};
+	uint32_t header = pal::hton(uint32_t{0x4001'0000} | payload_size);
+	std::memcpy(buffer.data(), &header, sizeof(header));
+	auto span = std::span{buffer}.first(turn::channel_data_header_size_bytes + payload_size);
+
+	for (auto _: state)
+	{
+		auto reader = turn::read_channel_data(span);
+		benchmark::DoNotOptimize(reader->channel_number());
+		benchmark::DoNotOptimize(reader->data());
+	}
+	set_messages_processed(state, span.size_bytes());
+}
+
+void read_data_indication (benchmark::State &state)
+{
+	auto payload_size = static_cast<size_t>(state.range(0));
+	std::array<std::byte, 64 + max_payload_size_bytes> buffer{};
+	turn::message_writer writer{std::span{buffer}, turn::data_indication, transaction_id<turn>()};
+	writer.write(turn::xor_peer_address, peer_endpoint);
+	writer.write(turn::data, std::span{payload}.first(payload_size));
+	auto span = *writer.finish();
+
+	for (auto _: state)
+	{
+		auto reader = turn::read_message(span);
+		benchmark::DoNotOptimize(reader->read(turn::xor_peer_address));
+		benchmark::DoNotOptimize(reader->read(turn::data));
+	}
+	set_messages_processed(state, span.size_bytes());
+}
+
+BENCHMARK(read_channel_data)->Arg(64)->Arg(160)->Arg(512)->Arg(max_payload_size_bytes);
+BENCHMARK(read_data_indication)->Arg(64)->Arg(160)->Arg(512)->Arg(max_payload_size_bytes);
+
+// relay framing: in place vs message_writer (copying payload), bytes/s
+// counts payload only
+
+void write_data_indication (benchmark::State &state)
+{
+	auto payload_size = static_cast<size_t>(state.range(0));
+	std::array<std::byte, turn::data_indication_headroom_bytes + max_payload_size_bytes + turn::relay_tailroom_bytes> buffer{};
+	for (auto _: state)
+	{
+		turn::message_writer writer{std::span{buffer}, turn::data_indication, transaction_id<turn>()};
+		writer.write(turn::xor_peer_address, peer_endpoint);
+		writer.write(turn::data, std::span{payload}.first(payload_size));
+		benchmark::DoNotOptimize(writer.finish());
+	}
+	state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * payload_size));
+}
+
+void wrap_data_indication (benchmark::State &state)
+{
+	auto payload_size = static_cast<size_t>(state.range(0));
+	std::array<std::byte, turn::data_indication_headroom_bytes + max_payload_size_bytes + turn::relay_tailroom_bytes> buffer{};
+	for (auto _: state)
+	{
+		benchmark::DoNotOptimize(turn::wrap_data_indication(buffer,
+			turn::data_indication_headroom_bytes, payload_size, peer_endpoint, transaction_id<turn>()
+		));
+	}
+	state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * payload_size));
+}
+
+void wrap_channel_data (benchmark::State &state)
+{
+	auto payload_size = static_cast<size_t>(state.range(0));
+	std::array<std::byte, turn::channel_data_headroom_bytes + max_payload_size_bytes + turn::relay_tailroom_bytes> buffer{};
+	for (auto _: state)
+	{
+		benchmark::DoNotOptimize(turn::wrap_channel_data(buffer,
+			turn::channel_data_headroom_bytes, payload_size, 0x4001
+		));
+	}
+	state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * payload_size));
+}
+
+void unwrap_send_indication (benchmark::State &state)
+{
+	auto payload_size = static_cast<size_t>(state.range(0));
+	std::array<std::byte, 64 + max_payload_size_bytes> buffer{};
+	turn::message_writer writer{std::span{buffer}, turn::send_indication, transaction_id<turn>()};
+	writer.write(turn::xor_peer_address, peer_endpoint);
+	writer.write(turn::data, std::span{payload}.first(payload_size));
+	auto span = *writer.finish();
+
+	for (auto _: state)
+	{
+		benchmark::DoNotOptimize(turn::unwrap_send_indication(span));
+	}
+	state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * payload_size));
+}
+
+BENCHMARK(write_data_indication)->Arg(160)->Arg(max_payload_size_bytes);
+BENCHMARK(wrap_data_indication)->Arg(160)->Arg(max_payload_size_bytes);
+BENCHMARK(wrap_channel_data)->Arg(160)->Arg(max_payload_size_bytes);
+BENCHMARK(unwrap_send_indication)->Arg(160)->Arg(max_payload_size_bytes);
+
+// attribute value types
+
+using turner_bench::read_attribute;
+
+const std::array<std::byte, 8> reservation_token{};
+
+__turner_bench_capture(read_attribute<turn::channel_number>, channel_number, 0x4001);
+__turner_bench_capture(read_attribute<turn::even_port>, even_port, true);
+__turner_bench_capture(read_attribute<turn::dont_fragment>, dont_fragment, true);
+__turner_bench_capture(read_attribute<turn::reservation_token>, reservation_token, reservation_token);
+__turner_bench_capture(read_attribute<turn::address_error_code>, address_error_code,
+	{turner::address_family::v6, turner::protocol_errc::unsupported_address_family, "Unsupported Address Family"}
+);
+
+} // namespace
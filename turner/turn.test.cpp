@@ -1,6 +1,9 @@
 #include <turner/turn>
 #include <turner/msturn>
 #include <turner/test>
+#include <array>
+#include <cstring>
+#include <optional>
 
 namespace {
 
@@ -10,6 +13,9 @@ using turner::turn;
 template <typename ValueType>
 using test_message = turner_test::test_message<turn, ValueType>;
 
+template <typename ValueType>
+using test_writer = turner_test::test_writer<turn, ValueType>;
+
 TEST_CASE("turn")
 {
 	static_assert(std::is_convertible_v<turn, turner::stun>);
@@ -48,6 +54,22 @@ TEST_CASE("turn")
 		static_assert(turn::channel_bind.type == 0x0009);
 		static_assert(turn::channel_bind.success.type == 0x0109);
 		static_assert(turn::channel_bind.error.type == 0x0119);
+
+		// Connect
+		static_assert(turn::connect.method == 0x000a);
+		static_assert(turn::connect.type == 0x000a);
+		static_assert(turn::connect.success.type == 0x010a);
+		static_assert(turn::connect.error.type == 0x011a);
+
+		// ConnectionBind
+		static_assert(turn::connection_bind.method == 0x000b);
+		static_assert(turn::connection_bind.type == 0x000b);
+		static_assert(turn::connection_bind.success.type == 0x010b);
+		static_assert(turn::connection_bind.error.type == 0x011b);
+
+		// ConnectionAttempt
+		static_assert(turn::connection_attempt.method == 0x000c);
+		static_assert(turn::connection_attempt.type == 0x001c);
 	}
 
 	SECTION("attribute registry") //{{{1
@@ -62,6 +84,7 @@ TEST_CASE("turn")
 		static_assert(turn::requested_transport.type == 0x0019);
 		static_assert(turn::dont_fragment.type == 0x001a);
 		static_assert(turn::reservation_token.type == 0x0022);
+		static_assert(turn::connection_id.type == 0x002a);
 		static_assert(turn::additional_address_family.type == 0x8000);
 		static_assert(turn::address_error_code.type == 0x8001);
 	}
@@ -308,6 +331,370 @@ TEST_CASE("turn")
 		}
 	}
 
+	SECTION("read_messages") //{{{1
+	{
+		std::array<std::byte, 64> buffer{};
+		turn::message_writer writer{std::span{buffer}, turn::allocate, turn::transaction_id_type{}};
+		writer.write(turn::requested_transport, turner::transport_protocol::udp);
+		writer.add_fingerprint();
+		std::span<const std::byte> spans[] = { *writer.finish(), std::span{buffer}.first(4) };
+
+		std::optional<pal::result<turn::message_reader>> readers[2];
+		turn::read_messages(spans, readers);
+
+		REQUIRE(readers[0]);
+		REQUIRE(*readers[0]);
+		CHECK((*readers[0])->expect(turn::allocate));
+		CHECK((*readers[0])->read(turn::requested_transport).value() == turner::transport_protocol::udp);
+
+		REQUIRE(readers[1]);
+		REQUIRE(!*readers[1]);
+		CHECK(readers[1]->error() == turner::errc::unexpected_message_length);
+	}
+
+	SECTION("read_channel_data") //{{{1
+	{
+		SECTION("valid")
+		{
+			constexpr uint8_t data[] =
+			{
+				0x40, 0x01, 0x00, 0x04, // channel 0x4001, length 4
+				'T',  'e',  's',  't',
+			};
+			auto span = std::as_bytes(std::span{data});
+			auto reader = turn::read_channel_data(span);
+			REQUIRE(reader);
+			CHECK(reader->channel_number() == 0x4001);
+			CHECK(reader->data().data() == span.data() + 4);
+			CHECK(reader->data().size_bytes() == 4);
+			CHECK(reader->as_bytes().size_bytes() == span.size_bytes());
+			CHECK(reader->padded_size_bytes() == span.size_bytes());
+		}
+
+		SECTION("empty data")
+		{
+			constexpr uint8_t data[] =
+			{
+				0x7f, 0xff, 0x00, 0x00, // channel 0x7fff, length 0
+			};
+			auto reader = turn::read_channel_data(std::as_bytes(std::span{data}));
+			REQUIRE(reader);
+			CHECK(reader->channel_number() == 0x7fff);
+			CHECK(reader->data().empty());
+		}
+
+		SECTION("padding")
+		{
+			constexpr uint8_t data[] =
+			{
+				0x40, 0x00, 0x00, 0x01, // channel 0x4000, length 1
+				'T',  0x00, 0x00, 0x00,
+			};
+			auto span = std::as_bytes(std::span{data});
+			for (auto size: {5u, 6u, 7u, 8u})
+			{
+				CAPTURE(size);
+				auto reader = turn::read_channel_data(span.first(size));
+				REQUIRE(reader);
+				CHECK(reader->channel_number() == 0x4000);
+				CHECK(reader->data().size_bytes() == 1);
+				CHECK(reader->as_bytes().size_bytes() == 5);
+				CHECK(reader->padded_size_bytes() == 8);
+			}
+		}
+
+		SECTION("too much padding")
+		{
+			constexpr uint8_t data[] =
+			{
+				0x40, 0x00, 0x00, 0x00, // channel 0x4000, length 0
+				0x00, 0x00, 0x00, 0x00,
+			};
+			auto reader = turn::read_channel_data(std::as_bytes(std::span{data}));
+			REQUIRE(!reader);
+			CHECK(reader.error() == turner::errc::unexpected_message_length);
+		}
+
+		SECTION("data too short")
+		{
+			constexpr uint8_t data[] =
+			{
+				0x40, 0x00, 0x00, 0x05, // channel 0x4000, length 5
+				'T',  'e',  's',  't',
+			};
+			auto reader = turn::read_channel_data(std::as_bytes(std::span{data}));
+			REQUIRE(!reader);
+			CHECK(reader.error() == turner::errc::unexpected_message_length);
+		}
+
+		SECTION("header too short")
+		{
+			constexpr uint8_t data[] =
+			{
+				0x40, 0x00, 0x00,
+			};
+			auto reader = turn::read_channel_data(std::as_bytes(std::span{data}));
+			REQUIRE(!reader);
+			CHECK(reader.error() == turner::errc::unexpected_message_length);
+		}
+
+		SECTION("invalid channel")
+		{
+			auto channel = GENERATE(values<uint8_t>({0x00, 0x3f, 0x80, 0xff}));
+			const uint8_t data[] =
+			{
+				channel, 0xff, 0x00, 0x00,
+			};
+			auto reader = turn::read_channel_data(std::as_bytes(std::span{data}));
+			REQUIRE(!reader);
+			CHECK(reader.error() == turner::errc::unexpected_message_type);
+		}
+
+		SECTION("STUN message")
+		{
+			constexpr uint8_t data[] =
+			{
+				0x00, 0x03, 0x00, 0x00, // TURN Allocate
+				0x21, 0x12, 0xa4, 0x42, // Magic Cookie
+				0x00, 0x01, 0x02, 0x03, // Transaction ID
+				0x04, 0x05, 0x06, 0x07,
+				0x08, 0x09, 0x0a, 0x0b,
+			};
+			auto reader = turn::read_channel_data(std::as_bytes(std::span{data}));
+			REQUIRE(!reader);
+			CHECK(reader.error() == turner::errc::unexpected_message_type);
+		}
+	}
+
+	SECTION("write") //{{{1
+	{
+		SECTION("even_port_value_type")
+		{
+			CHECK(test_writer<turn::even_port_value_type>{true}.value.value() == true);
+			CHECK(test_writer<turn::even_port_value_type>{false}.value.value() == false);
+		}
+
+		SECTION("dont_fragment_value_type")
+		{
+			CHECK(test_writer<turn::dont_fragment_value_type>{true}.value.value() == true);
+
+			test_writer<turn::dont_fragment_value_type> off{false};
+			REQUIRE(!off.value);
+			CHECK(off.value.error() == turner::errc::unexpected_attribute_value);
+		}
+
+		SECTION("channel_number_value_type")
+		{
+			CHECK(test_writer<turn::channel_number_value_type>{0x4001}.value.value() == 0x4001);
+
+			test_writer<turn::channel_number_value_type> below{0x3fff};
+			REQUIRE(!below.value);
+			CHECK(below.value.error() == turner::errc::unexpected_attribute_value);
+
+			test_writer<turn::channel_number_value_type> above{0x8000};
+			REQUIRE(!above.value);
+			CHECK(above.value.error() == turner::errc::unexpected_attribute_value);
+		}
+
+		SECTION("address_error_code_value_type")
+		{
+			test_writer<turn::address_error_code_value_type> valid{{
+				turner::address_family::v6,
+				turner::protocol_errc::unsupported_address_family,
+				"Test"
+			}};
+			REQUIRE(valid.value);
+			auto [family, code, reason] = *valid.value;
+			CHECK(family == turner::address_family::v6);
+			CHECK(code == turner::protocol_errc::unsupported_address_family);
+			CHECK(reason == "Test");
+
+			test_writer<turn::address_error_code_value_type> invalid_family{{
+				turner::address_family(3),
+				turner::protocol_errc::unsupported_address_family,
+				"Test"
+			}};
+			REQUIRE(!invalid_family.value);
+			CHECK(invalid_family.value.error() == turner::errc::unexpected_attribute_value);
+		}
+	}
+
+	SECTION("relay framing") //{{{1
+	{
+		constexpr turn::transaction_id_type transaction_id
+		{
+			0x00, 0x01, 0x02, 0x03,
+			0x04, 0x05, 0x06, 0x07,
+			0x08, 0x09, 0x0a, 0x0b,
+		};
+
+		struct param
+		{
+			turn::xor_endpoint_value_type::native_value_type peer;
+			size_t payload_size;
+		};
+		auto generated = GENERATE(values<param>({
+			{{pal::net::ip::address_v4{{192, 0, 2, 1}}, 32853}, 0},
+			{{pal::net::ip::address_v4{{192, 0, 2, 1}}, 32853}, 1},
+			{{pal::net::ip::address_v6::loopback(), 32853}, 4},
+			{{pal::net::ip::address_v6::loopback(), 32853}, 63},
+		}));
+		const auto &peer = generated.peer;
+		const auto payload_size = generated.payload_size;
+
+		// payload received leaving maximum headroom
+		constexpr size_t payload_offset = turn::data_indication_headroom_bytes;
+		std::array<std::byte, payload_offset + 64 + turn::relay_tailroom_bytes> buffer;
+		buffer.fill(std::byte{0xff});
+		auto payload = std::span{buffer}.subspan(payload_offset, payload_size);
+		for (auto i = 0u;  i < payload.size();  ++i)
+		{
+			payload[i] = std::byte(i);
+		}
+
+		auto check_payload = [&](const std::span<const std::byte> &data)
+		{
+			CHECK(data.data() == payload.data());
+			CHECK(data.size_bytes() == payload.size_bytes());
+			for (auto i = 0u;  i < payload.size();  ++i)
+			{
+				CHECK(data[i] == std::byte(i));
+			}
+		};
+
+		SECTION("wrap_data_indication")
+		{
+			auto message = turn::wrap_data_indication(buffer, payload_offset, payload_size, peer, transaction_id);
+			REQUIRE(message);
+			CHECK(message->data() + message->size_bytes() == payload.data() + ((payload_size + 3) & ~3));
+
+			auto reader = turn::read_message(*message);
+			REQUIRE(reader);
+			CHECK(reader->expect(turn::data_indication));
+			CHECK(reader->transaction_id() == transaction_id);
+
+			auto peer_address = reader->read(turn::xor_peer_address);
+			REQUIRE(peer_address);
+			CHECK(peer_address->address == peer.address);
+			CHECK(peer_address->port == peer.port);
+
+			auto data = reader->read(turn::data);
+			REQUIRE(data);
+			check_payload(*data);
+		}
+
+		SECTION("wrap_data_indication: insufficient headroom")
+		{
+			auto headroom = peer.address.is_v4()
+				? turn::data_indication_headroom_bytes - 12
+				: turn::data_indication_headroom_bytes
+			;
+			auto message = turn::wrap_data_indication(std::span{buffer}.subspan(payload_offset - headroom + 1),
+				headroom - 1, payload_size, peer, transaction_id
+			);
+			REQUIRE(!message);
+			CHECK(message.error() == turner::errc::insufficient_buffer);
+
+			// exact headroom
+			message = turn::wrap_data_indication(std::span{buffer}.subspan(payload_offset - headroom),
+				headroom, payload_size, peer, transaction_id
+			);
+			CHECK(message);
+		}
+
+		SECTION("wrap_data_indication: insufficient tailroom")
+		{
+			auto message = turn::wrap_data_indication(std::span{buffer}.first(payload_offset + payload_size),
+				payload_offset, payload_size, peer, transaction_id
+			);
+			CHECK(static_cast<bool>(message) == (payload_size % 4 == 0));
+
+			message = turn::wrap_data_indication(std::span{buffer}.first(payload_offset + payload_size - 1),
+				payload_offset, payload_size, peer, transaction_id
+			);
+			REQUIRE(!message);
+			CHECK(message.error() == turner::errc::insufficient_buffer);
+		}
+
+		SECTION("wrap_channel_data")
+		{
+			for (auto pad: {true, false})
+			{
+				auto message = turn::wrap_channel_data(buffer, payload_offset, payload_size, 0x4001, pad);
+				REQUIRE(message);
+				CHECK(message->data() == payload.data() - turn::channel_data_header_size_bytes);
+				CHECK(message->size_bytes() % 4 == (pad ? 0 : (payload_size + 4) % 4));
+
+				auto reader = turn::read_channel_data(*message);
+				REQUIRE(reader);
+				CHECK(reader->channel_number() == 0x4001);
+				check_payload(reader->data());
+			}
+		}
+
+		SECTION("wrap_channel_data: insufficient headroom")
+		{
+			auto message = turn::wrap_channel_data(std::span{buffer}.subspan(payload_offset - 3),
+				3, payload_size, 0x4001
+			);
+			REQUIRE(!message);
+			CHECK(message.error() == turner::errc::insufficient_buffer);
+		}
+
+		SECTION("wrap_channel_data: insufficient tailroom")
+		{
+			auto message = turn::wrap_channel_data(std::span{buffer}.first(payload_offset + payload_size),
+				payload_offset, payload_size, 0x4001, true
+			);
+			CHECK(static_cast<bool>(message) == (payload_size % 4 == 0));
+		}
+
+		SECTION("wrap_channel_data: invalid channel")
+		{
+			for (uint16_t channel: {0x0000, 0x3fff, 0x8000, 0xffff})
+			{
+				auto message = turn::wrap_channel_data(buffer, payload_offset, payload_size, channel);
+				REQUIRE(!message);
+				CHECK(message.error() == turner::errc::unexpected_attribute_value);
+			}
+		}
+
+		SECTION("unwrap_send_indication")
+		{
+			// frame as Send indication in place, unwrap back
+			auto message = turn::wrap_data_indication(buffer, payload_offset, payload_size, peer, transaction_id);
+			REQUIRE(message);
+			auto type = std::span{buffer}.subspan(message->data() - buffer.data(), 2);
+			auto send_type = pal::hton(turn::send_indication.type);
+			std::memcpy(type.data(), &send_type, sizeof(send_type));
+
+			auto data = turn::unwrap_send_indication(*message);
+			REQUIRE(data);
+			CHECK(data->peer.address == peer.address);
+			CHECK(data->peer.port == peer.port);
+			check_payload(data->payload);
+		}
+
+		SECTION("unwrap_send_indication: unexpected message type")
+		{
+			auto message = turn::wrap_data_indication(buffer, payload_offset, payload_size, peer, transaction_id);
+			REQUIRE(message);
+			auto data = turn::unwrap_send_indication(*message);
+			REQUIRE(!data);
+			CHECK(data.error() == turner::errc::unexpected_message_type);
+		}
+
+		SECTION("unwrap_send_indication: missing attribute")
+		{
+			std::array<std::byte, 64> send_buffer;
+			turn::message_writer writer{send_buffer, turn::send_indication, transaction_id};
+			writer.write(turn::xor_peer_address, peer);
+			auto data = turn::unwrap_send_indication(*writer.finish());
+			REQUIRE(!data);
+			CHECK(data.error() == turner::errc::attribute_not_found);
+		}
+	}
+
 	//}}}1
 }
 